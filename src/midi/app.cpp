@@ -4,14 +4,23 @@
 #include "imaging/bitmap.h"
 #include "imaging/bmp-format.h"
 #include "imaging/color.h"
+#include "imaging/drawing.h"
+#include "imaging/frame-container.h"
+#include "imaging/frame-deduplication.h"
+#include "imaging/frame-export.h"
+#include "imaging/piano-roll.h"
+#include "imaging/tiled-bitmap.h"
+#include "imaging/video-stream.h"
 #include <cstdint>
 #include <fstream>
 #include <vector>
 #include "midi/midi.h"
+#include "midi/note-cache.h"
 #include "shell/command-line-parser.h"
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <memory>
 
 using namespace imaging;
 using namespace colors;
@@ -19,16 +28,12 @@ using namespace midi;
 using namespace std;
 using namespace shell;
 
-void draw_rectangle(Bitmap& bitmap, const Position& top_left, const uint32_t& width, const uint32_t& height, const Color& color) {
-	for (uint32_t i = top_left.x; i < top_left.x + width; i++) {
-		for (uint32_t j = top_left.y; j < top_left.y + height; j++) {
-			bitmap[Position(i, j)] = color;
-		}
-	}
+void draw_rectangle(RGBA8Bitmap& bitmap, const Position& top_left, const uint32_t& width, const uint32_t& height, const RGBA8& color) {
+	fill_rect(bitmap.view(), top_left.x, top_left.y, width, height, color);
 }
 
-int get_width(const vector<NOTE> notes) {
-	int width = 0;
+uint64_t get_width(const vector<NOTE> notes) {
+	uint64_t width = 0;
 	for (NOTE note : notes) {
 		if (value(note.start + note.duration) > width) {
 			width = value(note.start + note.duration);
@@ -78,6 +83,20 @@ int main(int argn, char* argv[]) {
 	uint32_t step = 1;
 	uint32_t scale = 2;
 	uint32_t note_height = 16;
+	uint32_t parse_threads = 1;
+	bool use_note_cache = false;
+	uint32_t bits_per_pixel = 32;
+	uint32_t export_threads = 1;
+	bool render_on_demand = false;
+	bool draw_lanes = false;
+	string video_format;
+	uint32_t frame_rate = 30;
+	bool use_container = false;
+	bool compress_frames = false;
+	bool extract_container = false;
+	uint32_t tile_budget = 0;
+	bool deduplicate = false;
+	bool indexed = false;
 	string input_file = "C:\\Users\\Ruben Claes\\Desktop\\Ucll\\2_S2\\Programmeren voor Multimedia\\Opdracht\\midi-files\\bohemian.mid";
 	string output_file = "C:\\Users\\Ruben Claes\\Desktop\\Ucll\\2_S2\\Programmeren voor Multimedia\\Opdracht\\output\\f%d.bmp";
 
@@ -87,6 +106,20 @@ int main(int argn, char* argv[]) {
 	cmd_parser.add_argument(string("-d"), &step);
 	cmd_parser.add_argument(string("-s"), &scale);
 	cmd_parser.add_argument(string("-h"), &note_height);
+	cmd_parser.add_argument(string("-p"), &parse_threads);
+	cmd_parser.add_argument(string("-c"), &use_note_cache);
+	cmd_parser.add_argument(string("-b"), &bits_per_pixel);
+	cmd_parser.add_argument(string("-j"), &export_threads);
+	cmd_parser.add_argument(string("-r"), &render_on_demand);
+	cmd_parser.add_argument(string("-l"), &draw_lanes);
+	cmd_parser.add_argument(string("-v"), &video_format);
+	cmd_parser.add_argument(string("-f"), &frame_rate);
+	cmd_parser.add_argument(string("-a"), &use_container);
+	cmd_parser.add_argument(string("-z"), &compress_frames);
+	cmd_parser.add_argument(string("-x"), &extract_container);
+	cmd_parser.add_argument(string("-t"), &tile_budget);
+	cmd_parser.add_argument(string("-u"), &deduplicate);
+	cmd_parser.add_argument(string("-i"), &indexed);
 	cmd_parser.process(vector<string>(argv + 1, argv + argn));
 
 	/*
@@ -109,48 +142,187 @@ int main(int argn, char* argv[]) {
 		}
 	}
 
-	ifstream stream(input_file, ifstream::binary);
-	vector<NOTE> notes = read_notes(stream);
-	uint32_t width = get_width(notes) * (scale / 100.0);
+	if (extract_container) {
+		// The input is a container written with -a; its frames are written as separate BMP files again
+		MappedFrameContainer container(input_file);
+		extract_frames(container.container(), output_file, export_threads);
+		cout << "extracted " << container.container().frame_count() << " frames" << endl;
+		return 0;
+	}
+
+	vector<NOTE> notes;
+	if (use_note_cache) {
+		// The cache next to the input file is written on the first run and mapped on later ones.
+		// Everything below takes a vector<NOTE>, so the mapped records are converted once; that is a single
+		// pass over memory without any MIDI parsing
+		notes = load_or_create_note_cache(input_file, input_file + ".notes")->cache().to_notes();
+	}
+	else {
+		notes = (parse_threads == 1) ? read_notes_from_file(input_file) : read_notes_from_file_parallel(input_file, parse_threads);
+	}
+	uint64_t width = uint64_t(get_width(notes) * (scale / 100.0));
 	uint32_t height = get_note_height_difference(notes) * note_height;
 
+	// Only the tiled bitmap (-t) handles rolls wider than 32 bits, and frames are always narrower than that.
+	// Drawing on demand (-r) takes precedence over -t, and PianoRoll keeps its positions in 32 bits
+	if (width > UINT32_MAX && (tile_budget == 0 || render_on_demand)) {
+		cerr << "the roll is " << width << " pixels wide; rolls wider than " << UINT32_MAX << " pixels need -t without -r" << endl;
+		return 1;
+	}
 	if (frame_width == 0) {
-		frame_width = width;
+		if (width > UINT32_MAX) {
+			cerr << "the roll is " << width << " pixels wide; choose a frame width with -w" << endl;
+			return 1;
+		}
+		frame_width = uint32_t(width);
 	}
 
-	int low = get_lowest_note(notes);
 	int high = get_highest_note(notes);
-	cout << "bitmap size: " << width << " x " << get_note_height_difference(notes) * note_height << endl;
+	// Frames are written as BMP files or, with -v, as one video stream to a file, named pipe or standard output ("-")
+	bool streaming = !video_format.empty();
+	ostream& messages = streaming ? cerr : cout;
+	messages << "bitmap size: " << width << " x " << get_note_height_difference(notes) * note_height << endl;
 
-	//draw frames
-	Bitmap bitmap1(width, 128 * note_height);
-	for (int i = 0; i <= 127; i++) {
-		for (NOTE note : notes) {
-			if (note.note_number == NoteNumber(i)) {
-				draw_rectangle(
-					bitmap1,
-					Position(value(note.start) * (scale / 100.0), (127 - i) * note_height),
-					value(note.duration) * (scale / 100.0),
+	if (width == 0) {
+		// No note has a length (or there are no notes), so there is not a single column to draw
+		messages << "nothing to draw" << endl;
+		return 0;
+	}
+
+	// With -i the song is drawn as one byte per pixel (an instrument_index) instead of four; -b 8 then writes 8-bit BMP files.
+	// Drawing notes on demand or into tiles has no indexed variant, so -i only changes the full bitmap path
+	indexed = (indexed || bits_per_pixel == 8) && !render_on_demand && tile_budget == 0;
+	BmpFormat bmp_format = bits_per_pixel == 24 ? BmpFormat::BGR24 : (bits_per_pixel == 8 && indexed) ? BmpFormat::INDEXED8 : BmpFormat::BGRA32;
+	VideoFormat stream_format = video_format == "rgb" ? VideoFormat::RGB24 : VideoFormat::Y4M;
+	FrameEncoding format = streaming ? VideoEncoder::encoding(stream_format, frame_width, height, frame_rate) : FrameEncoding(bmp_format);
+	unique_ptr<OrderedFrameWriter> stream;
+	unique_ptr<FrameContainerWriter> container;
+	FrameSink sink;
+	if (streaming) {
+		stream = make_unique<OrderedFrameWriter>(output_file, VideoEncoder(stream_format, frame_width, height, frame_rate).header(), frames_in_flight(export_threads));
+		sink = stream->sink();
+	}
+	else if (use_container) {
+		// All frames go into output_file, which is then a single file rather than a pattern
+		container = make_unique<FrameContainerWriter>(output_file, compress_frames ? FrameCompression::LZ : FrameCompression::NONE);
+		sink = container->sink();
+	}
+	else {
+		sink = write_to_files(output_file);
+	}
+
+	// Frames equal to an earlier frame are not encoded; they become links (or container references) to it.
+	// A video stream needs every frame, so -u does not apply to it
+	unique_ptr<FrameDeduplicator> deduplicator;
+	if (deduplicate && !streaming) {
+		deduplicator = make_unique<FrameDeduplicator>();
+	}
+
+	ProgressReporter progress = [&messages](size_t done, size_t total) {
+		messages << "frames created: " << done << "/" << total << endl;
+	};
+	auto finish = [&]() {
+		if (deduplicator) {
+			vector<DUPLICATE_FRAME> duplicates = deduplicator->duplicates();
+			if (container) {
+				for (const DUPLICATE_FRAME& duplicate : duplicates) {
+					container->add_reference(duplicate.frame, duplicate.original);
+				}
+			}
+			else {
+				link_duplicate_files(output_file, duplicates);
+			}
+			messages << "duplicate frames: " << duplicates.size() << "/" << deduplicator->frames_seen()
+				<< ", " << duplicates.size() * BmpEncoder::file_size(bmp_format, frame_width, height) << " bytes not encoded" << endl;
+		}
+		if (container) {
+			container->close();
+			messages << "container: " << container->frame_bytes() << " bytes of frames stored in " << container->stored_bytes() << " bytes" << endl;
+		}
+		messages << "finished" << endl;
+	};
+
+	if (render_on_demand) {
+		// Draw frames straight from the notes instead of cutting them out of a bitmap of the whole song
+		PianoRoll roll(notes, scale, note_height);
+		int64_t top = note_height * (128 - high);
+		RepeatingBackground<RGBA8> background(min(frame_width, 256u), height, [&roll, top, draw_lanes](const FramebufferView<RGBA8>& tile) {
+			if (draw_lanes) {
+				roll.draw_lanes(tile, top);
+			}
+			else {
+				tile.fill(RGBA8());
+			}
+		});
+		auto draw = [&roll, &background, top](const FramebufferView<RGBA8>& target, int64_t x) {
+			background.draw(target, x);
+			roll.draw_notes(target, x, top);
+		};
+
+		if (step < frame_width) {
+			// Consecutive frames overlap, so only the columns each frame reveals are drawn
+			export_scrolling_frames(unsigned(width), frame_width, height, step, draw, format, export_threads, sink, progress, deduplicator.get());
+		}
+		else {
+			export_frames(frame_count(width, frame_width, step), frame_width, height, [&draw, step](size_t frame, const FramebufferView<RGBA8>& target) {
+				draw(target, int64_t(frame * step));
+			}, format, export_threads, sink, progress, deduplicator.get());
+		}
+		finish();
+		return 0;
+	}
+
+	if (tile_budget != 0) {
+		// Draw the song into a bitmap backed by a file, using at most tile_budget MB of memory for its tiles
+		string tiles_path = input_file + ".tiles";
+		{
+			TiledBitmap roll(width, height, tiles_path, size_t(tile_budget) << 20);
+			for (NOTE note : notes) {
+				roll.fill_rect(
+					int64_t(value(note.start) * (scale / 100.0)),
+					(int64_t(127 - value(note.note_number)) - (128 - high)) * note_height,
+					int64_t(value(note.duration) * (scale / 100.0)),
 					note_height,
-					Color((value(note.instrument) % 7) / 7.0, (value(note.instrument) % 17) / 17.0, (value(note.instrument) % 37) / 37.0));
+					instrument_color(note.instrument));
 			}
+			messages << "tiles stored: " << roll.stored_tiles() << endl;
+
+			export_frames(frame_count(width, frame_width, step), frame_width, height, [&roll, step](size_t frame, const FramebufferView<RGBA8>& target) {
+				roll.read(int64_t(frame * step), 0, target);
+			}, format, export_threads, sink, progress, deduplicator.get());
 		}
+		remove(tiles_path.c_str());
+		finish();
+		return 0;
 	}
 
-	//cropping
-	bitmap1 = *bitmap1.slice(0, note_height * (128 - high), width, get_note_height_difference(notes) * note_height).get();
-	
-	// save
-	for (int i = 0; i <= (width - frame_width); i += step) {
-		Bitmap temp = *bitmap1.slice(i, 0, frame_width, (high - low + 1) * note_height).get();
-		stringstream frame_nr;
-		frame_nr << setfill('0') << setw(5) << (i / step);
+	if (indexed) {
+		Framebuffer<uint8_t> roll(unsigned(width), height, 0);
+		draw_note_rows(roll.view(), notes, scale, note_height, note_height * (128 - high));
 
-		string out = output_file;
-		save_as_bmp(out.replace(out.find("%d"), 2, frame_nr.str()), temp);
-		cout << "frame " << (i / step) << " created" << endl;
+		FramebufferView<const uint8_t> song = roll.view();
+		Palette palette = instrument_palette();
+		if (streaming) {
+			// Video encoders take colours, so each frame is looked up in the palette just before it is encoded
+			export_frames(frame_count(width, frame_width, step), frame_width, height, [&song, &palette, frame_width, step](size_t frame, const FramebufferView<RGBA8>& target) {
+				apply_palette(target, song.sub_view(unsigned(frame * step), 0, frame_width, song.height()), palette);
+			}, format, export_threads, sink, progress);
+		}
+		else {
+			export_frames(song, palette, frame_width, step, bmp_format, export_threads, sink, progress, deduplicator.get());
+		}
+		finish();
+		return 0;
 	}
-	cout << "finished" << endl;
+
+	//draw frames
+	// Only the cropped rows are drawn; notes are bucketed by pitch once and every lane is filled row by row
+	RGBA8Bitmap bitmap1(unsigned(width), height);
+	draw_note_rows(bitmap1.view(), notes, scale, note_height, note_height * (128 - high));
+
+	// save
+	export_frames(bitmap1.view(), frame_width, step, format, export_threads, sink, progress, deduplicator.get());
+	finish();
 }
 
 #endif
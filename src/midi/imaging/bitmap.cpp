@@ -12,68 +12,92 @@
 
 using namespace imaging;
 
-Bitmap::Bitmap(std::shared_ptr<Grid<Color>> pixels)
-    : m_pixels(pixels)
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(std::shared_ptr<Framebuffer<PIXEL>> framebuffer, FramebufferView<PIXEL> view)
+    : m_framebuffer(framebuffer), m_view(view)
 {
     // NOP
 }
 
-Bitmap::Bitmap(unsigned width, unsigned height, std::function<Color(const Position&)> initializer)
-    : Bitmap(std::make_shared<ConcreteGrid<Color>>(width, height, initializer))
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(unsigned width, unsigned height, std::function<PIXEL(const Position&)> initializer)
+    : BasicBitmap(width, height)
 {
-    // NOP
+    m_view.for_each_row([width, &initializer](unsigned y, PIXEL* row) {
+        for (unsigned x = 0; x != width; ++x)
+        {
+            row[x] = initializer(Position(x, y));
+        }
+    });
 }
 
-Bitmap::Bitmap(unsigned width, unsigned height)
-    : Bitmap(width, height, [](const Position&) { return colors::black(); })
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(unsigned width, unsigned height)
+    : m_framebuffer(std::make_shared<Framebuffer<PIXEL>>(width, height, from_color<PIXEL>(colors::black())))
+    , m_view(m_framebuffer->view())
 {
     // NOP
 }
 
-unsigned Bitmap::width() const
+template<typename PIXEL>
+unsigned BasicBitmap<PIXEL>::width() const
 {
-    return m_pixels->width();
+    return m_view.width();
 }
 
-unsigned Bitmap::height() const
+template<typename PIXEL>
+unsigned BasicBitmap<PIXEL>::height() const
 {
-    return m_pixels->height();
+    return m_view.height();
 }
 
-bool Bitmap::is_inside(const Position& p) const
+template<typename PIXEL>
+bool BasicBitmap<PIXEL>::is_inside(const Position& p) const
 {
-    return p.x < width() && p.y < height();
+    return m_view.is_inside(p);
 }
 
-Color& Bitmap::operator[](const Position& p)
+template<typename PIXEL>
+PIXEL& BasicBitmap<PIXEL>::operator[](const Position& p)
 {
     assert(is_inside(p));
 
-    return (*m_pixels)[p];
+    return m_view[p];
 }
 
-const Color& Bitmap::operator[](const Position& p) const
+template<typename PIXEL>
+const PIXEL& BasicBitmap<PIXEL>::operator[](const Position& p) const
 {
     assert(is_inside(p));
 
-    return (*m_pixels)[p];
+    return m_view[p];
 }
 
-void Bitmap::clear(const Color& Color)
+template<typename PIXEL>
+void BasicBitmap<PIXEL>::clear(const PIXEL& color)
 {
-    for_each_position([this, &Color](const Position& p) {
-        (*m_pixels)[p] = Color;
-    });
+    m_view.fill(color);
 }
 
-void Bitmap::for_each_position(std::function<void(const Position&)> callback) const
+template<typename PIXEL>
+void BasicBitmap<PIXEL>::for_each_position(std::function<void(const Position&)> callback) const
 {
-    m_pixels->for_each_position(callback);
+    unsigned width = m_view.width();
+
+    m_view.for_each_row([width, &callback](unsigned y, PIXEL*) {
+        for (unsigned x = 0; x != width; ++x)
+        {
+            callback(Position(x, y));
+        }
+    });
 }
 
-std::shared_ptr<Bitmap> Bitmap::slice(int x, int y, int width, int height) const
+template<typename PIXEL>
+std::shared_ptr<BasicBitmap<PIXEL>> BasicBitmap<PIXEL>::slice(int x, int y, int width, int height) const
 {
-    auto sg = subgrid(m_pixels, Position(x, y), width, height);
+    return std::shared_ptr<BasicBitmap>( new BasicBitmap(m_framebuffer, m_view.sub_view(x, y, width, height)) );
+}
 
-    return std::shared_ptr<Bitmap>( new Bitmap(sg) );
-}
\ No newline at end of file
+template class imaging::BasicBitmap<Color>;
+template class imaging::BasicBitmap<RGBA8>;
+template class imaging::BasicBitmap<RGBF32>;
@@ -2,7 +2,9 @@
 #define BITMAP_H
 
 #include "imaging/color.h"
-#include "util/grid.h"
+#include "imaging/pixel-format.h"
+#include "imaging/framebuffer.h"
+#include "util/position.h"
 #include <memory>
 #include <string>
 #include <functional>
@@ -11,23 +13,28 @@
 namespace imaging
 {
     /// <summary>
-    /// Represents a bitmap, i.e. a 2D grid of colors.
+    /// Represents a bitmap, i.e. a 2D grid of pixels of type PIXEL.
+    /// Pixels live in a contiguous Framebuffer; slices share it and only differ in their view.
+    /// Instantiated for Color, RGBA8 and RGBF32 (see pixel-format.h).
     /// </summary>
-    class Bitmap final
+    template<typename PIXEL>
+    class BasicBitmap final
     {
     public:
-        Bitmap(unsigned width, unsigned height, std::function<Color(const Position&)> initializer);
+        typedef PIXEL pixel_type;
+
+        BasicBitmap(unsigned width, unsigned height, std::function<PIXEL(const Position&)> initializer);
 
         /// <summary>
         /// Creates a new bitmap width given <paramref name="width" /> and <paramref name="height" />.
         /// All pixels are initialized to black.
         /// </summary>
-        Bitmap(unsigned width, unsigned height);
+        BasicBitmap(unsigned width, unsigned height);
 
         /// <summary>
         /// Copy constructor.
         /// </summary>
-        Bitmap(const Bitmap&) = default;
+        BasicBitmap(const BasicBitmap&) = default;
 
         /// <summary>
         /// Checks if the given <paramref name="position" /> is inside the bitmap.
@@ -37,12 +44,12 @@ namespace imaging
         /// <summary>
         /// Gives access to the pixel at the given <paramref name="position" />.
         /// </summary>
-        Color& operator [](const Position& position);
+        PIXEL& operator [](const Position& position);
 
         /// <summary>
         /// Gives readonly access to the pixel at the given <paramref name="position" />.
         /// </summary>
-        const Color& operator [](const Position&) const;
+        const PIXEL& operator [](const Position&) const;
 
         /// <summary>
         /// Returns the width of the bitmap.
@@ -64,15 +71,79 @@ namespace imaging
         /// <summary>
         /// Overwrites all pixels with the given <paramref name="color" />.
         /// </summary>
-        void clear(const Color& color);
+        void clear(const PIXEL& color);
+
+        std::shared_ptr<BasicBitmap> slice(int x, int y, int width, int height) const;
+
+        /// <summary>
+        /// Returns a view on the pixels of this bitmap, for row-wise access.
+        /// Writing through the view modifies the bitmap (and all slices sharing its pixels).
+        /// </summary>
+        FramebufferView<PIXEL> view()
+        {
+            return m_view;
+        }
+
+        FramebufferView<const PIXEL> view() const
+        {
+            return m_view;
+        }
 
-        std::shared_ptr<Bitmap> slice(int x, int y, int width, int height) const;
+        /// <summary>
+        /// Returns a pointer to the width() consecutive pixels of row <paramref name="y" />.
+        /// </summary>
+        PIXEL* row(unsigned y)
+        {
+            return m_view.row(y);
+        }
+
+        const PIXEL* row(unsigned y) const
+        {
+            return m_view.row(y);
+        }
+
+        /// <summary>
+        /// Calls <paramref name="function" />(y, row) for each row, top to bottom.
+        /// Unlike for_each_position, the function is not wrapped in an std::function,
+        /// so the loop over the pixels of a row can be inlined.
+        /// </summary>
+        template<typename FUNCTION>
+        void for_each_row(FUNCTION function)
+        {
+            m_view.for_each_row(function);
+        }
+
+        template<typename FUNCTION>
+        void for_each_row(FUNCTION function) const
+        {
+            view().for_each_row(function);
+        }
 
     private:
-        Bitmap(std::shared_ptr<Grid<Color>> pixels);
+        BasicBitmap(std::shared_ptr<Framebuffer<PIXEL>> framebuffer, FramebufferView<PIXEL> view);
 
-        std::shared_ptr<Grid<Color>> m_pixels;
+        std::shared_ptr<Framebuffer<PIXEL>> m_framebuffer;
+        FramebufferView<PIXEL> m_view;
     };
+
+    /// <summary>
+    /// Bitmap with three doubles per pixel (24 bytes).
+    /// </summary>
+    typedef BasicBitmap<Color> Bitmap;
+
+    /// <summary>
+    /// Bitmap with 8 bits per channel (4 bytes per pixel), in the layout save_as_bmp writes.
+    /// </summary>
+    typedef BasicBitmap<RGBA8> RGBA8Bitmap;
+
+    /// <summary>
+    /// Bitmap with one float per channel (12 bytes per pixel).
+    /// </summary>
+    typedef BasicBitmap<RGBF32> RGBF32Bitmap;
+
+    extern template class BasicBitmap<Color>;
+    extern template class BasicBitmap<RGBA8>;
+    extern template class BasicBitmap<RGBF32>;
 }
 
 #endif
@@ -1,4 +1,5 @@
 #include "imaging/bmp-format.h"
+#include "logging.h"
 #include <algorithm>
 #include <assert.h>
 #include <stdint.h>
@@ -63,83 +64,256 @@ namespace
         FILE_HEADER      file_header;
         BITMAP_HEADER_V5 bitmap_header;
     };
+#   pragma pack(pop, r1)
+
+    static_assert(sizeof(RGBA8) == 4, "RGBA8 must match the 32-bit BMP pixel layout");
 
-    struct ARGB
+    size_t bytes_per_pixel(BmpFormat format)
     {
-        uint8_t b;
-        uint8_t g;
-        uint8_t r;
-        uint8_t a;
-    };
+        return format == BmpFormat::BGRA32 ? 4 : format == BmpFormat::BGR24 ? 3 : 1;
+    }
 
-    struct RGB
+    size_t row_size(BmpFormat format, unsigned width)
     {
-        uint8_t b;
-        uint8_t g;
-        uint8_t r;
-    };
-#   pragma pack(pop, r1)
+        // Rows are padded to a multiple of 4 bytes
+        return (size_t(width) * bytes_per_pixel(format) + 3) & ~size_t(3);
+    }
+
+    // Indexed files have a colour table between the headers and the pixels
+    size_t palette_size(BmpFormat format)
+    {
+        return format == BmpFormat::INDEXED8 ? sizeof(Palette) : 0;
+    }
+
+    void write_header(uint8_t* out, BmpFormat format, unsigned width, unsigned height)
+    {
+        BITMAP_FILE_V5 header;
+        memset(&header, 0, sizeof(header));
+
+        header.file_header.FileType = 0x4D42;
+        header.file_header.FileSize = uint32_t(BmpEncoder::file_size(format, width, height));
+        header.file_header.Reserved1 = 0;
+        header.file_header.Reserved2 = 0;
+        header.file_header.BitmapOffset = uint32_t(sizeof(BITMAP_FILE_V5) + palette_size(format));
+
+        header.bitmap_header.Size = sizeof(BITMAP_HEADER_V5);
+        header.bitmap_header.Width = width;
+        header.bitmap_header.Height = height;
+        header.bitmap_header.Planes = 1;
+        header.bitmap_header.BitsPerPixel = uint16_t(bytes_per_pixel(format) * 8);
+        header.bitmap_header.Compression = 0;
+        header.bitmap_header.SizeOfBitmap = 0;
+        header.bitmap_header.HorzResolution = 3779;
+        header.bitmap_header.VertResolution = 3779;
+        header.bitmap_header.ColorsUsed = format == BmpFormat::INDEXED8 ? 256 : 0;
+        header.bitmap_header.ColorsImportant = 0;
+
+        if (format == BmpFormat::BGRA32)
+        {
+            header.bitmap_header.RedMask = 0x00FF0000;
+            header.bitmap_header.GreenMask = 0x0000FF00;
+            header.bitmap_header.BlueMask = 0x000000FF;
+            header.bitmap_header.AlphaMask = 0xFF000000;
+        }
 
+        header.bitmap_header.CSType = 0x73524742;
+        header.bitmap_header.Intent = 4;
 
-    ARGB to_argb(const Color& c)
+        memcpy(out, &header, sizeof(header));
+    }
+
+    template<typename PIXEL>
+    void encode_bgra32_row(const PIXEL* row, unsigned width, uint8_t* out)
     {
-        uint8_t a = 255;
-        uint8_t r = uint8_t(c.r * 255);
-        uint8_t g = uint8_t(c.g * 255);
-        uint8_t b = uint8_t(c.b * 255);
+        std::transform(row, row + width, reinterpret_cast<RGBA8*>(out), [](const PIXEL& pixel) { return to_rgba8(pixel); });
+    }
 
-        return ARGB{ b, g, r, a };
+    // RGBA8 rows already have the BMP layout
+    void encode_bgra32_row(const RGBA8* row, unsigned width, uint8_t* out)
+    {
+        memcpy(out, row, sizeof(RGBA8) * width);
+    }
+
+    template<typename PIXEL>
+    void encode_bgr24_row(const PIXEL* row, unsigned width, uint8_t* out)
+    {
+        for (unsigned x = 0; x != width; ++x)
+        {
+            RGBA8 pixel = to_rgba8(row[x]);
+
+            out[0] = pixel.b;
+            out[1] = pixel.g;
+            out[2] = pixel.r;
+            out += 3;
+        }
     }
 }
 
-void imaging::save_as_bmp(const std::string& path, const Bitmap& bitmap)
+template<typename PIXEL>
+void imaging::save_as_bmp(const std::string& path, const BasicBitmap<PIXEL>& bitmap)
 {
-    std::ofstream out(path, std::ios::binary);
-    save_as_bmp(out, bitmap);
+    BmpEncoder().save(path, bitmap);
 }
 
-void imaging::save_as_bmp(std::ostream& out, const Bitmap& bitmap)
+template<typename PIXEL>
+void imaging::save_as_bmp(std::ostream& out, const BasicBitmap<PIXEL>& bitmap)
 {
-    BITMAP_FILE_V5 header;
-    memset(&header, 0, sizeof(header));
-
-    header.file_header.FileType = 0x4D42;
-    header.file_header.FileSize = sizeof(BITMAP_FILE_V5) + 4 * bitmap.width() * bitmap.height();
-    header.file_header.Reserved1 = 0;
-    header.file_header.Reserved2 = 0;
-    header.file_header.BitmapOffset = sizeof(BITMAP_FILE_V5);
-
-    header.bitmap_header.Size = sizeof(BITMAP_HEADER_V5);
-    header.bitmap_header.Width = bitmap.width();
-    header.bitmap_header.Height = bitmap.height();
-    header.bitmap_header.Planes = 1;
-    header.bitmap_header.BitsPerPixel = 32;
-    header.bitmap_header.Compression = 0;
-    header.bitmap_header.SizeOfBitmap = 0;
-    header.bitmap_header.HorzResolution = 3779;
-    header.bitmap_header.VertResolution = 3779;
-    header.bitmap_header.ColorsUsed = 0;
-    header.bitmap_header.ColorsImportant = 0;
-    header.bitmap_header.RedMask = 0x00FF0000;
-    header.bitmap_header.GreenMask = 0x0000FF00;
-    header.bitmap_header.BlueMask = 0x000000FF;
-    header.bitmap_header.AlphaMask = 0xFF000000;
-    header.bitmap_header.CSType = 0x73524742;
-    header.bitmap_header.Intent = 4;
-    
-    out.write(reinterpret_cast<char*>(&header), sizeof(header));
-
-    std::unique_ptr<ARGB[]> scanline = std::make_unique<ARGB[]>(bitmap.width());
-
-    for (int y = bitmap.height() - 1; y >= 0; --y)
+    BmpEncoder().write(out, bitmap);
+}
+
+imaging::BmpEncoder::BmpEncoder(BmpFormat format)
+    : m_format(format)
+{
+    // NOP
+}
+
+size_t imaging::BmpEncoder::file_size(BmpFormat format, unsigned width, unsigned height)
+{
+    return sizeof(BITMAP_FILE_V5) + palette_size(format) + row_size(format, width) * height;
+}
+
+template<typename PIXEL>
+const std::vector<uint8_t>& imaging::BmpEncoder::encode(const FramebufferView<const PIXEL>& pixels, unsigned rotation)
+{
+    CHECK(m_format != BmpFormat::INDEXED8) << "Indexed BMP files need indexed pixels and a palette";
+
+    // resize keeps the capacity, so frames of the same size reuse the allocation
+    m_buffer.resize(file_size(m_format, pixels.width(), pixels.height()));
+    write_header(m_buffer.data(), m_format, pixels.width(), pixels.height());
+    encode_pixels(pixels, rotation, m_buffer.data() + sizeof(BITMAP_FILE_V5));
+
+    return m_buffer;
+}
+
+const std::vector<uint8_t>& imaging::BmpEncoder::encode(const FramebufferView<const uint8_t>& indices, const Palette& palette, unsigned rotation)
+{
+    assert(rotation == 0 || rotation < indices.width());
+
+    if (m_format != BmpFormat::INDEXED8)
     {
-        for (unsigned x = 0; x < bitmap.width(); ++x)
+        // Colours are only looked up now, one row at a time
+        m_colors.resize(indices.width());
+        FramebufferView<const RGBA8> row(m_colors.data(), indices.width(), 1, indices.width());
+        size_t size = row_size(m_format, indices.width());
+
+        m_buffer.resize(file_size(m_format, indices.width(), indices.height()));
+        write_header(m_buffer.data(), m_format, indices.width(), indices.height());
+
+        uint8_t* out = m_buffer.data() + sizeof(BITMAP_FILE_V5);
+
+        for (unsigned y = indices.height(); y != 0; --y, out += size)
         {
-            Position pos(x, y);
+            std::transform(indices.row(y - 1), indices.row(y - 1) + indices.width(), m_colors.begin(), [&palette](uint8_t index) { return palette[index]; });
+            encode_pixels(row, rotation, out);
+        }
+
+        return m_buffer;
+    }
+
+    size_t size = row_size(m_format, indices.width());
+    unsigned head = indices.width() - rotation;
+
+    m_buffer.resize(file_size(m_format, indices.width(), indices.height()));
+    write_header(m_buffer.data(), m_format, indices.width(), indices.height());
+
+    // The colour table has the layout of RGBA8, with the alpha byte reserved
+    uint8_t* out = m_buffer.data() + sizeof(BITMAP_FILE_V5);
+    std::transform(palette.begin(), palette.end(), reinterpret_cast<RGBA8*>(out), [](RGBA8 color) { color.a = 0; return color; });
+    out += sizeof(Palette);
+
+    for (unsigned y = indices.height(); y != 0; --y, out += size)
+    {
+        const uint8_t* row = indices.row(y - 1);
+
+        memcpy(out, row + rotation, head);
+        memcpy(out + head, row, rotation);
+        memset(out + indices.width(), 0, size - indices.width());
+    }
+
+    return m_buffer;
+}
+
+const std::vector<uint8_t>& imaging::BmpEncoder::encode_header(unsigned width, unsigned height)
+{
+    CHECK(m_format != BmpFormat::INDEXED8) << "Indexed BMP files need a palette";
+
+    m_buffer.resize(sizeof(BITMAP_FILE_V5));
+    write_header(m_buffer.data(), m_format, width, height);
+
+    return m_buffer;
+}
+
+template<typename PIXEL>
+const std::vector<uint8_t>& imaging::BmpEncoder::encode_rows(const FramebufferView<const PIXEL>& pixels)
+{
+    m_buffer.resize(row_size(m_format, pixels.width()) * pixels.height());
+    encode_pixels(pixels, 0, m_buffer.data());
 
-            scanline[x] = to_argb(bitmap[pos]);
+    return m_buffer;
+}
+
+template<typename PIXEL>
+void imaging::BmpEncoder::encode_pixels(const FramebufferView<const PIXEL>& pixels, unsigned rotation, uint8_t* out) const
+{
+    assert(rotation == 0 || rotation < pixels.width());
+
+    size_t size = row_size(m_format, pixels.width());
+    unsigned head = pixels.width() - rotation;
+
+    // BMP rows are stored bottom-up
+    for (unsigned y = pixels.height(); y != 0; --y, out += size)
+    {
+        const PIXEL* row = pixels.row(y - 1);
+
+        // Columns [rotation, width) come first, followed by [0, rotation)
+        if (m_format == BmpFormat::BGRA32)
+        {
+            encode_bgra32_row(row + rotation, head, out);
+            encode_bgra32_row(row, rotation, out + size_t(head) * 4);
         }
+        else
+        {
+            size_t padding = size - size_t(pixels.width()) * 3;
 
-        out.write(reinterpret_cast<char*>(scanline.get()), sizeof(ARGB) * bitmap.width());
+            encode_bgr24_row(row + rotation, head, out);
+            encode_bgr24_row(row, rotation, out + size_t(head) * 3);
+            memset(out + size - padding, 0, padding);
+        }
     }
 }
+
+template<typename PIXEL>
+void imaging::BmpEncoder::write(std::ostream& out, const BasicBitmap<PIXEL>& bitmap)
+{
+    const std::vector<uint8_t>& file = encode(bitmap.view());
+
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+template<typename PIXEL>
+void imaging::BmpEncoder::save(const std::string& path, const BasicBitmap<PIXEL>& bitmap)
+{
+    std::ofstream out(path, std::ios::binary);
+
+    write(out, bitmap);
+}
+
+template void imaging::save_as_bmp(const std::string&, const BasicBitmap<Color>&);
+template void imaging::save_as_bmp(const std::string&, const BasicBitmap<RGBA8>&);
+template void imaging::save_as_bmp(const std::string&, const BasicBitmap<RGBF32>&);
+template void imaging::save_as_bmp(std::ostream&, const BasicBitmap<Color>&);
+template void imaging::save_as_bmp(std::ostream&, const BasicBitmap<RGBA8>&);
+template void imaging::save_as_bmp(std::ostream&, const BasicBitmap<RGBF32>&);
+
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode(const FramebufferView<const Color>&, unsigned);
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode(const FramebufferView<const RGBA8>&, unsigned);
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode(const FramebufferView<const RGBF32>&, unsigned);
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode_rows(const FramebufferView<const Color>&);
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode_rows(const FramebufferView<const RGBA8>&);
+template const std::vector<uint8_t>& imaging::BmpEncoder::encode_rows(const FramebufferView<const RGBF32>&);
+template void imaging::BmpEncoder::write(std::ostream&, const BasicBitmap<Color>&);
+template void imaging::BmpEncoder::write(std::ostream&, const BasicBitmap<RGBA8>&);
+template void imaging::BmpEncoder::write(std::ostream&, const BasicBitmap<RGBF32>&);
+template void imaging::BmpEncoder::save(const std::string&, const BasicBitmap<Color>&);
+template void imaging::BmpEncoder::save(const std::string&, const BasicBitmap<RGBA8>&);
+template void imaging::BmpEncoder::save(const std::string&, const BasicBitmap<RGBF32>&);
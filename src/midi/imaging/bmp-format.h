@@ -2,12 +2,113 @@
 #define BMP_FORMAT_H
 
 #include "imaging/bitmap.h"
+#include "imaging/framebuffer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
 
 
 namespace imaging
 {
-    void save_as_bmp(const std::string& path, const Bitmap& bitmap);
-    void save_as_bmp(std::ostream& out, const Bitmap& bitmap);
+    /// <summary>
+    /// Writes <paramref name="bitmap" /> as a 32-bit BMP file.
+    /// RGBA8 bitmaps are written as they are; other pixel formats are converted to RGBA8 first.
+    /// Instantiated for Color, RGBA8 and RGBF32.
+    /// </summary>
+    template<typename PIXEL>
+    void save_as_bmp(const std::string& path, const BasicBitmap<PIXEL>& bitmap);
+
+    template<typename PIXEL>
+    void save_as_bmp(std::ostream& out, const BasicBitmap<PIXEL>& bitmap);
+
+    /// <summary>
+    /// Pixel layouts BmpEncoder can write.
+    /// BGRA32 matches save_as_bmp; BGR24 drops alpha and makes files a quarter smaller.
+    /// INDEXED8 stores a palette and one byte per pixel, and can only be written from indexed pixels.
+    /// </summary>
+    enum class BmpFormat
+    {
+        BGRA32,
+        BGR24,
+        INDEXED8
+    };
+
+    /// <summary>
+    /// Encodes whole BMP files into a buffer which is kept between calls, so that
+    /// writing a long series of equally sized frames allocates only once.
+    /// Each file is written with a single write. Rows are copied straight from the framebuffer;
+    /// RGBA8 rows need no conversion at all in BGRA32 mode.
+    /// Instantiated for Color, RGBA8 and RGBF32.
+    /// </summary>
+    class BmpEncoder final
+    {
+    public:
+        explicit BmpEncoder(BmpFormat format = BmpFormat::BGRA32);
+
+        BmpFormat format() const
+        {
+            return m_format;
+        }
+
+        /// <summary>
+        /// Encodes <paramref name="pixels" /> as a complete BMP file.
+        /// With a nonzero <paramref name="rotation" />, every row is rotated left by that many pixels while
+        /// it is encoded, i.e. the image starts at column rotation and wraps around (see ScrollingFramebuffer).
+        /// The returned buffer belongs to the encoder and is overwritten by the next call.
+        /// </summary>
+        template<typename PIXEL>
+        const std::vector<uint8_t>& encode(const FramebufferView<const PIXEL>& pixels, unsigned rotation = 0);
+
+        template<typename PIXEL>
+        const std::vector<uint8_t>& encode(const FramebufferView<PIXEL>& pixels, unsigned rotation = 0)
+        {
+            return encode(FramebufferView<const PIXEL>(pixels), rotation);
+        }
+
+        /// <summary>
+        /// Encodes pixels that are indices into <paramref name="palette" />. In INDEXED8 format the indices are written
+        /// as they are, after the palette; the other formats look up the colour of each pixel while encoding.
+        /// </summary>
+        const std::vector<uint8_t>& encode(const FramebufferView<const uint8_t>& indices, const Palette& palette, unsigned rotation = 0);
+
+        /// <summary>
+        /// Encodes only the headers of a <paramref name="width" /> x <paramref name="height" /> file.
+        /// Together with encode_rows, this writes images too large to hold in memory at once. Not for INDEXED8.
+        /// </summary>
+        const std::vector<uint8_t>& encode_header(unsigned width, unsigned height);
+
+        /// <summary>
+        /// Encodes the rows of <paramref name="pixels" /> without headers, bottom row first, as they appear in a file.
+        /// Writing encode_header followed by the bands of an image from the bottom up gives the same bytes as encode.
+        /// </summary>
+        template<typename PIXEL>
+        const std::vector<uint8_t>& encode_rows(const FramebufferView<const PIXEL>& pixels);
+
+        template<typename PIXEL>
+        const std::vector<uint8_t>& encode_rows(const FramebufferView<PIXEL>& pixels)
+        {
+            return encode_rows(FramebufferView<const PIXEL>(pixels));
+        }
+
+        template<typename PIXEL>
+        void write(std::ostream& out, const BasicBitmap<PIXEL>& bitmap);
+
+        template<typename PIXEL>
+        void save(const std::string& path, const BasicBitmap<PIXEL>& bitmap);
+
+        /// <summary>
+        /// Size in bytes of a BMP file with the given format and dimensions.
+        /// </summary>
+        static size_t file_size(BmpFormat format, unsigned width, unsigned height);
+
+    private:
+        template<typename PIXEL>
+        void encode_pixels(const FramebufferView<const PIXEL>& pixels, unsigned rotation, uint8_t* out) const;
+
+        BmpFormat m_format;
+        std::vector<uint8_t> m_buffer;
+        std::vector<RGBA8> m_colors;
+    };
 }
 
 #endif
@@ -0,0 +1,69 @@
+#include "imaging/drawing.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#   define IMAGING_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define IMAGING_SSE2
+#endif
+
+#if defined(IMAGING_AVX2) || defined(IMAGING_SSE2)
+#   include <immintrin.h>
+#endif
+
+
+using namespace imaging;
+
+namespace
+{
+    uint32_t as_uint32(const RGBA8& color)
+    {
+        uint32_t result;
+
+        std::memcpy(&result, &color, sizeof(result));
+
+        return result;
+    }
+}
+
+void imaging::details::fill_row_scalar(RGBA8* row, size_t count, const RGBA8& color)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        row[i] = color;
+    }
+}
+
+void imaging::details::fill_row(RGBA8* row, size_t count, const RGBA8& color)
+{
+    uint8_t* out = reinterpret_cast<uint8_t*>(row);
+    uint8_t* end = out + count * sizeof(RGBA8);
+    int32_t pattern = int32_t(as_uint32(color));
+
+#if defined(IMAGING_AVX2)
+    __m256i pixels8 = _mm256_set1_epi32(pattern);
+
+    while (end - out >= 32)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), pixels8);
+        out += 32;
+    }
+#endif
+
+#if defined(IMAGING_SSE2)
+    __m128i pixels4 = _mm_set1_epi32(pattern);
+
+    while (end - out >= 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixels4);
+        out += 16;
+    }
+#endif
+
+    while (out != end)
+    {
+        std::memcpy(out, &pattern, sizeof(pattern));
+        out += sizeof(pattern);
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef DRAWING_H
+#define DRAWING_H
+
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+
+namespace imaging
+{
+    namespace details
+    {
+        // Keeps source views out of template argument deduction, so mutable views can be passed as sources
+        template<typename PIXEL>
+        using SourceView = FramebufferView<const typename std::remove_const<PIXEL>::type>;
+
+        /// <summary>
+        /// Clips the span [<paramref name="start" />, <paramref name="start" /> + <paramref name="size" />)
+        /// to [0, <paramref name="limit" />). Returns false if nothing remains.
+        /// </summary>
+        inline bool clip(int64_t* start, int64_t* size, unsigned limit)
+        {
+            int64_t begin = std::max<int64_t>(*start, 0);
+            int64_t end = std::min<int64_t>(*start + *size, limit);
+
+            *start = begin;
+            *size = end - begin;
+
+            return begin < end;
+        }
+
+        /// <summary>
+        /// Sets <paramref name="count" /> pixels starting at <paramref name="row" /> to <paramref name="color" />,
+        /// using AVX2 or SSE2 stores when the compiler targets them.
+        /// </summary>
+        void fill_row(RGBA8* row, size_t count, const RGBA8& color);
+
+        /// <summary>
+        /// Same as fill_row, without SIMD. Kept for tests and benchmarks.
+        /// </summary>
+        void fill_row_scalar(RGBA8* row, size_t count, const RGBA8& color);
+
+        template<typename PIXEL>
+        void fill_row(PIXEL* row, size_t count, const PIXEL& color)
+        {
+            std::fill_n(row, count, color);
+        }
+    }
+
+    /// <summary>
+    /// Fills the rectangle with top left corner (<paramref name="x" />, <paramref name="y" />) and
+    /// size <paramref name="width" /> x <paramref name="height" /> with <paramref name="color" />.
+    /// The rectangle is clipped to <paramref name="target" />, so it may lie partly or entirely outside it.
+    /// </summary>
+    template<typename PIXEL>
+    void fill_rect(const FramebufferView<PIXEL>& target, int64_t x, int64_t y, int64_t width, int64_t height, const PIXEL& color)
+    {
+        if (details::clip(&x, &width, target.width()) && details::clip(&y, &height, target.height()))
+        {
+            for (int64_t i = 0; i != height; ++i)
+            {
+                details::fill_row(target.row(unsigned(y + i)) + x, size_t(width), color);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Copies <paramref name="source" /> into <paramref name="target" /> so that its top left corner
+    /// ends up at (<paramref name="x" />, <paramref name="y" />). Parts falling outside target are skipped.
+    /// Source and target must not overlap.
+    /// </summary>
+    template<typename PIXEL>
+    void blit(const FramebufferView<PIXEL>& target, int64_t x, int64_t y, const details::SourceView<PIXEL>& source)
+    {
+        int64_t left = x, top = y, width = source.width(), height = source.height();
+
+        if (details::clip(&left, &width, target.width()) && details::clip(&top, &height, target.height()))
+        {
+            unsigned source_x = unsigned(left - x);
+            unsigned source_y = unsigned(top - y);
+
+            for (int64_t i = 0; i != height; ++i)
+            {
+                const PIXEL* from = source.row(unsigned(source_y + i)) + source_x;
+
+                std::copy_n(from, size_t(width), target.row(unsigned(top + i)) + left);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Copies <paramref name="count" /> rows of <paramref name="source" />, starting at row
+    /// <paramref name="source_y" />, to <paramref name="target" />, starting at row <paramref name="target_y" />.
+    /// Rows are copied from their first pixel on, for the smaller of both widths, and the row range is clipped to
+    /// both views. Source and target may be views on the same pixels, e.g. to scroll a framebuffer vertically.
+    /// </summary>
+    template<typename PIXEL>
+    void copy_rows(const FramebufferView<PIXEL>& target, unsigned target_y, const details::SourceView<PIXEL>& source, unsigned source_y, unsigned count)
+    {
+        if (target_y >= target.height() || source_y >= source.height())
+        {
+            return;
+        }
+
+        count = std::min(count, std::min(target.height() - target_y, source.height() - source_y));
+        size_t width = std::min(target.width(), source.width());
+
+        if (count == 0 || width == 0)
+        {
+            return;
+        }
+
+        // When moving rows down within the same pixels, start with the last row so rows are read before they are overwritten
+        bool backwards = std::less<const PIXEL*>()(source.row(source_y), target.row(target_y));
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            unsigned k = backwards ? count - 1 - i : i;
+            const PIXEL* from = source.row(source_y + k);
+            PIXEL* to = target.row(target_y + k);
+
+            // Rows of the same framebuffer can overlap when target and source have different x offsets
+            if (std::less<const PIXEL*>()(from, to))
+            {
+                std::copy_backward(from, from + width, to + width);
+            }
+            else
+            {
+                std::copy(from, from + width, to);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Replaces every index in <paramref name="indices" /> by its colour in <paramref name="palette" />,
+    /// writing the colours to <paramref name="target" />, which must have the same size.
+    /// </summary>
+    inline void apply_palette(const FramebufferView<RGBA8>& target, const FramebufferView<const uint8_t>& indices, const Palette& palette)
+    {
+        assert(target.width() == indices.width() && target.height() == indices.height());
+
+        unsigned width = indices.width();
+
+        target.for_each_row([&](unsigned y, RGBA8* row) {
+            const uint8_t* from = indices.row(y);
+
+            for (unsigned x = 0; x != width; ++x)
+            {
+                row[x] = palette[from[x]];
+            }
+        });
+    }
+}
+
+#endif
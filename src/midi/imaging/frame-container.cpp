@@ -0,0 +1,244 @@
+#include "imaging/frame-container.h"
+#include "io/lz.h"
+#include "util/parallel.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstring>
+
+
+using namespace imaging;
+
+namespace
+{
+    const char FRAME_CONTAINER_ID[8] = { 'M', 'I', 'D', 'I', 'F', 'R', 'M', 'S' };
+    const char FRAME_INDEX_ID[8] = { 'F', 'R', 'M', 'I', 'N', 'D', 'E', 'X' };
+
+    const FRAME_CONTAINER_TRAILER* find_trailer(const uint8_t* data, size_t size)
+    {
+        if (size < sizeof(FRAME_CONTAINER_HEADER) + sizeof(FRAME_CONTAINER_TRAILER))
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<const FRAME_CONTAINER_TRAILER*>(data + size - sizeof(FRAME_CONTAINER_TRAILER));
+    }
+}
+
+bool imaging::is_frame_container(const uint8_t* data, size_t size)
+{
+    const FRAME_CONTAINER_TRAILER* trailer = find_trailer(data, size);
+
+    if (trailer == nullptr)
+    {
+        return false;
+    }
+
+    const FRAME_CONTAINER_HEADER* header = reinterpret_cast<const FRAME_CONTAINER_HEADER*>(data);
+
+    if (std::memcmp(header->id, FRAME_CONTAINER_ID, sizeof(header->id)) != 0 || header->version != FRAME_CONTAINER_VERSION || header->header_size != sizeof(FRAME_CONTAINER_HEADER))
+    {
+        return false;
+    }
+
+    if (std::memcmp(trailer->id, FRAME_INDEX_ID, sizeof(trailer->id)) != 0)
+    {
+        return false;
+    }
+
+    uint64_t index_end = size - sizeof(FRAME_CONTAINER_TRAILER);
+
+    if (trailer->index_offset < header->header_size || trailer->index_offset > index_end || trailer->frame_count != (index_end - trailer->index_offset) / sizeof(FRAME_INDEX_ENTRY) || (index_end - trailer->index_offset) % sizeof(FRAME_INDEX_ENTRY) != 0)
+    {
+        return false;
+    }
+
+    const FRAME_INDEX_ENTRY* index = reinterpret_cast<const FRAME_INDEX_ENTRY*>(data + trailer->index_offset);
+
+    for (uint64_t i = 0; i != trailer->frame_count; ++i)
+    {
+        const FRAME_INDEX_ENTRY& entry = index[i];
+
+        if (entry.offset > trailer->index_offset || entry.stored_size > trailer->index_offset - entry.offset)
+        {
+            return false;
+        }
+        if (entry.compression == uint32_t(FrameCompression::NONE) ? entry.stored_size != entry.size : entry.compression != uint32_t(FrameCompression::LZ))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+imaging::FrameContainerWriter::FrameContainerWriter(const std::string& path, FrameCompression compression)
+    : m_file(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc)), m_out(*m_file), m_compression(compression), m_offset(0), m_frame_bytes(0), m_stored_bytes(0), m_closed(false)
+{
+    CHECK(*m_file) << "Could not open " << path;
+
+    write_header();
+}
+
+imaging::FrameContainerWriter::FrameContainerWriter(std::ostream& out, FrameCompression compression)
+    : m_out(out), m_compression(compression), m_offset(0), m_frame_bytes(0), m_stored_bytes(0), m_closed(false)
+{
+    write_header();
+}
+
+imaging::FrameContainerWriter::~FrameContainerWriter()
+{
+    close();
+}
+
+void imaging::FrameContainerWriter::write_header()
+{
+    FRAME_CONTAINER_HEADER header = { };
+    std::memcpy(header.id, FRAME_CONTAINER_ID, sizeof(header.id));
+    header.version = FRAME_CONTAINER_VERSION;
+    header.header_size = sizeof(FRAME_CONTAINER_HEADER);
+
+    append(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+}
+
+void imaging::FrameContainerWriter::append(const uint8_t* data, size_t size)
+{
+    m_out.write(reinterpret_cast<const char*>(data), size);
+    CHECK(m_out) << "Could not write frame container";
+    m_offset += size;
+}
+
+void imaging::FrameContainerWriter::write(size_t frame, const std::vector<uint8_t>& data)
+{
+    // Each thread keeps its compression buffer, so compressing a frame does not allocate
+    thread_local std::vector<uint8_t> compressed;
+    const uint8_t* stored = data.data();
+    size_t stored_size = data.size();
+    FrameCompression compression = FrameCompression::NONE;
+
+    if (m_compression == FrameCompression::LZ)
+    {
+        compressed.clear();
+        io::lz_compress(data.data(), data.size(), &compressed);
+
+        // Frames that do not get smaller are stored as they are
+        if (compressed.size() < data.size())
+        {
+            stored = compressed.data();
+            stored_size = compressed.size();
+            compression = FrameCompression::LZ;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (frame >= m_index.size())
+    {
+        m_index.resize(frame + 1, FRAME_INDEX_ENTRY());
+    }
+
+    FRAME_INDEX_ENTRY& entry = m_index[frame];
+    entry.offset = m_offset;
+    entry.stored_size = stored_size;
+    entry.size = data.size();
+    entry.compression = uint32_t(compression);
+    m_frame_bytes += data.size();
+    m_stored_bytes += stored_size;
+
+    append(stored, stored_size);
+}
+
+void imaging::FrameContainerWriter::add_reference(size_t frame, size_t original)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_references.emplace_back(frame, original);
+}
+
+FrameSink imaging::FrameContainerWriter::sink()
+{
+    return [this](size_t frame, const std::vector<uint8_t>& data) {
+        write(frame, data);
+    };
+}
+
+void imaging::FrameContainerWriter::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+    {
+        return;
+    }
+
+    for (auto& reference : m_references)
+    {
+        size_t size = std::max(reference.first, reference.second) + 1;
+
+        if (size > m_index.size())
+        {
+            m_index.resize(size, FRAME_INDEX_ENTRY());
+        }
+        m_index[reference.first] = m_index[reference.second];
+    }
+
+    FRAME_CONTAINER_TRAILER trailer = { };
+    trailer.index_offset = m_offset;
+    trailer.frame_count = m_index.size();
+    std::memcpy(trailer.id, FRAME_INDEX_ID, sizeof(trailer.id));
+
+    append(reinterpret_cast<const uint8_t*>(m_index.data()), m_index.size() * sizeof(FRAME_INDEX_ENTRY));
+    append(reinterpret_cast<const uint8_t*>(&trailer), sizeof(trailer));
+    m_out.flush();
+    m_closed = true;
+}
+
+uint64_t imaging::FrameContainerWriter::frame_bytes() const
+{
+    return m_frame_bytes;
+}
+
+uint64_t imaging::FrameContainerWriter::stored_bytes() const
+{
+    return m_stored_bytes;
+}
+
+imaging::FrameContainer::FrameContainer(const uint8_t* data, size_t size)
+    : m_data(data), m_trailer(find_trailer(data, size)), m_index(nullptr)
+{
+    CHECK(is_frame_container(data, size)) << "Not a valid frame container";
+
+    m_index = reinterpret_cast<const FRAME_INDEX_ENTRY*>(data + m_trailer->index_offset);
+}
+
+void imaging::FrameContainer::read(size_t frame, std::vector<uint8_t>* out) const
+{
+    const FRAME_INDEX_ENTRY& entry = m_index[frame];
+
+    out->resize(size_t(entry.size));
+
+    if (entry.compression == uint32_t(FrameCompression::LZ))
+    {
+        CHECK(io::lz_decompress(stored_data(frame), size_t(entry.stored_size), out->data(), out->size())) << "Frame " << frame << " is damaged";
+    }
+    else
+    {
+        std::memcpy(out->data(), stored_data(frame), out->size());
+    }
+}
+
+imaging::MappedFrameContainer::MappedFrameContainer(const std::string& path)
+    : m_file(std::make_unique<io::MemoryMappedFile>(path)), m_container(m_file->data(), m_file->size())
+{
+    // NOP
+}
+
+void imaging::extract_frames(const FrameContainer& container, const std::string& pattern, unsigned threads)
+{
+    FrameSink sink = write_to_files(pattern);
+    std::vector<std::vector<uint8_t>> buffers(effective_thread_count(container.frame_count(), threads));
+
+    parallel_for_worker(container.frame_count(), threads, [&](unsigned worker, size_t frame) {
+        container.read(frame, &buffers[worker]);
+        sink(frame, buffers[worker]);
+    });
+}
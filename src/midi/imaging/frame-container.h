@@ -0,0 +1,180 @@
+#ifndef FRAME_CONTAINER_H
+#define FRAME_CONTAINER_H
+
+#include "imaging/frame-export.h"
+#include "io/memory-mapped-file.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace imaging
+{
+    const uint32_t FRAME_CONTAINER_VERSION = 1;
+
+    enum class FrameCompression : uint32_t
+    {
+        NONE = 0,
+        LZ = 1
+    };
+
+    // On-disk layout: the header, the frames in the order they were written, then an index with one
+    // FRAME_INDEX_ENTRY per frame in frame order, and finally the trailer, which points to the index.
+    // Writing the index last lets frames be appended as they are finished, in any order.
+    // Records are written in the byte order of the host and every record is a multiple of 8 bytes.
+    // A container written on a host with the other byte order fails the version check (is_frame_container).
+#pragma pack(push, 1)
+    struct FRAME_CONTAINER_HEADER
+    {
+        char id[8];
+        uint32_t version;
+        uint32_t header_size;
+    };
+
+    struct FRAME_INDEX_ENTRY
+    {
+        uint64_t offset;
+        uint64_t stored_size;
+        uint64_t size;
+        uint32_t compression;
+        uint32_t reserved;
+    };
+
+    struct FRAME_CONTAINER_TRAILER
+    {
+        uint64_t index_offset;
+        uint64_t frame_count;
+        char id[8];
+    };
+#pragma pack(pop)
+
+    /// <summary>
+    /// Checks the ids, version and bounds of a frame container, including every index entry.
+    /// </summary>
+    bool is_frame_container(const uint8_t* data, size_t size);
+
+    /// <summary>
+    /// Writes frames (e.g. BMP files, as produced by export_frames) into a single container file.
+    /// write is safe to call from several workers at once and frames may arrive in any order;
+    /// compression happens outside the lock. Frames that are never written are stored as empty.
+    /// Several index entries may share the same data (see add_reference).
+    /// </summary>
+    class FrameContainerWriter final
+    {
+    public:
+        FrameContainerWriter(const std::string& path, FrameCompression compression = FrameCompression::NONE);
+        FrameContainerWriter(std::ostream& out, FrameCompression compression = FrameCompression::NONE);
+        ~FrameContainerWriter();
+
+        FrameContainerWriter(const FrameContainerWriter&) = delete;
+        FrameContainerWriter& operator =(const FrameContainerWriter&) = delete;
+
+        void write(size_t frame, const std::vector<uint8_t>& data);
+
+        /// <summary>
+        /// Stores <paramref name="frame" /> as a reference to the bytes of <paramref name="original" />: both index entries
+        /// point to the same data. The original must be written before close.
+        /// </summary>
+        void add_reference(size_t frame, size_t original);
+
+        /// <summary>
+        /// Sink that passes frames to write. The writer must outlive it.
+        /// </summary>
+        FrameSink sink();
+
+        /// <summary>
+        /// Writes the index and the trailer. Called by the destructor if it has not been called before.
+        /// </summary>
+        void close();
+
+        /// <summary>
+        /// Total size of the frames written before and after compression. References do not count.
+        /// </summary>
+        uint64_t frame_bytes() const;
+        uint64_t stored_bytes() const;
+
+    private:
+        void write_header();
+        void append(const uint8_t* data, size_t size);
+
+        std::unique_ptr<std::ofstream> m_file;
+        std::ostream& m_out;
+        FrameCompression m_compression;
+        std::mutex m_mutex;
+        std::vector<FRAME_INDEX_ENTRY> m_index;
+        std::vector<std::pair<size_t, size_t>> m_references;
+        uint64_t m_offset;
+        uint64_t m_frame_bytes;
+        uint64_t m_stored_bytes;
+        bool m_closed;
+    };
+
+    /// <summary>
+    /// Non-owning view of a frame container. Finding a frame is a lookup in the index;
+    /// uncompressed frames are returned without copying.
+    /// </summary>
+    class FrameContainer final
+    {
+    public:
+        FrameContainer(const uint8_t* data, size_t size);
+
+        size_t frame_count() const
+        {
+            return size_t(m_trailer->frame_count);
+        }
+
+        const FRAME_INDEX_ENTRY& entry(size_t frame) const
+        {
+            return m_index[frame];
+        }
+
+        /// <summary>
+        /// The bytes of <paramref name="frame" /> as stored, i.e. compressed if entry(frame).compression says so.
+        /// </summary>
+        const uint8_t* stored_data(size_t frame) const
+        {
+            return m_data + m_index[frame].offset;
+        }
+
+        /// <summary>
+        /// Stores the bytes of <paramref name="frame" /> in <paramref name="out" />, decompressing them if needed.
+        /// </summary>
+        void read(size_t frame, std::vector<uint8_t>* out) const;
+
+    private:
+        const uint8_t* m_data;
+        const FRAME_CONTAINER_TRAILER* m_trailer;
+        const FRAME_INDEX_ENTRY* m_index;
+    };
+
+    /// <summary>
+    /// A frame container file mapped into memory. The view stays valid as long as the object.
+    /// </summary>
+    class MappedFrameContainer final
+    {
+    public:
+        explicit MappedFrameContainer(const std::string& path);
+
+        const FrameContainer& container() const
+        {
+            return m_container;
+        }
+
+    private:
+        std::unique_ptr<io::MemoryMappedFile> m_file;
+        FrameContainer m_container;
+    };
+
+    /// <summary>
+    /// Writes every frame of <paramref name="container" /> to frame_path(<paramref name="pattern" />, frame),
+    /// which gives the same files as exporting with write_to_files. Uses <paramref name="threads" /> workers (0 = one per core).
+    /// </summary>
+    void extract_frames(const FrameContainer& container, const std::string& pattern, unsigned threads);
+}
+
+#endif
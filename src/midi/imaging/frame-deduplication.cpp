@@ -0,0 +1,111 @@
+#include "imaging/frame-deduplication.h"
+#include "imaging/frame-export.h"
+#include "io/hard-link.h"
+#include "util/hash64.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+
+using namespace imaging;
+
+namespace
+{
+    template<typename PIXEL>
+    uint64_t hash_pixels(const FramebufferView<const PIXEL>& frame, unsigned rotation)
+    {
+        Hash64 hash;
+        unsigned head = frame.width() - rotation;
+
+        if (rotation == 0 && frame.is_contiguous())
+        {
+            hash.update(frame.data(), size_t(frame.width()) * frame.height() * sizeof(PIXEL));
+        }
+        else
+        {
+            frame.for_each_row([&](unsigned, const PIXEL* row) {
+                hash.update(row + rotation, size_t(head) * sizeof(PIXEL));
+                hash.update(row, size_t(rotation) * sizeof(PIXEL));
+            });
+        }
+
+        return hash.digest();
+    }
+}
+
+uint64_t imaging::frame_hash(const FramebufferView<const RGBA8>& frame, unsigned rotation)
+{
+    return hash_pixels(frame, rotation);
+}
+
+uint64_t imaging::frame_hash(const FramebufferView<const uint8_t>& frame, unsigned rotation)
+{
+    return hash_pixels(frame, rotation);
+}
+
+bool imaging::FrameDeduplicator::add(size_t frame, const FramebufferView<const RGBA8>& pixels, unsigned rotation)
+{
+    return add(frame, frame_hash(pixels, rotation));
+}
+
+bool imaging::FrameDeduplicator::add(size_t frame, const FramebufferView<const uint8_t>& indices, unsigned rotation)
+{
+    return add(frame, frame_hash(indices, rotation));
+}
+
+bool imaging::FrameDeduplicator::add(size_t frame, uint64_t hash)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_frames_seen;
+
+    auto inserted = m_originals.emplace(hash, frame);
+
+    if (inserted.second)
+    {
+        return false;
+    }
+
+    m_duplicates.push_back(DUPLICATE_FRAME{ frame, inserted.first->second });
+
+    return true;
+}
+
+std::vector<DUPLICATE_FRAME> imaging::FrameDeduplicator::duplicates() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DUPLICATE_FRAME> result = m_duplicates;
+
+    std::sort(result.begin(), result.end(), [](const DUPLICATE_FRAME& x, const DUPLICATE_FRAME& y) { return x.frame < y.frame; });
+
+    return result;
+}
+
+size_t imaging::FrameDeduplicator::frames_seen() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_frames_seen;
+}
+
+void imaging::link_duplicate_files(const std::string& pattern, const std::vector<DUPLICATE_FRAME>& duplicates)
+{
+    for (const DUPLICATE_FRAME& duplicate : duplicates)
+    {
+        std::string original = frame_path(pattern, duplicate.original);
+        std::string path = frame_path(pattern, duplicate.frame);
+
+        // A file left by an earlier export would make linking fail
+        std::remove(path.c_str());
+
+        if (!io::create_hard_link(original, path))
+        {
+            std::ifstream in(original, std::ios::binary);
+            std::ofstream out(path, std::ios::binary);
+
+            CHECK(in && out) << "Could not copy " << original << " to " << path;
+            out << in.rdbuf();
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef FRAME_DEDUPLICATION_H
+#define FRAME_DEDUPLICATION_H
+
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// XXH64 of the pixels of <paramref name="frame" /> in screen order, i.e. with every row rotated left by
+    /// <paramref name="rotation" /> pixels (see ScrollingFramebuffer), so a frame hashes the same however it is stored.
+    /// </summary>
+    uint64_t frame_hash(const FramebufferView<const RGBA8>& frame, unsigned rotation = 0);
+
+    /// <summary>
+    /// Same for frames of palette indices.
+    /// </summary>
+    uint64_t frame_hash(const FramebufferView<const uint8_t>& frame, unsigned rotation = 0);
+
+    /// <summary>
+    /// Frame that has the same pixels as an earlier-seen frame, which is the one actually encoded.
+    /// </summary>
+    struct DUPLICATE_FRAME
+    {
+        size_t frame;
+        size_t original;
+    };
+
+    /// <summary>
+    /// Recognizes frames with the same pixels as a frame seen before (long rests and held chords make many),
+    /// so they need not be encoded again. Frames are compared by frame_hash only: two different frames
+    /// are taken for equal with a probability of about 2^-64 per pair.
+    /// add is safe to call from several workers at once; hashing happens outside the lock.
+    /// As workers finish frames out of order, the original of a duplicate may have a higher frame number.
+    /// </summary>
+    class FrameDeduplicator final
+    {
+    public:
+        /// <summary>
+        /// Returns true if <paramref name="frame" /> is a duplicate, in which case it is recorded and should not be encoded.
+        /// </summary>
+        bool add(size_t frame, const FramebufferView<const RGBA8>& pixels, unsigned rotation = 0);
+        bool add(size_t frame, const FramebufferView<const uint8_t>& indices, unsigned rotation = 0);
+
+        /// <summary>
+        /// All duplicates found so far, ordered by frame.
+        /// </summary>
+        std::vector<DUPLICATE_FRAME> duplicates() const;
+
+        size_t frames_seen() const;
+
+    private:
+        bool add(size_t frame, uint64_t hash);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<uint64_t, size_t> m_originals;
+        std::vector<DUPLICATE_FRAME> m_duplicates;
+        size_t m_frames_seen = 0;
+    };
+
+    /// <summary>
+    /// Makes frame_path(<paramref name="pattern" />, duplicate.frame) a hard link to the file of its original
+    /// for every duplicate, replacing any file that is in the way. Where hard links are not supported,
+    /// the file is copied instead. Originals must have been written already.
+    /// </summary>
+    void link_duplicate_files(const std::string& pattern, const std::vector<DUPLICATE_FRAME>& duplicates);
+}
+
+#endif
@@ -0,0 +1,231 @@
+#include "imaging/frame-export.h"
+#include "imaging/frame-deduplication.h"
+#include "util/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+
+using namespace imaging;
+
+namespace
+{
+    // Frames per work item: large enough that the shared counter is rarely touched,
+    // small enough that workers finish at about the same time
+    const size_t FRAMES_PER_RANGE = 8;
+
+    // Scrolling exports redraw the whole viewport at the start of every range, so they use longer ranges.
+    // Not too long either, as consumers that need frames in order have to buffer frames finished ahead of time
+    const size_t SCROLLING_FRAMES_PER_RANGE = 32;
+
+    const size_t PROGRESS_REPORTS = 100;
+
+    class ProgressCounter final
+    {
+    public:
+        ProgressCounter(size_t total, ProgressReporter reporter)
+            : m_total(total), m_interval(std::max<size_t>(1, total / PROGRESS_REPORTS)), m_done(0), m_reported(0), m_reporter(reporter) { }
+
+        void add(size_t frames)
+        {
+            size_t before = m_done.fetch_add(frames);
+            size_t after = before + frames;
+
+            // Only report when a multiple of the interval (or the end) has been crossed
+            if (m_reporter && (before / m_interval != after / m_interval || after == m_total))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                if (after > m_reported)
+                {
+                    m_reported = after;
+                    m_reporter(after, m_total);
+                }
+            }
+        }
+
+    private:
+        size_t m_total;
+        size_t m_interval;
+        std::atomic<size_t> m_done;
+        size_t m_reported;
+        std::mutex m_mutex;
+        ProgressReporter m_reporter;
+    };
+
+    // Calls process(worker, frame) for every frame, handing out ranges of frames to the workers
+    void for_each_frame(size_t frames, size_t frames_per_range, unsigned workers, ProgressReporter progress, std::function<void(unsigned, size_t)> process)
+    {
+        size_t ranges = (frames + frames_per_range - 1) / frames_per_range;
+        ProgressCounter counter(frames, progress);
+
+        parallel_for_worker(ranges, workers, [&](unsigned worker, size_t range) {
+            size_t first = range * frames_per_range;
+            size_t last = std::min(frames, first + frames_per_range);
+
+            for (size_t frame = first; frame != last; ++frame)
+            {
+                process(worker, frame);
+            }
+
+            counter.add(last - first);
+        });
+    }
+
+    std::vector<FrameEncoder> create_encoders(const FrameEncoding& encoding, unsigned workers)
+    {
+        std::vector<FrameEncoder> encoders;
+
+        for (unsigned i = 0; i != workers; ++i)
+        {
+            encoders.push_back(encoding.create());
+        }
+
+        return encoders;
+    }
+
+    // Encodes the frame and passes it on, unless it is a duplicate
+    void emit(size_t frame, const FramebufferView<const RGBA8>& view, unsigned rotation, FrameEncoder& encoder, const FrameSink& sink, FrameDeduplicator* deduplicator)
+    {
+        if (deduplicator == nullptr || !deduplicator->add(frame, view, rotation))
+        {
+            sink(frame, encoder(view, rotation));
+        }
+    }
+
+    // A worker per range of frames_per_range frames at most, so none is left without work
+    unsigned worker_count(size_t frames, size_t frames_per_range, unsigned threads)
+    {
+        return effective_thread_count((frames + frames_per_range - 1) / frames_per_range, threads);
+    }
+}
+
+imaging::FrameEncoding::FrameEncoding(BmpFormat format)
+    : m_factory([format]() {
+        auto encoder = std::make_shared<BmpEncoder>(format);
+
+        return [encoder](const FramebufferView<const RGBA8>& frame, unsigned rotation) -> const std::vector<uint8_t>& {
+            return encoder->encode(frame, rotation);
+        };
+    })
+{
+    // NOP
+}
+
+imaging::FrameEncoding::FrameEncoding(std::function<FrameEncoder()> factory)
+    : m_factory(factory)
+{
+    // NOP
+}
+
+size_t imaging::frames_in_flight(unsigned threads)
+{
+    return size_t(effective_thread_count(SIZE_MAX, threads)) * std::max(FRAMES_PER_RANGE, SCROLLING_FRAMES_PER_RANGE);
+}
+
+size_t imaging::frame_count(uint64_t width, unsigned frame_width, unsigned step)
+{
+    if (frame_width > width || step == 0)
+    {
+        return 0;
+    }
+
+    return size_t((width - frame_width) / step + 1);
+}
+
+std::string imaging::frame_path(const std::string& pattern, size_t frame)
+{
+    std::stringstream frame_nr;
+    frame_nr << std::setfill('0') << std::setw(5) << frame;
+
+    std::string result = pattern;
+    size_t position = result.find("%d");
+
+    if (position != std::string::npos)
+    {
+        result.replace(position, 2, frame_nr.str());
+    }
+
+    return result;
+}
+
+void imaging::export_frames(const FramebufferView<const RGBA8>& song, unsigned frame_width, unsigned step, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress, FrameDeduplicator* deduplicator)
+{
+    size_t frames = frame_count(song.width(), frame_width, step);
+    unsigned workers = worker_count(frames, FRAMES_PER_RANGE, threads);
+    std::vector<FrameEncoder> encoders = create_encoders(encoding, workers);
+
+    for_each_frame(frames, FRAMES_PER_RANGE, workers, progress, [&](unsigned worker, size_t frame) {
+        FramebufferView<const RGBA8> view = song.sub_view(unsigned(frame * step), 0, frame_width, song.height());
+
+        emit(frame, view, 0, encoders[worker], sink, deduplicator);
+    });
+}
+
+void imaging::export_frames(const FramebufferView<const uint8_t>& song, const Palette& palette, unsigned frame_width, unsigned step, BmpFormat format, unsigned threads, FrameSink sink, ProgressReporter progress, FrameDeduplicator* deduplicator)
+{
+    size_t frames = frame_count(song.width(), frame_width, step);
+    unsigned workers = worker_count(frames, FRAMES_PER_RANGE, threads);
+    std::vector<BmpEncoder> encoders(workers, BmpEncoder(format));
+
+    for_each_frame(frames, FRAMES_PER_RANGE, workers, progress, [&](unsigned worker, size_t frame) {
+        FramebufferView<const uint8_t> view = song.sub_view(unsigned(frame * step), 0, frame_width, song.height());
+
+        if (deduplicator == nullptr || !deduplicator->add(frame, view))
+        {
+            sink(frame, encoders[worker].encode(view, palette));
+        }
+    });
+}
+
+void imaging::export_frames(size_t frames, unsigned frame_width, unsigned frame_height, FrameRenderer render, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress, FrameDeduplicator* deduplicator)
+{
+    unsigned workers = worker_count(frames, FRAMES_PER_RANGE, threads);
+    std::vector<FrameEncoder> encoders = create_encoders(encoding, workers);
+    std::vector<std::unique_ptr<Framebuffer<RGBA8>>> framebuffers;
+
+    for (unsigned i = 0; i != workers; ++i)
+    {
+        framebuffers.push_back(std::make_unique<Framebuffer<RGBA8>>(frame_width, frame_height));
+    }
+
+    for_each_frame(frames, FRAMES_PER_RANGE, workers, progress, [&](unsigned worker, size_t frame) {
+        FramebufferView<RGBA8> view = framebuffers[worker]->view();
+
+        render(frame, view);
+        emit(frame, view, 0, encoders[worker], sink, deduplicator);
+    });
+}
+
+void imaging::export_scrolling_frames(unsigned width, unsigned frame_width, unsigned frame_height, unsigned step, ScrollingFramebuffer<RGBA8>::StripRenderer render, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress, FrameDeduplicator* deduplicator)
+{
+    size_t frames = frame_count(width, frame_width, step);
+    unsigned workers = worker_count(frames, SCROLLING_FRAMES_PER_RANGE, threads);
+    std::vector<FrameEncoder> encoders = create_encoders(encoding, workers);
+    std::vector<std::unique_ptr<ScrollingFramebuffer<RGBA8>>> viewports;
+
+    for (unsigned i = 0; i != workers; ++i)
+    {
+        viewports.push_back(std::make_unique<ScrollingFramebuffer<RGBA8>>(frame_width, frame_height, render));
+    }
+
+    for_each_frame(frames, SCROLLING_FRAMES_PER_RANGE, workers, progress, [&](unsigned worker, size_t frame) {
+        ScrollingFramebuffer<RGBA8>& viewport = *viewports[worker];
+
+        viewport.scroll_to(int64_t(frame * step));
+        emit(frame, viewport.ring(), viewport.rotation(), encoders[worker], sink, deduplicator);
+    });
+}
+
+FrameSink imaging::write_to_files(const std::string& pattern)
+{
+    return [pattern](size_t frame, const std::vector<uint8_t>& file) {
+        std::ofstream out(frame_path(pattern, frame), std::ios::binary);
+
+        out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    };
+}
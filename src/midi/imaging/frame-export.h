@@ -0,0 +1,117 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+#include "imaging/bmp-format.h"
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "imaging/scrolling-framebuffer.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace imaging
+{
+    class FrameDeduplicator;
+
+    /// <summary>
+    /// Number of frames export_frames produces for a bitmap of the given <paramref name="width" />:
+    /// frame i covers columns [i * step, i * step + frame_width), and the last frame must fit entirely.
+    /// </summary>
+    size_t frame_count(uint64_t width, unsigned frame_width, unsigned step);
+
+    /// <summary>
+    /// Replaces "%d" in <paramref name="pattern" /> with the frame number, padded to 5 digits.
+    /// </summary>
+    std::string frame_path(const std::string& pattern, size_t frame);
+
+    /// <summary>
+    /// Receives an encoded frame. Called concurrently from several workers, each time with a different frame,
+    /// so it must not touch shared state without synchronisation. The buffer is only valid during the call.
+    /// </summary>
+    typedef std::function<void(size_t frame, const std::vector<uint8_t>& file)> FrameSink;
+
+    /// <summary>
+    /// Turns a frame into bytes, e.g. a BMP file. Rows of <paramref name="frame" /> are rotated left by
+    /// <paramref name="rotation" /> pixels (see ScrollingFramebuffer). The returned buffer belongs to the encoder
+    /// and stays valid until its next call.
+    /// </summary>
+    typedef std::function<const std::vector<uint8_t>&(const FramebufferView<const RGBA8>& frame, unsigned rotation)> FrameEncoder;
+
+    /// <summary>
+    /// How frames are encoded: creates one FrameEncoder for every worker, so encoders can keep their buffers.
+    /// Converts from BmpFormat for BMP files.
+    /// </summary>
+    class FrameEncoding final
+    {
+    public:
+        FrameEncoding(BmpFormat format);
+        FrameEncoding(std::function<FrameEncoder()> factory);
+
+        FrameEncoder create() const
+        {
+            return m_factory();
+        }
+
+    private:
+        std::function<FrameEncoder()> m_factory;
+    };
+
+    /// <summary>
+    /// Receives the number of frames finished so far and the total. Calls are serialized and
+    /// the count never decreases between calls.
+    /// </summary>
+    typedef std::function<void(size_t done, size_t total)> ProgressReporter;
+
+    /// <summary>
+    /// Encodes all frames (see frame_count) of <paramref name="song" /> as BMP files and passes them to
+    /// <paramref name="sink" />. Frames are handed out in small ranges to <paramref name="threads" /> workers
+    /// (0 = one per core), each with its own BmpEncoder. Progress is counted with an atomic and reported
+    /// about a hundred times in total rather than once per frame; <paramref name="progress" /> may be empty.
+    /// With a <paramref name="deduplicator" />, frames it recognizes as duplicates are neither encoded nor passed to the sink.
+    /// </summary>
+    void export_frames(const FramebufferView<const RGBA8>& song, unsigned frame_width, unsigned step, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress = ProgressReporter(), FrameDeduplicator* deduplicator = nullptr);
+
+    /// <summary>
+    /// Like the overload above, for a song drawn as palette indices (e.g. instrument_index values).
+    /// Colours are looked up in <paramref name="palette" /> while frames are encoded; with BmpFormat::INDEXED8
+    /// frames are written as 8-bit BMP files with the palette instead.
+    /// </summary>
+    void export_frames(const FramebufferView<const uint8_t>& song, const Palette& palette, unsigned frame_width, unsigned step, BmpFormat format, unsigned threads, FrameSink sink, ProgressReporter progress = ProgressReporter(), FrameDeduplicator* deduplicator = nullptr);
+
+    /// <summary>
+    /// Draws frame <paramref name="frame" /> into <paramref name="target" />, overwriting every pixel.
+    /// Called concurrently from several workers, each with its own target.
+    /// </summary>
+    typedef std::function<void(size_t frame, const FramebufferView<RGBA8>& target)> FrameRenderer;
+
+    /// <summary>
+    /// Like the overload above, but instead of cutting frames out of a finished song bitmap, each frame is drawn
+    /// by <paramref name="render" /> into a frame_width x frame_height framebuffer owned by the worker.
+    /// Memory use does not depend on the length of the song.
+    /// </summary>
+    void export_frames(size_t frames, unsigned frame_width, unsigned frame_height, FrameRenderer render, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress = ProgressReporter(), FrameDeduplicator* deduplicator = nullptr);
+
+    /// <summary>
+    /// Exports the same frames as export_frames with a song bitmap <paramref name="width" /> pixels wide, but
+    /// only draws what is needed: every worker keeps a ScrollingFramebuffer and moves it <paramref name="step" />
+    /// pixels per frame, so <paramref name="render" /> is asked for a strip of step columns per frame.
+    /// Workers get ranges of consecutive frames, as the viewport is redrawn completely at the start of each range.
+    /// </summary>
+    void export_scrolling_frames(unsigned width, unsigned frame_width, unsigned frame_height, unsigned step, ScrollingFramebuffer<RGBA8>::StripRenderer render, const FrameEncoding& encoding, unsigned threads, FrameSink sink, ProgressReporter progress = ProgressReporter(), FrameDeduplicator* deduplicator = nullptr);
+
+    /// <summary>
+    /// Number of frames an export with <paramref name="threads" /> workers can have finished ahead of the oldest
+    /// unfinished frame. A consumer that needs frames in order (see OrderedFrameWriter) must be able to hold this
+    /// many frames to keep all workers busy.
+    /// </summary>
+    size_t frames_in_flight(unsigned threads);
+
+    /// <summary>
+    /// Sink that writes each frame to frame_path(<paramref name="pattern" />, frame).
+    /// </summary>
+    FrameSink write_to_files(const std::string& pattern);
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "util/position.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Non-owning view of a rectangle of pixels stored row by row.
+    /// The first pixels of consecutive rows are stride() pixels apart, so a view
+    /// can cover part of a larger framebuffer. Use FramebufferView&lt;const PIXEL&gt; for read-only access.
+    /// </summary>
+    template<typename PIXEL>
+    class FramebufferView final
+    {
+    public:
+        FramebufferView()
+            : FramebufferView(nullptr, 0, 0, 0) { }
+
+        FramebufferView(PIXEL* pixels, unsigned width, unsigned height, size_t stride)
+            : m_pixels(pixels), m_width(width), m_height(height), m_stride(stride)
+        {
+            assert(stride >= width);
+        }
+
+        /// <summary>
+        /// A view on mutable pixels converts to a read-only view.
+        /// </summary>
+        template<typename OTHER, typename std::enable_if<std::is_same<const OTHER, PIXEL>::value, int>::type = 0>
+        FramebufferView(const FramebufferView<OTHER>& view)
+            : FramebufferView(view.data(), view.width(), view.height(), view.stride()) { }
+
+        unsigned width() const
+        {
+            return m_width;
+        }
+
+        unsigned height() const
+        {
+            return m_height;
+        }
+
+        /// <summary>
+        /// Distance between the first pixels of two consecutive rows, in pixels.
+        /// </summary>
+        size_t stride() const
+        {
+            return m_stride;
+        }
+
+        /// <summary>
+        /// True if the rows follow each other without gaps, i.e. the whole view is one block of memory.
+        /// </summary>
+        bool is_contiguous() const
+        {
+            return m_stride == m_width || m_height <= 1;
+        }
+
+        PIXEL* data() const
+        {
+            return m_pixels;
+        }
+
+        PIXEL* row(unsigned y) const
+        {
+            assert(y < m_height);
+
+            return m_pixels + y * m_stride;
+        }
+
+        bool is_inside(const Position& p) const
+        {
+            return p.x < m_width && p.y < m_height;
+        }
+
+        PIXEL& operator [](const Position& p) const
+        {
+            assert(is_inside(p));
+
+            return row(p.y)[p.x];
+        }
+
+        /// <summary>
+        /// Returns a view on the given rectangle, which must lie inside this view. No pixels are copied.
+        /// </summary>
+        FramebufferView sub_view(unsigned x, unsigned y, unsigned width, unsigned height) const
+        {
+            assert(x + width <= m_width && y + height <= m_height);
+
+            return FramebufferView(m_pixels + y * m_stride + x, width, height, m_stride);
+        }
+
+        /// <summary>
+        /// Calls <paramref name="function" />(y, row) for every row, top to bottom.
+        /// row points to width() consecutive pixels.
+        /// </summary>
+        template<typename FUNCTION>
+        void for_each_row(FUNCTION function) const
+        {
+            for (unsigned y = 0; y != m_height; ++y)
+            {
+                function(y, m_pixels + y * m_stride);
+            }
+        }
+
+        /// <summary>
+        /// Calls <paramref name="function" />(pixel) for every pixel, row by row.
+        /// </summary>
+        template<typename FUNCTION>
+        void for_each_pixel(FUNCTION function) const
+        {
+            unsigned width = m_width;
+
+            for_each_row([width, &function](unsigned, PIXEL* row) {
+                for (unsigned x = 0; x != width; ++x)
+                {
+                    function(row[x]);
+                }
+            });
+        }
+
+        /// <summary>
+        /// Overwrites every pixel of the view with <paramref name="pixel" />.
+        /// </summary>
+        void fill(const PIXEL& pixel) const
+        {
+            if (is_contiguous())
+            {
+                std::fill_n(m_pixels, size_t(m_width) * m_height, pixel);
+            }
+            else
+            {
+                unsigned width = m_width;
+
+                for_each_row([width, &pixel](unsigned, PIXEL* row) { std::fill_n(row, width, pixel); });
+            }
+        }
+
+        /// <summary>
+        /// Copies the pixels of <paramref name="source" />, which must have the same size as this view.
+        /// Each row is a single memmove for trivially copyable pixel types.
+        /// </summary>
+        void copy_from(const FramebufferView<const typename std::remove_const<PIXEL>::type>& source) const
+        {
+            assert(source.width() == m_width && source.height() == m_height);
+
+            if (is_contiguous() && source.is_contiguous())
+            {
+                std::copy_n(source.data(), size_t(m_width) * m_height, m_pixels);
+            }
+            else
+            {
+                unsigned width = m_width;
+
+                for_each_row([width, &source](unsigned y, PIXEL* row) { std::copy_n(source.row(y), width, row); });
+            }
+        }
+
+    private:
+        PIXEL* m_pixels;
+        unsigned m_width;
+        unsigned m_height;
+        size_t m_stride;
+    };
+
+    /// <summary>
+    /// Owns a width x height block of pixels, stored row by row without gaps.
+    /// </summary>
+    template<typename PIXEL>
+    class Framebuffer final
+    {
+    public:
+        Framebuffer(unsigned width, unsigned height, const PIXEL& initial_value = PIXEL())
+            : m_pixels(std::make_unique<PIXEL[]>(size_t(width) * height)), m_width(width), m_height(height)
+        {
+            view().fill(initial_value);
+        }
+
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator =(const Framebuffer&) = delete;
+
+        unsigned width() const
+        {
+            return m_width;
+        }
+
+        unsigned height() const
+        {
+            return m_height;
+        }
+
+        FramebufferView<PIXEL> view()
+        {
+            return FramebufferView<PIXEL>(m_pixels.get(), m_width, m_height, m_width);
+        }
+
+        FramebufferView<const PIXEL> view() const
+        {
+            return FramebufferView<const PIXEL>(m_pixels.get(), m_width, m_height, m_width);
+        }
+
+    private:
+        std::unique_ptr<PIXEL[]> m_pixels;
+        unsigned m_width;
+        unsigned m_height;
+    };
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "imaging/piano-roll.h"
+#include "imaging/color.h"
+#include "imaging/drawing.h"
+
+
+using namespace imaging;
+
+RGBA8 imaging::instrument_color(midi::Instrument instrument)
+{
+    unsigned i = value(instrument);
+
+    return from_color<RGBA8>(Color((i % 7) / 7.0, (i % 17) / 17.0, (i % 37) / 37.0));
+}
+
+Palette imaging::instrument_palette()
+{
+    Palette palette;
+
+    palette[0] = RGBA8();
+    for (unsigned i = 1; i != palette.size(); ++i)
+    {
+        palette[i] = instrument_color(midi::Instrument(uint8_t(i - 1)));
+    }
+
+    return palette;
+}
+
+imaging::PianoRoll::PianoRoll(const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height)
+    : m_note_height(note_height)
+{
+    // Same rounding as the app has always used: positions and sizes are truncated separately
+    double factor = scale / 100.0;
+    uint64_t end = 0;
+    std::vector<INTERVAL> intervals;
+
+    // Notes on different pitches never overlap, and on the same pitch later notes win,
+    // so drawing in the original order gives the same image as drawing pitch by pitch
+    for (const midi::NOTE& note : notes)
+    {
+        NOTE_RECTANGLE rectangle;
+        rectangle.x = int64_t(uint32_t(value(note.start) * factor));
+        rectangle.y = int64_t(127 - value(note.note_number)) * note_height;
+        rectangle.width = uint32_t(value(note.duration) * factor);
+        rectangle.height = note_height;
+        rectangle.color = instrument_color(note.instrument);
+
+        m_rectangles.push_back(rectangle);
+        intervals.push_back(INTERVAL{ rectangle.x, rectangle.x + rectangle.width });
+        end = std::max(end, value(note.start + note.duration));
+    }
+
+    m_width = uint32_t(end * factor);
+    m_index = IntervalIndex(intervals);
+}
+
+void imaging::PianoRoll::render(const FramebufferView<RGBA8>& target, int64_t x, int64_t y) const
+{
+    target.fill(RGBA8());
+    draw_notes(target, x, y);
+}
+
+void imaging::PianoRoll::draw_notes(const FramebufferView<RGBA8>& target, int64_t x, int64_t y) const
+{
+    std::vector<size_t> visible;
+
+    m_index.find_overlapping(x, x + target.width(), &visible);
+
+    for (size_t i : visible)
+    {
+        const NOTE_RECTANGLE& rectangle = m_rectangles[i];
+
+        fill_rect(target, rectangle.x - x, rectangle.y - y, rectangle.width, rectangle.height, rectangle.color);
+    }
+}
+
+void imaging::PianoRoll::draw_lanes(const FramebufferView<RGBA8>& target, int64_t y) const
+{
+    const RGBA8 black_key(32, 32, 32);
+
+    target.fill(RGBA8());
+
+    for (unsigned pitch = 0; pitch != 128; ++pitch)
+    {
+        switch (pitch % 12)
+        {
+        case 1: case 3: case 6: case 8: case 10:
+            fill_rect(target, 0, int64_t(127 - pitch) * m_note_height - y, target.width(), m_note_height, black_key);
+            break;
+        }
+    }
+}
+
+namespace
+{
+    template<typename PIXEL>
+    struct ROW_SPAN
+    {
+        int64_t left;
+        int64_t right;
+        PIXEL color;
+    };
+
+    template<typename PIXEL, typename COLOR>
+    void draw_rows(const FramebufferView<PIXEL>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, int64_t y, COLOR color)
+    {
+        double factor = scale / 100.0;
+        int64_t width = target.width();
+        PIXEL colors[256];
+
+        for (unsigned i = 0; i != 256; ++i)
+        {
+            colors[i] = color(midi::Instrument(uint8_t(i)));
+        }
+
+        // Counting sort by lane, stable so that later notes are still drawn over earlier ones
+        std::vector<size_t> first(129, 0);
+        for (const midi::NOTE& note : notes)
+        {
+            ++first[127 - (value(note.note_number) & 127) + 1];
+        }
+        for (unsigned lane = 0; lane != 128; ++lane)
+        {
+            first[lane + 1] += first[lane];
+        }
+
+        std::vector<ROW_SPAN<PIXEL>> spans(notes.size());
+        std::vector<size_t> next(first.begin(), first.end() - 1);
+        for (const midi::NOTE& note : notes)
+        {
+            // Same rounding as the app has always used: positions and sizes are truncated separately
+            int64_t left = int64_t(uint32_t(value(note.start) * factor));
+            int64_t right = left + uint32_t(value(note.duration) * factor);
+
+            spans[next[127 - (value(note.note_number) & 127)]++] = ROW_SPAN<PIXEL>{ std::max(left, int64_t(0)), std::min(right, width), colors[value(note.instrument)] };
+        }
+
+        for (unsigned lane = 0; lane != 128; ++lane)
+        {
+            int64_t top = std::max(int64_t(lane) * note_height - y, int64_t(0));
+            int64_t bottom = std::min(int64_t(lane + 1) * note_height - y, int64_t(target.height()));
+
+            for (int64_t row_y = top; row_y < bottom; ++row_y)
+            {
+                PIXEL* row = target.row(unsigned(row_y));
+
+                for (size_t i = first[lane]; i != first[lane + 1]; ++i)
+                {
+                    if (spans[i].left < spans[i].right)
+                    {
+                        std::fill(row + spans[i].left, row + spans[i].right, spans[i].color);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void imaging::draw_note_rows(const FramebufferView<RGBA8>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, int64_t y)
+{
+    draw_rows(target, notes, scale, note_height, y, [](midi::Instrument instrument) { return instrument_color(instrument); });
+}
+
+void imaging::draw_note_rows(const FramebufferView<uint8_t>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, int64_t y)
+{
+    draw_rows(target, notes, scale, note_height, y, [](midi::Instrument instrument) { return instrument_index(instrument); });
+}
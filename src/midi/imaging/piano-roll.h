@@ -0,0 +1,115 @@
+#ifndef PIANO_ROLL_H
+#define PIANO_ROLL_H
+
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "midi/midi.h"
+#include "util/interval-index.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Colour the app has always used for notes played by <paramref name="instrument" />.
+    /// </summary>
+    RGBA8 instrument_color(midi::Instrument instrument);
+
+    /// <summary>
+    /// Palette index of the notes of <paramref name="instrument" /> in instrument_palette(). Index 0 is the background.
+    /// </summary>
+    inline uint8_t instrument_index(midi::Instrument instrument)
+    {
+        return uint8_t(std::min(unsigned(value(instrument)), 254u) + 1);
+    }
+
+    /// <summary>
+    /// Black background followed by instrument_color of every instrument, for rasters of instrument_index values.
+    /// </summary>
+    Palette instrument_palette();
+
+    /// <summary>
+    /// A note as it appears on the piano roll.
+    /// </summary>
+    struct NOTE_RECTANGLE final
+    {
+        int64_t x;
+        int64_t y;
+        uint32_t width;
+        uint32_t height;
+        RGBA8 color;
+    };
+
+    /// <summary>
+    /// Piano roll of a song, rendered on demand. Time runs left to right, scaled by
+    /// <paramref name="scale" /> percent; pitch 127 is the top row and every pitch is
+    /// <paramref name="note_height" /> pixels tall, so the whole roll is width() x 128 * note_height.
+    /// Only the note rectangles and an interval index over their horizontal extent are kept,
+    /// so rendering a window costs memory proportional to the window, not to the song.
+    /// </summary>
+    class PianoRoll final
+    {
+    public:
+        PianoRoll(const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height);
+
+        unsigned width() const
+        {
+            return m_width;
+        }
+
+        unsigned height() const
+        {
+            return 128 * m_note_height;
+        }
+
+        /// <summary>
+        /// Rectangles in drawing order: where notes overlap, later ones are drawn on top.
+        /// </summary>
+        const std::vector<NOTE_RECTANGLE>& rectangles() const
+        {
+            return m_rectangles;
+        }
+
+        /// <summary>
+        /// Renders the window of the roll whose top left corner is (<paramref name="x" />, <paramref name="y" />)
+        /// and whose size is that of <paramref name="target" />. Parts of the window outside the roll stay black.
+        /// </summary>
+        void render(const FramebufferView<RGBA8>& target, int64_t x, int64_t y) const;
+
+        /// <summary>
+        /// Like render, but draws the notes on top of what target already contains.
+        /// </summary>
+        void draw_notes(const FramebufferView<RGBA8>& target, int64_t x, int64_t y) const;
+
+        /// <summary>
+        /// Draws pitch lanes, the part of the roll that does not depend on time, for the rows starting at
+        /// <paramref name="y" />: lanes of black keys are dark grey, other rows black.
+        /// Meant to be rendered once into a RepeatingBackground.
+        /// </summary>
+        void draw_lanes(const FramebufferView<RGBA8>& target, int64_t y) const;
+
+    private:
+        std::vector<NOTE_RECTANGLE> m_rectangles;
+        IntervalIndex m_index;
+        unsigned m_width;
+        unsigned m_note_height;
+    };
+
+    /// <summary>
+    /// Draws all <paramref name="notes" /> on top of <paramref name="target" />, which shows the rows of the roll
+    /// starting at <paramref name="y" />, with the same positions and rounding as PianoRoll.
+    /// Notes are put in buckets by pitch in one pass, keeping their order, so every lane gets a list of spans of
+    /// one pixel row that is then filled row by row. This costs time linear in the number of notes and the pixels
+    /// they cover, instead of scanning all notes for each of the 128 pitches.
+    /// </summary>
+    void draw_note_rows(const FramebufferView<RGBA8>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, int64_t y);
+
+    /// <summary>
+    /// Same, writing the instrument_index of each note instead of its colour.
+    /// </summary>
+    void draw_note_rows(const FramebufferView<uint8_t>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, int64_t y);
+}
+
+#endif
@@ -0,0 +1,34 @@
+#include "imaging/pixel-format.h"
+
+using namespace imaging;
+
+
+bool imaging::operator ==(const RGBA8& p1, const RGBA8& p2)
+{
+    return p1.r == p2.r && p1.g == p2.g && p1.b == p2.b && p1.a == p2.a;
+}
+
+bool imaging::operator !=(const RGBA8& p1, const RGBA8& p2)
+{
+    return !(p1 == p2);
+}
+
+bool imaging::operator ==(const RGBF32& p1, const RGBF32& p2)
+{
+    return p1.r == p2.r && p1.g == p2.g && p1.b == p2.b;
+}
+
+bool imaging::operator !=(const RGBF32& p1, const RGBF32& p2)
+{
+    return !(p1 == p2);
+}
+
+std::ostream& imaging::operator <<(std::ostream& out, const RGBA8& p)
+{
+    return out << "RGBA8[" << int(p.r) << "," << int(p.g) << "," << int(p.b) << "," << int(p.a) << "]";
+}
+
+std::ostream& imaging::operator <<(std::ostream& out, const RGBF32& p)
+{
+    return out << "RGBF32[" << p.r << "," << p.g << "," << p.b << "]";
+}
@@ -0,0 +1,119 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include "imaging/color.h"
+#include <array>
+#include <cstdint>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// 8 bits per channel, 4 bytes per pixel.
+    /// Channels are stored in the order used by 32-bit BMP files (blue, green, red, alpha),
+    /// so rows of RGBA8 pixels can be written to a BMP file without conversion.
+    /// </summary>
+    struct RGBA8 final
+    {
+        uint8_t b;
+        uint8_t g;
+        uint8_t r;
+        uint8_t a;
+
+        /// <summary>
+        /// Default constructor. Initializes the pixel to opaque black.
+        /// </summary>
+        constexpr RGBA8() : RGBA8(0, 0, 0) { }
+
+        constexpr RGBA8(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+            : b(b), g(g), r(r), a(a) { }
+    };
+
+    /// <summary>
+    /// One 32-bit float per channel, 12 bytes per pixel.
+    /// For intermediate results that need more precision than RGBA8.
+    /// </summary>
+    struct RGBF32 final
+    {
+        float r;
+        float g;
+        float b;
+
+        /// <summary>
+        /// Default constructor. Initializes the pixel to black.
+        /// </summary>
+        constexpr RGBF32() : RGBF32(0, 0, 0) { }
+
+        constexpr RGBF32(float r, float g, float b)
+            : r(r), g(g), b(b) { }
+    };
+
+    /// <summary>
+    /// Colours for 8-bit pixels that hold an index rather than a colour, such as 8-bit BMP files have.
+    /// </summary>
+    typedef std::array<RGBA8, 256> Palette;
+
+    bool operator ==(const RGBA8&, const RGBA8&);
+    bool operator !=(const RGBA8&, const RGBA8&);
+    bool operator ==(const RGBF32&, const RGBF32&);
+    bool operator !=(const RGBF32&, const RGBF32&);
+
+    std::ostream& operator <<(std::ostream&, const RGBA8&);
+    std::ostream& operator <<(std::ostream&, const RGBF32&);
+
+    // Conversions between pixel formats. Color (three doubles) counts as a pixel format as well.
+    // Channels are truncated when converting to 8 bits, as save_as_bmp has always done.
+
+    template<typename PIXEL>
+    PIXEL from_color(const Color& color);
+
+    template<>
+    inline Color from_color<Color>(const Color& color)
+    {
+        return color;
+    }
+
+    template<>
+    inline RGBA8 from_color<RGBA8>(const Color& color)
+    {
+        return RGBA8(uint8_t(color.r * 255), uint8_t(color.g * 255), uint8_t(color.b * 255));
+    }
+
+    template<>
+    inline RGBF32 from_color<RGBF32>(const Color& color)
+    {
+        return RGBF32(float(color.r), float(color.g), float(color.b));
+    }
+
+    inline Color to_color(const Color& color)
+    {
+        return color;
+    }
+
+    inline Color to_color(const RGBA8& pixel)
+    {
+        return Color(pixel.r / 255.0, pixel.g / 255.0, pixel.b / 255.0);
+    }
+
+    inline Color to_color(const RGBF32& pixel)
+    {
+        return Color(pixel.r, pixel.g, pixel.b);
+    }
+
+    inline RGBA8 to_rgba8(const RGBA8& pixel)
+    {
+        return pixel;
+    }
+
+    inline RGBA8 to_rgba8(const Color& color)
+    {
+        return from_color<RGBA8>(color);
+    }
+
+    inline RGBA8 to_rgba8(const RGBF32& pixel)
+    {
+        return RGBA8(uint8_t(pixel.r * 255), uint8_t(pixel.g * 255), uint8_t(pixel.b * 255));
+    }
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "imaging/roll-image.h"
+#include "imaging/piano-roll.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+
+using namespace imaging;
+
+namespace
+{
+    typedef std::map<uint64_t, NOTE_SPAN> SpanMap;
+
+    // Paints [start, end) over the spans in the map, cutting away whatever it covers
+    void paint(SpanMap& spans, uint64_t start, uint64_t end, uint8_t color)
+    {
+        auto it = spans.lower_bound(start);
+
+        // A span starting before start may stick out on either side
+        if (it != spans.begin())
+        {
+            NOTE_SPAN& previous = std::prev(it)->second;
+
+            if (previous.end > start)
+            {
+                if (previous.end > end)
+                {
+                    NOTE_SPAN tail = previous;
+                    tail.start = end;
+                    spans.emplace(end, tail);
+                }
+                previous.end = start;
+            }
+        }
+
+        while (it != spans.end() && it->first < end)
+        {
+            if (it->second.end > end)
+            {
+                NOTE_SPAN tail = it->second;
+                tail.start = end;
+                spans.erase(it);
+                spans.emplace(end, tail);
+                break;
+            }
+
+            it = spans.erase(it);
+        }
+
+        spans[start] = NOTE_SPAN{ start, end, color };
+    }
+
+    int64_t column(uint64_t tick, unsigned scale)
+    {
+        return int64_t(tick * scale / 100);
+    }
+}
+
+imaging::RollImage::RollImage(const std::vector<midi::NOTE>& notes)
+    : m_length(0)
+{
+    SpanMap spans[128];
+
+    for (const midi::NOTE& note : notes)
+    {
+        uint64_t start = value(note.start);
+        uint64_t end = start + value(note.duration);
+
+        if (start < end)
+        {
+            paint(spans[value(note.note_number) & 127], start, end, instrument_index(note.instrument));
+            m_length = std::max(m_length, end);
+        }
+    }
+
+    for (unsigned pitch = 0; pitch != 128; ++pitch)
+    {
+        std::vector<NOTE_SPAN>& row = m_rows[pitch];
+
+        row.reserve(spans[pitch].size());
+        for (const auto& entry : spans[pitch])
+        {
+            // Neighbouring pieces of the same colour are drawn the same as one span
+            if (!row.empty() && row.back().end == entry.second.start && row.back().color == entry.second.color)
+            {
+                row.back().end = entry.second.end;
+            }
+            else
+            {
+                row.push_back(entry.second);
+            }
+        }
+        row.shrink_to_fit();
+    }
+}
+
+size_t imaging::RollImage::span_count() const
+{
+    size_t count = 0;
+
+    for (const std::vector<NOTE_SPAN>& row : m_rows)
+    {
+        count += row.size();
+    }
+
+    return count;
+}
+
+void imaging::RollImage::render(const FramebufferView<uint8_t>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height) const
+{
+    rasterise(target, x, y, scale, note_height, [](uint8_t index) { return index; });
+}
+
+void imaging::RollImage::render(const FramebufferView<RGBA8>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height, const Palette& palette) const
+{
+    rasterise(target, x, y, scale, note_height, [&palette](uint8_t index) { return palette[index]; });
+}
+
+template<typename PIXEL, typename LOOKUP>
+void imaging::RollImage::rasterise(const FramebufferView<PIXEL>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height, LOOKUP lookup) const
+{
+    const PIXEL background = lookup(0);
+    int64_t width = target.width();
+    int64_t height = target.height();
+
+    if (note_height == 0)
+    {
+        target.fill(background);
+        return;
+    }
+
+    // Rows above pitch 127 and below pitch 0
+    int64_t roll_top = std::min(std::max(-y, int64_t(0)), height);
+    int64_t roll_bottom = std::min(std::max(int64_t(128) * note_height - y, roll_top), height);
+    target.sub_view(0, 0, target.width(), unsigned(roll_top)).fill(background);
+    target.sub_view(0, unsigned(roll_bottom), target.width(), unsigned(height - roll_bottom)).fill(background);
+
+    for (int64_t top = roll_top; top < roll_bottom; )
+    {
+        int64_t lane = (top + y) / note_height;
+        int64_t bottom = std::min((lane + 1) * note_height - y, roll_bottom);
+        const std::vector<NOTE_SPAN>& spans = m_rows[127 - lane];
+        PIXEL* row = target.row(unsigned(top));
+
+        std::fill_n(row, width, background);
+
+        // Spans are disjoint and sorted, so their ends are sorted too
+        auto it = std::partition_point(spans.begin(), spans.end(), [scale, x](const NOTE_SPAN& span) { return column(span.end, scale) <= x; });
+
+        for (; it != spans.end() && column(it->start, scale) < x + width; ++it)
+        {
+            int64_t left = std::max(column(it->start, scale) - x, int64_t(0));
+            int64_t right = std::min(column(it->end, scale) - x, width);
+
+            std::fill(row + left, row + right, lookup(it->color));
+        }
+
+        // Every row of a lane is the same
+        for (int64_t copy = top + 1; copy < bottom; ++copy)
+        {
+            std::copy_n(row, width, target.row(unsigned(copy)));
+        }
+
+        top = bottom;
+    }
+}
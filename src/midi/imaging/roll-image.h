@@ -0,0 +1,89 @@
+#ifndef ROLL_IMAGE_H
+#define ROLL_IMAGE_H
+
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "midi/midi.h"
+#include <cstdint>
+#include <vector>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Part of a pitch row covered by one colour, from tick start up to (not including) tick end.
+    /// color is a palette index, as in instrument_palette().
+    /// </summary>
+    struct NOTE_SPAN final
+    {
+        uint64_t start;
+        uint64_t end;
+        uint8_t color;
+    };
+
+    /// <summary>
+    /// Piano roll stored as runs rather than pixels: for each of the 128 pitches a list of
+    /// disjoint spans sorted by time, in ticks. Memory grows with the number of notes only,
+    /// and any window can be rasterised at any scale and note height without going back to the notes.
+    /// Where notes on the same pitch overlap, later notes in the vector cover earlier ones,
+    /// as when they are drawn in order.
+    /// Tick t lands in pixel column t * scale / 100 (rounded down), so spans that touch stay touching at every scale.
+    /// Unlike PianoRoll, which truncates the position and length of each note separately,
+    /// the right edge of a span can therefore end up one pixel further.
+    /// </summary>
+    class RollImage final
+    {
+    public:
+        explicit RollImage(const std::vector<midi::NOTE>& notes);
+
+        /// <summary>
+        /// Spans of pitch <paramref name="pitch" />, sorted and without overlaps.
+        /// </summary>
+        const std::vector<NOTE_SPAN>& row(unsigned pitch) const
+        {
+            return m_rows[pitch];
+        }
+
+        /// <summary>
+        /// Total number of spans over all rows.
+        /// </summary>
+        size_t span_count() const;
+
+        /// <summary>
+        /// End of the last span, in ticks.
+        /// </summary>
+        uint64_t length() const
+        {
+            return m_length;
+        }
+
+        /// <summary>
+        /// Width in pixels of the whole roll at <paramref name="scale" /> percent.
+        /// </summary>
+        uint64_t width(unsigned scale) const
+        {
+            return m_length * scale / 100;
+        }
+
+        /// <summary>
+        /// Rasterises the window of the roll whose top left corner is (<paramref name="x" />, <paramref name="y" />)
+        /// and whose size is that of <paramref name="target" />, with time scaled by <paramref name="scale" /> percent
+        /// and <paramref name="note_height" /> rows per pitch, pitch 127 on top. Pixels not covered by a span are 0.
+        /// </summary>
+        void render(const FramebufferView<uint8_t>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height) const;
+
+        /// <summary>
+        /// Same, looking up the colour of every span in <paramref name="palette" />; uncovered pixels get palette[0].
+        /// </summary>
+        void render(const FramebufferView<RGBA8>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height, const Palette& palette) const;
+
+    private:
+        template<typename PIXEL, typename LOOKUP>
+        void rasterise(const FramebufferView<PIXEL>& target, int64_t x, int64_t y, unsigned scale, unsigned note_height, LOOKUP lookup) const;
+
+        std::vector<NOTE_SPAN> m_rows[128];
+        uint64_t m_length;
+    };
+}
+
+#endif
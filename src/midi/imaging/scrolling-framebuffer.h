@@ -0,0 +1,179 @@
+#ifndef SCROLLING_FRAMEBUFFER_H
+#define SCROLLING_FRAMEBUFFER_H
+
+#include "imaging/drawing.h"
+#include "imaging/framebuffer.h"
+#include "logging.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdint>
+#include <functional>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Viewport of width() x height() pixels sliding horizontally over a larger image, e.g. a song.
+    /// Columns are stored in a ring: after scrolling right by n pixels, only the n newly revealed
+    /// columns are drawn (over the n columns that fell off the left edge) and rotation() advances by n.
+    /// The viewport as seen on screen is ring() with each row rotated left by rotation();
+    /// BmpEncoder::encode takes this rotation into account, so frames are encoded without copying.
+    /// </summary>
+    template<typename PIXEL>
+    class ScrollingFramebuffer final
+    {
+    public:
+        /// <summary>
+        /// Draws columns [x, x + target.width()) of the image into <paramref name="target" />,
+        /// overwriting every pixel.
+        /// </summary>
+        typedef std::function<void(const FramebufferView<PIXEL>& target, int64_t x)> StripRenderer;
+
+        ScrollingFramebuffer(unsigned width, unsigned height, StripRenderer render)
+            : m_framebuffer(width, height), m_render(render), m_x(0), m_rotation(0), m_valid(false)
+        {
+            // NOP
+        }
+
+        unsigned width() const
+        {
+            return m_framebuffer.width();
+        }
+
+        unsigned height() const
+        {
+            return m_framebuffer.height();
+        }
+
+        /// <summary>
+        /// Position of the left edge of the viewport in the image.
+        /// </summary>
+        int64_t x() const
+        {
+            return m_x;
+        }
+
+        /// <summary>
+        /// Column of ring() holding the left edge of the viewport.
+        /// </summary>
+        unsigned rotation() const
+        {
+            return m_rotation;
+        }
+
+        FramebufferView<const PIXEL> ring() const
+        {
+            return m_framebuffer.view();
+        }
+
+        /// <summary>
+        /// Moves the left edge of the viewport to <paramref name="x" />.
+        /// Scrolling right by less than width() only draws the revealed columns;
+        /// the first call, scrolling left or jumping further redraws the whole viewport.
+        /// </summary>
+        void scroll_to(int64_t x)
+        {
+            if (m_valid && x >= m_x && x - m_x < width())
+            {
+                unsigned shift = unsigned(x - m_x);
+
+                // The columns that scrolled out on the left, [m_x, x), are reused for [m_x + width, x + width)
+                draw(m_rotation, shift, m_x + width());
+                m_rotation = (m_rotation + shift) % width();
+            }
+            else
+            {
+                draw(0, width(), x);
+                m_rotation = 0;
+                m_valid = true;
+            }
+
+            m_x = x;
+        }
+
+        /// <summary>
+        /// Copies the viewport, with rows in screen order, to <paramref name="target" />, which must have the same size.
+        /// </summary>
+        void copy_to(const FramebufferView<PIXEL>& target) const
+        {
+            assert(target.width() == width() && target.height() == height());
+
+            unsigned head = width() - m_rotation;
+
+            blit(target, 0, 0, ring().sub_view(m_rotation, 0, head, height()));
+            blit(target, head, 0, ring().sub_view(0, 0, m_rotation, height()));
+        }
+
+    private:
+        // Draws count columns starting at image column x into the ring, starting at ring column ring_x and wrapping around
+        void draw(unsigned ring_x, unsigned count, int64_t x)
+        {
+            unsigned first = std::min(count, width() - ring_x);
+
+            if (first != 0)
+            {
+                m_render(m_framebuffer.view().sub_view(ring_x, 0, first, height()), x);
+            }
+            if (first != count)
+            {
+                m_render(m_framebuffer.view().sub_view(0, 0, count - first, height()), x + first);
+            }
+        }
+
+        Framebuffer<PIXEL> m_framebuffer;
+        StripRenderer m_render;
+        int64_t m_x;
+        unsigned m_rotation;
+        bool m_valid;
+    };
+
+    /// <summary>
+    /// Background that is rendered once into a tile and repeats horizontally with the width of the tile,
+    /// e.g. pitch lanes or a grid. Drawing it is a matter of copying rows of the tile.
+    /// </summary>
+    template<typename PIXEL>
+    class RepeatingBackground final
+    {
+    public:
+        /// <summary>
+        /// Creates a tile of <paramref name="width" /> x <paramref name="height" /> pixels and lets
+        /// <paramref name="render" /> draw it. The width must not be 0.
+        /// </summary>
+        RepeatingBackground(unsigned width, unsigned height, std::function<void(const FramebufferView<PIXEL>&)> render)
+            : m_tile(width, height)
+        {
+            CHECK(width != 0) << "A repeating background needs a tile at least one pixel wide";
+
+            render(m_tile.view());
+        }
+
+        FramebufferView<const PIXEL> tile() const
+        {
+            return m_tile.view();
+        }
+
+        /// <summary>
+        /// Draws columns [x, x + target.width()) of the background into <paramref name="target" />.
+        /// Rows of target below the tile are left untouched.
+        /// </summary>
+        void draw(const FramebufferView<PIXEL>& target, int64_t x) const
+        {
+            unsigned tile_width = m_tile.width();
+            unsigned tile_x = unsigned(((x % tile_width) + tile_width) % tile_width);
+
+            for (unsigned done = 0; done < target.width(); )
+            {
+                unsigned count = std::min(target.width() - done, tile_width - tile_x);
+
+                blit(target, done, 0, tile().sub_view(tile_x, 0, count, m_tile.height()));
+                done += count;
+                tile_x = 0;
+            }
+        }
+
+    private:
+        Framebuffer<PIXEL> m_tile;
+    };
+}
+
+#endif
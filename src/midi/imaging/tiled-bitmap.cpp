@@ -0,0 +1,229 @@
+#include "imaging/tiled-bitmap.h"
+#include "imaging/drawing.h"
+#include "logging.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+
+using namespace imaging;
+
+namespace
+{
+    // Size of the band of rows write_bmp encodes at a time; at least one row
+    const size_t BMP_BAND_BYTES = 16 << 20;
+}
+
+const unsigned imaging::TiledBitmap::DEFAULT_TILE_SIZE;
+
+imaging::TiledBitmap::TiledBitmap(uint64_t width, uint64_t height, const std::string& path, size_t memory_budget, unsigned tile_size)
+    : m_width(width), m_height(height), m_tile_size(tile_size), m_tiles_across((width + tile_size - 1) / tile_size), m_file(path)
+{
+    CHECK(tile_size != 0) << "Tiles cannot be empty";
+
+    // Tiles are mapped one at a time, so each must start at a multiple of the granularity
+    size_t granularity = io::WritableMemoryMappedFile::granularity();
+    m_tile_bytes = (size_t(tile_size) * tile_size * sizeof(RGBA8) + granularity - 1) / granularity * granularity;
+    m_max_mapped = std::max<size_t>(1, memory_budget / m_tile_bytes);
+}
+
+imaging::TiledBitmap::~TiledBitmap()
+{
+    for (auto& entry : m_tiles)
+    {
+        unmap(entry.second);
+    }
+}
+
+size_t imaging::TiledBitmap::stored_tiles() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_tiles.size();
+}
+
+size_t imaging::TiledBitmap::mapped_tiles() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_lru.size();
+}
+
+void imaging::TiledBitmap::unmap(TILE& tile) const
+{
+    if (tile.pixels != nullptr)
+    {
+        m_file.unmap(reinterpret_cast<uint8_t*>(tile.pixels), m_tile_bytes);
+        m_lru.erase(tile.lru);
+        tile.pixels = nullptr;
+    }
+}
+
+RGBA8* imaging::TiledBitmap::tile_pixels(uint64_t key, bool create) const
+{
+    auto found = m_tiles.find(key);
+
+    if (found == m_tiles.end() && !create)
+    {
+        return nullptr;
+    }
+
+    if (found != m_tiles.end() && found->second.pixels != nullptr)
+    {
+        // Most recently used tiles are at the back
+        m_lru.splice(m_lru.end(), m_lru, found->second.lru);
+
+        return found->second.pixels;
+    }
+
+    while (m_lru.size() >= m_max_mapped)
+    {
+        unmap(m_tiles[m_lru.front()]);
+    }
+
+    bool is_new = found == m_tiles.end();
+
+    if (is_new)
+    {
+        TILE tile;
+        tile.offset = m_tiles.size() * uint64_t(m_tile_bytes);
+        tile.pixels = nullptr;
+
+        // Grow the file by doubling, so that it is resized a logarithmic number of times
+        if (tile.offset + m_tile_bytes > m_file.size())
+        {
+            m_file.resize(std::max(tile.offset + m_tile_bytes, 2 * m_file.size()));
+        }
+
+        found = m_tiles.emplace(key, tile).first;
+    }
+
+    TILE& tile = found->second;
+    tile.pixels = reinterpret_cast<RGBA8*>(m_file.map(tile.offset, m_tile_bytes));
+    tile.lru = m_lru.insert(m_lru.end(), key);
+
+    if (is_new)
+    {
+        std::fill_n(tile.pixels, size_t(m_tile_size) * m_tile_size, RGBA8());
+    }
+
+    return tile.pixels;
+}
+
+template<typename FUNCTION>
+void imaging::TiledBitmap::for_each_tile(int64_t x, int64_t y, int64_t width, int64_t height, bool create, FUNCTION function) const
+{
+    int64_t left = std::max<int64_t>(x, 0);
+    int64_t top = std::max<int64_t>(y, 0);
+    int64_t right = std::min<int64_t>(x + width, int64_t(m_width));
+    int64_t bottom = std::min<int64_t>(y + height, int64_t(m_height));
+
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    for (uint64_t tile_y = uint64_t(top) / m_tile_size; tile_y <= uint64_t(bottom - 1) / m_tile_size; ++tile_y)
+    {
+        for (uint64_t tile_x = uint64_t(left) / m_tile_size; tile_x <= uint64_t(right - 1) / m_tile_size; ++tile_x)
+        {
+            RGBA8* pixels = tile_pixels(tile_y * m_tiles_across + tile_x, create);
+
+            function(pixels, int64_t(tile_x * m_tile_size), int64_t(tile_y * m_tile_size));
+        }
+    }
+}
+
+void imaging::TiledBitmap::fill_rect(int64_t x, int64_t y, int64_t width, int64_t height, const RGBA8& color)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned size = m_tile_size;
+
+    for_each_tile(x, y, width, height, true, [&](RGBA8* pixels, int64_t tile_x, int64_t tile_y) {
+        FramebufferView<RGBA8> tile(pixels, size, size, size);
+
+        imaging::fill_rect(tile, x - tile_x, y - tile_y, width, height, color);
+    });
+}
+
+void imaging::TiledBitmap::write(int64_t x, int64_t y, const FramebufferView<const RGBA8>& source)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned size = m_tile_size;
+
+    for_each_tile(x, y, source.width(), source.height(), true, [&](RGBA8* pixels, int64_t tile_x, int64_t tile_y) {
+        FramebufferView<RGBA8> tile(pixels, size, size, size);
+
+        blit(tile, x - tile_x, y - tile_y, source);
+    });
+}
+
+void imaging::TiledBitmap::read(int64_t x, int64_t y, const FramebufferView<RGBA8>& target) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned size = m_tile_size;
+
+    // Pixels outside the bitmap are not covered by any tile
+    if (x < 0 || y < 0 || x + int64_t(target.width()) > int64_t(m_width) || y + int64_t(target.height()) > int64_t(m_height))
+    {
+        target.fill(RGBA8());
+    }
+
+    for_each_tile(x, y, target.width(), target.height(), false, [&](RGBA8* pixels, int64_t tile_x, int64_t tile_y) {
+        if (pixels == nullptr)
+        {
+            imaging::fill_rect(target, tile_x - x, tile_y - y, size, size, RGBA8());
+        }
+        else
+        {
+            blit(target, tile_x - x, tile_y - y, FramebufferView<const RGBA8>(pixels, size, size, size));
+        }
+    });
+}
+
+std::shared_ptr<RGBA8Bitmap> imaging::TiledBitmap::slice(int64_t x, int64_t y, unsigned width, unsigned height) const
+{
+    auto result = std::make_shared<RGBA8Bitmap>(width, height);
+
+    read(x, y, result->view());
+
+    return result;
+}
+
+void imaging::TiledBitmap::write_bmp(std::ostream& out, BmpFormat format) const
+{
+    uint64_t limit = uint64_t(std::numeric_limits<int32_t>::max());
+
+    CHECK(m_width <= limit && m_height <= limit) << "A " << m_width << " x " << m_height << " bitmap is too large for a BMP file";
+
+    unsigned width = unsigned(m_width);
+    unsigned height = unsigned(m_height);
+    unsigned band_height = unsigned(std::min<size_t>(std::max<size_t>(1, BMP_BAND_BYTES / (size_t(width) * sizeof(RGBA8) + 1)), height));
+    BmpEncoder encoder(format);
+    Framebuffer<RGBA8> band(width, band_height);
+
+    const std::vector<uint8_t>& header = encoder.encode_header(width, height);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    // BMP files start with the bottom row
+    for (unsigned bottom = height; bottom != 0; )
+    {
+        unsigned rows = std::min(bottom, band_height);
+        FramebufferView<RGBA8> view = band.view().sub_view(0, 0, width, rows);
+
+        read(0, bottom - rows, view);
+
+        const std::vector<uint8_t>& data = encoder.encode_rows(view);
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        bottom -= rows;
+    }
+}
+
+void imaging::TiledBitmap::save_as_bmp(const std::string& path, BmpFormat format) const
+{
+    std::ofstream out(path, std::ios::binary);
+
+    CHECK(out) << "Could not open " << path;
+    write_bmp(out, format);
+}
@@ -0,0 +1,126 @@
+#ifndef TILED_BITMAP_H
+#define TILED_BITMAP_H
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "io/memory-mapped-file.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// RGBA8 bitmap that lives in a file rather than in memory, for images too large for RAM
+    /// (e.g. the whole piano roll of a long song at a fine scale). Coordinates are 64-bit.
+    /// The image is divided in square tiles of tile_size() pixels. A tile only gets space in the file
+    /// once something is drawn on it; untouched tiles read as opaque black. At most memory_budget bytes of
+    /// tiles are mapped at any time, the least recently used tile being unmapped first.
+    /// All operations are safe to call from several threads, but are serialized.
+    /// </summary>
+    class TiledBitmap final
+    {
+    public:
+        static const unsigned DEFAULT_TILE_SIZE = 256;
+
+        /// <summary>
+        /// Creates an opaque black bitmap backed by the file at <paramref name="path" />, which is overwritten.
+        /// The file is left behind when the bitmap is destroyed.
+        /// </summary>
+        TiledBitmap(uint64_t width, uint64_t height, const std::string& path, size_t memory_budget, unsigned tile_size = DEFAULT_TILE_SIZE);
+        ~TiledBitmap();
+
+        TiledBitmap(const TiledBitmap&) = delete;
+        TiledBitmap& operator =(const TiledBitmap&) = delete;
+
+        uint64_t width() const
+        {
+            return m_width;
+        }
+
+        uint64_t height() const
+        {
+            return m_height;
+        }
+
+        unsigned tile_size() const
+        {
+            return m_tile_size;
+        }
+
+        /// <summary>
+        /// Number of tiles that have been drawn on, i.e. that take up space in the file.
+        /// </summary>
+        size_t stored_tiles() const;
+
+        /// <summary>
+        /// Number of tiles currently mapped into memory. Never more than the memory budget allows.
+        /// </summary>
+        size_t mapped_tiles() const;
+
+        /// <summary>
+        /// Like imaging::fill_rect: fills the rectangle, clipped to the bitmap.
+        /// </summary>
+        void fill_rect(int64_t x, int64_t y, int64_t width, int64_t height, const RGBA8& color);
+
+        /// <summary>
+        /// Copies <paramref name="source" /> to the bitmap with its top left corner at (x, y), clipped to the bitmap.
+        /// </summary>
+        void write(int64_t x, int64_t y, const FramebufferView<const RGBA8>& source);
+
+        /// <summary>
+        /// Copies the rectangle with its top left corner at (x, y) and the size of <paramref name="target" />
+        /// to <paramref name="target" />. Pixels outside the bitmap read as opaque black.
+        /// </summary>
+        void read(int64_t x, int64_t y, const FramebufferView<RGBA8>& target) const;
+
+        /// <summary>
+        /// Copies a rectangle, which may span any number of tiles, into a new in-memory bitmap.
+        /// </summary>
+        std::shared_ptr<RGBA8Bitmap> slice(int64_t x, int64_t y, unsigned width, unsigned height) const;
+
+        /// <summary>
+        /// Writes the bitmap as a BMP file, encoding a band of rows at a time so that memory use
+        /// does not depend on the height. Width and height must fit in a BMP header.
+        /// </summary>
+        void write_bmp(std::ostream& out, BmpFormat format = BmpFormat::BGRA32) const;
+        void save_as_bmp(const std::string& path, BmpFormat format = BmpFormat::BGRA32) const;
+
+    private:
+        struct TILE
+        {
+            uint64_t offset;
+            RGBA8* pixels;
+            std::list<uint64_t>::iterator lru;
+        };
+
+        // Calls function(tile, tile_x, tile_y) for every tile overlapping the rectangle, clipped to the bitmap.
+        // tile is nullptr for tiles that have not been drawn on, unless create is true
+        template<typename FUNCTION>
+        void for_each_tile(int64_t x, int64_t y, int64_t width, int64_t height, bool create, FUNCTION function) const;
+
+        // Returns the pixels of the tile, mapping (and with create, allocating) it if needed
+        RGBA8* tile_pixels(uint64_t key, bool create) const;
+        void unmap(TILE& tile) const;
+
+        uint64_t m_width;
+        uint64_t m_height;
+        unsigned m_tile_size;
+        uint64_t m_tiles_across;
+        size_t m_tile_bytes;
+        size_t m_max_mapped;
+        mutable io::WritableMemoryMappedFile m_file;
+        mutable std::unordered_map<uint64_t, TILE> m_tiles;
+        mutable std::list<uint64_t> m_lru;
+        mutable std::mutex m_mutex;
+    };
+}
+
+#endif
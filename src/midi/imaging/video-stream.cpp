@@ -0,0 +1,252 @@
+#include "imaging/video-stream.h"
+#include "logging.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+#ifdef _WIN32
+#   include <fcntl.h>
+#   include <io.h>
+#endif
+
+
+using namespace imaging;
+
+namespace
+{
+    const char FRAME_MARKER[] = "FRAME\n";
+    const size_t FRAME_MARKER_SIZE = sizeof(FRAME_MARKER) - 1;
+
+    // BT.601, limited range, 8 bit fixed point
+    uint8_t luma(unsigned r, unsigned g, unsigned b)
+    {
+        return uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+
+    uint8_t blue_difference(int r, int g, int b)
+    {
+        return uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    }
+
+    uint8_t red_difference(int r, int g, int b)
+    {
+        return uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+imaging::VideoEncoder::VideoEncoder(VideoFormat format, unsigned width, unsigned height, unsigned frame_rate)
+    : m_format(format), m_width(width), m_height(height), m_frame_rate(frame_rate), m_scratch(2 * size_t(width))
+{
+    // NOP
+}
+
+std::string imaging::VideoEncoder::header() const
+{
+    if (m_format == VideoFormat::RGB24)
+    {
+        return std::string();
+    }
+
+    std::stringstream header;
+    header << "YUV4MPEG2 W" << m_width << " H" << m_height << " F" << m_frame_rate << ":1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+
+    return header.str();
+}
+
+const std::vector<uint8_t>& imaging::VideoEncoder::encode(const FramebufferView<const RGBA8>& frame, unsigned rotation)
+{
+    assert(frame.width() == m_width && frame.height() == m_height);
+
+    if (m_format == VideoFormat::Y4M)
+    {
+        encode_y4m(frame, rotation);
+    }
+    else
+    {
+        encode_rgb24(frame, rotation);
+    }
+
+    return m_buffer;
+}
+
+const RGBA8* imaging::VideoEncoder::row(const FramebufferView<const RGBA8>& frame, unsigned y, unsigned rotation, RGBA8* scratch) const
+{
+    const RGBA8* pixels = frame.row(y);
+
+    if (rotation == 0)
+    {
+        return pixels;
+    }
+
+    std::copy(pixels + rotation, pixels + m_width, scratch);
+    std::copy(pixels, pixels + rotation, scratch + (m_width - rotation));
+
+    return scratch;
+}
+
+void imaging::VideoEncoder::encode_y4m(const FramebufferView<const RGBA8>& frame, unsigned rotation)
+{
+    size_t luma_size = size_t(m_width) * m_height;
+    unsigned chroma_width = (m_width + 1) / 2;
+    unsigned chroma_height = (m_height + 1) / 2;
+    size_t chroma_size = size_t(chroma_width) * chroma_height;
+
+    m_buffer.resize(FRAME_MARKER_SIZE + luma_size + 2 * chroma_size);
+    std::memcpy(m_buffer.data(), FRAME_MARKER, FRAME_MARKER_SIZE);
+
+    uint8_t* y_plane = m_buffer.data() + FRAME_MARKER_SIZE;
+    uint8_t* u_plane = y_plane + luma_size;
+    uint8_t* v_plane = u_plane + chroma_size;
+
+    // Two rows at a time, as each chroma sample covers a 2x2 block (the last row or column repeats for odd sizes)
+    for (unsigned y = 0; y < m_height; y += 2)
+    {
+        const RGBA8* top = row(frame, y, rotation, m_scratch.data());
+        const RGBA8* bottom = y + 1 < m_height ? row(frame, y + 1, rotation, m_scratch.data() + m_width) : top;
+
+        for (unsigned x = 0; x != m_width; ++x)
+        {
+            y_plane[size_t(y) * m_width + x] = luma(top[x].r, top[x].g, top[x].b);
+        }
+        if (bottom != top)
+        {
+            for (unsigned x = 0; x != m_width; ++x)
+            {
+                y_plane[size_t(y + 1) * m_width + x] = luma(bottom[x].r, bottom[x].g, bottom[x].b);
+            }
+        }
+
+        uint8_t* u = u_plane + size_t(y / 2) * chroma_width;
+        uint8_t* v = v_plane + size_t(y / 2) * chroma_width;
+
+        for (unsigned x = 0; x < m_width; x += 2)
+        {
+            unsigned right = std::min(x + 1, m_width - 1);
+            int r = (top[x].r + top[right].r + bottom[x].r + bottom[right].r + 2) / 4;
+            int g = (top[x].g + top[right].g + bottom[x].g + bottom[right].g + 2) / 4;
+            int b = (top[x].b + top[right].b + bottom[x].b + bottom[right].b + 2) / 4;
+
+            u[x / 2] = blue_difference(r, g, b);
+            v[x / 2] = red_difference(r, g, b);
+        }
+    }
+}
+
+void imaging::VideoEncoder::encode_rgb24(const FramebufferView<const RGBA8>& frame, unsigned rotation)
+{
+    m_buffer.resize(size_t(m_width) * m_height * 3);
+    uint8_t* out = m_buffer.data();
+
+    for (unsigned y = 0; y != m_height; ++y)
+    {
+        const RGBA8* pixels = row(frame, y, rotation, m_scratch.data());
+
+        for (unsigned x = 0; x != m_width; ++x)
+        {
+            out[0] = pixels[x].r;
+            out[1] = pixels[x].g;
+            out[2] = pixels[x].b;
+            out += 3;
+        }
+    }
+}
+
+FrameEncoding imaging::VideoEncoder::encoding(VideoFormat format, unsigned width, unsigned height, unsigned frame_rate)
+{
+    return FrameEncoding([format, width, height, frame_rate]() -> FrameEncoder {
+        auto encoder = std::make_shared<VideoEncoder>(format, width, height, frame_rate);
+
+        return [encoder](const FramebufferView<const RGBA8>& frame, unsigned rotation) -> const std::vector<uint8_t>& {
+            return encoder->encode(frame, rotation);
+        };
+    });
+}
+
+namespace
+{
+    std::FILE* open_output(const std::string& path)
+    {
+        if (path == "-")
+        {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            return stdout;
+        }
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+
+        CHECK(file != nullptr) << "Cannot open " << path;
+
+        return file;
+    }
+}
+
+imaging::OrderedFrameWriter::OrderedFrameWriter(const std::string& path, const std::string& header, size_t window)
+    : OrderedFrameWriter(open_output(path), header, window)
+{
+    m_close = path != "-";
+}
+
+imaging::OrderedFrameWriter::OrderedFrameWriter(std::FILE* file, const std::string& header, size_t window)
+    : m_file(file), m_close(false), m_window(std::max<size_t>(window, 1)), m_next(0)
+{
+    write_bytes(reinterpret_cast<const uint8_t*>(header.data()), header.size());
+}
+
+imaging::OrderedFrameWriter::~OrderedFrameWriter()
+{
+    if (m_close)
+    {
+        std::fclose(m_file);
+    }
+    else
+    {
+        std::fflush(m_file);
+    }
+}
+
+void imaging::OrderedFrameWriter::write_bytes(const uint8_t* data, size_t size)
+{
+    CHECK(std::fwrite(data, 1, size, m_file) == size) << "Failed to write video stream";
+}
+
+void imaging::OrderedFrameWriter::write(size_t frame, const std::vector<uint8_t>& data)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Back-pressure: never get more than window frames ahead of the writer
+    m_written.wait(lock, [this, frame]() { return frame < m_next + m_window; });
+
+    if (frame != m_next)
+    {
+        m_pending[frame] = data;
+        return;
+    }
+
+    // Only the caller holding frame m_next writes, so writing can happen without holding the lock
+    lock.unlock();
+    write_bytes(data.data(), data.size());
+    lock.lock();
+    ++m_next;
+
+    for (auto next = m_pending.find(m_next); next != m_pending.end(); next = m_pending.find(m_next))
+    {
+        std::vector<uint8_t> buffered = std::move(next->second);
+        m_pending.erase(next);
+
+        lock.unlock();
+        write_bytes(buffered.data(), buffered.size());
+        lock.lock();
+        ++m_next;
+    }
+
+    m_written.notify_all();
+}
+
+FrameSink imaging::OrderedFrameWriter::sink()
+{
+    return [this](size_t frame, const std::vector<uint8_t>& data) { write(frame, data); };
+}
@@ -0,0 +1,117 @@
+#ifndef VIDEO_STREAM_H
+#define VIDEO_STREAM_H
+
+#include "imaging/frame-export.h"
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Uncompressed video stream formats a video encoder such as ffmpeg can read from a pipe.
+    /// Y4M is YUV4MPEG2 with 4:2:0 chroma (ffmpeg -f yuv4mpegpipe -i -), which describes itself.
+    /// RGB24 is headerless packed RGB (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -i -).
+    /// </summary>
+    enum class VideoFormat
+    {
+        Y4M,
+        RGB24
+    };
+
+    /// <summary>
+    /// Encodes frames of a fixed size for a video stream, reusing its buffer between frames.
+    /// RGB is converted to YUV with the BT.601 limited range matrix, averaging each 2x2 block for chroma.
+    /// </summary>
+    class VideoEncoder final
+    {
+    public:
+        VideoEncoder(VideoFormat format, unsigned width, unsigned height, unsigned frame_rate);
+
+        /// <summary>
+        /// Bytes to send once, before the first frame. Empty for RGB24.
+        /// </summary>
+        std::string header() const;
+
+        /// <summary>
+        /// Encodes one frame, whose rows are rotated left by <paramref name="rotation" /> pixels
+        /// (see ScrollingFramebuffer). The returned buffer is overwritten by the next call.
+        /// </summary>
+        const std::vector<uint8_t>& encode(const FramebufferView<const RGBA8>& frame, unsigned rotation = 0);
+
+        /// <summary>
+        /// FrameEncoding creating a VideoEncoder per worker, for use with export_frames.
+        /// </summary>
+        static FrameEncoding encoding(VideoFormat format, unsigned width, unsigned height, unsigned frame_rate);
+
+    private:
+        void encode_y4m(const FramebufferView<const RGBA8>& frame, unsigned rotation);
+        void encode_rgb24(const FramebufferView<const RGBA8>& frame, unsigned rotation);
+
+        // Row y of frame in screen order; copied into scratch if it has to be un-rotated
+        const RGBA8* row(const FramebufferView<const RGBA8>& frame, unsigned y, unsigned rotation, RGBA8* scratch) const;
+
+        VideoFormat m_format;
+        unsigned m_width;
+        unsigned m_height;
+        unsigned m_frame_rate;
+        std::vector<uint8_t> m_buffer;
+        std::vector<RGBA8> m_scratch;
+    };
+
+    /// <summary>
+    /// Writes frames to a file, standard output ("-") or a named pipe, in frame order, whatever order the
+    /// workers of export_frames finish them in. Frames finished early are buffered, up to
+    /// <paramref name="window" /> frames past the next one to write; beyond that, workers wait.
+    /// Writes block when the reader of a pipe falls behind, so rendering never runs more than
+    /// window frames ahead of the encoder reading the stream.
+    /// </summary>
+    class OrderedFrameWriter final
+    {
+    public:
+        /// <summary>
+        /// Opens <paramref name="path" /> ("-" for standard output) and writes <paramref name="header" /> to it.
+        /// </summary>
+        OrderedFrameWriter(const std::string& path, const std::string& header, size_t window);
+
+        /// <summary>
+        /// Writes to an already open <paramref name="file" />, which is flushed but not closed in the end.
+        /// </summary>
+        OrderedFrameWriter(std::FILE* file, const std::string& header, size_t window);
+        ~OrderedFrameWriter();
+
+        OrderedFrameWriter(const OrderedFrameWriter&) = delete;
+        OrderedFrameWriter& operator =(const OrderedFrameWriter&) = delete;
+
+        /// <summary>
+        /// Writes <paramref name="frame" /> or buffers it until all frames before it have been written.
+        /// Every frame number must be passed exactly once, starting at 0.
+        /// </summary>
+        void write(size_t frame, const std::vector<uint8_t>& data);
+
+        /// <summary>
+        /// FrameSink calling write.
+        /// </summary>
+        FrameSink sink();
+
+    private:
+        void write_bytes(const uint8_t* data, size_t size);
+
+        std::FILE* m_file;
+        bool m_close;
+        size_t m_window;
+        size_t m_next;
+        std::map<size_t, std::vector<uint8_t>> m_pending;
+        std::mutex m_mutex;
+        std::condition_variable m_written;
+    };
+}
+
+#endif
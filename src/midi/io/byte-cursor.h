@@ -0,0 +1,84 @@
+#pragma once
+
+#include "logging.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace io {
+
+	/// <summary>
+	/// Bounds-checked read position inside a contiguous, non-owned block of bytes
+	/// (e.g. a memory-mapped file). Reading never copies the underlying buffer.
+	/// </summary>
+	class ByteCursor {
+	public:
+		ByteCursor(const uint8_t* data, size_t size)
+			: m_begin(data), m_position(data), m_end(data + size) { }
+
+		/// <summary>
+		/// Number of bytes consumed since the cursor was created.
+		/// </summary>
+		size_t offset() const {
+			return m_position - m_begin;
+		}
+
+		size_t remaining() const {
+			return m_end - m_position;
+		}
+
+		bool at_end() const {
+			return m_position == m_end;
+		}
+
+		const uint8_t* position() const {
+			return m_position;
+		}
+
+		/// <summary>
+		/// Returns the next byte without consuming it.
+		/// </summary>
+		uint8_t peek() const {
+			CHECK(!at_end()) << __FUNCTION__ << " has failed.";
+			return *m_position;
+		}
+
+		/// <summary>
+		/// Consumes <paramref name="n" /> bytes and returns a pointer to the first one.
+		/// </summary>
+		const uint8_t* take(size_t n) {
+			CHECK(n <= remaining()) << __FUNCTION__ << " has failed.";
+			const uint8_t* result = m_position;
+			m_position += n;
+			return result;
+		}
+
+		/// <summary>
+		/// Non-aborting take: returns false and leaves the cursor where it is if fewer than
+		/// <paramref name="n" /> bytes are left.
+		/// </summary>
+		bool try_take(size_t n, const uint8_t** result) {
+			if (n > remaining()) {
+				return false;
+			}
+			*result = m_position;
+			m_position += n;
+			return true;
+		}
+
+		void skip(size_t n) {
+			take(n);
+		}
+
+		/// <summary>
+		/// Consumes <paramref name="n" /> bytes and returns a cursor restricted to them.
+		/// </summary>
+		ByteCursor sub_cursor(size_t n) {
+			return ByteCursor(take(n), n);
+		}
+
+	private:
+		const uint8_t* m_begin;
+		const uint8_t* m_position;
+		const uint8_t* m_end;
+	};
+}
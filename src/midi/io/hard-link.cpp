@@ -0,0 +1,17 @@
+#include "hard-link.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+bool io::create_hard_link(const std::string& target, const std::string& link) {
+#ifdef _WIN32
+	return CreateHardLinkA(link.c_str(), target.c_str(), nullptr) != 0;
+#else
+	return ::link(target.c_str(), link.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+namespace io {
+
+	/// <summary>
+	/// Creates <paramref name="link" /> as another name for the existing file <paramref name="target" />.
+	/// Returns false if that fails, e.g. because the file system has no hard links or link already exists.
+	/// </summary>
+	bool create_hard_link(const std::string& target, const std::string& link);
+}
@@ -0,0 +1,123 @@
+#include "lz.h"
+#include <cstring>
+
+namespace {
+	// Shorter matches cost more to encode than the literals they replace
+	const size_t MIN_MATCH = 4;
+
+	const unsigned HASH_BITS = 14;
+
+	uint32_t load32(const uint8_t* p) {
+		uint32_t result;
+		std::memcpy(&result, p, sizeof(result));
+		return result;
+	}
+
+	uint32_t hash(uint32_t bytes) {
+		return (bytes * 2654435761U) >> (32 - HASH_BITS);
+	}
+
+	void write_count(std::vector<uint8_t>* out, uint64_t value) {
+		while (value >= 0x80) {
+			out->push_back(uint8_t(value | 0x80));
+			value >>= 7;
+		}
+		out->push_back(uint8_t(value));
+	}
+
+	bool read_count(const uint8_t*& position, const uint8_t* end, uint64_t* result) {
+		uint64_t value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7) {
+			if (position == end) {
+				return false;
+			}
+
+			uint8_t byte = *position++;
+			value |= uint64_t(byte & 0x7F) << shift;
+			if (byte < 0x80) {
+				*result = value;
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+void io::lz_compress(const uint8_t* data, size_t size, std::vector<uint8_t>* out) {
+	// Positions are stored plus one, so 0 means empty
+	std::vector<size_t> table(size_t(1) << HASH_BITS, 0);
+	size_t literals = 0;
+	size_t position = 0;
+
+	while (position + MIN_MATCH <= size) {
+		uint32_t bytes = load32(data + position);
+		size_t& slot = table[hash(bytes)];
+		size_t candidate = slot;
+		slot = position + 1;
+
+		if (candidate == 0 || load32(data + candidate - 1) != bytes) {
+			++position;
+			continue;
+		}
+
+		size_t source = candidate - 1;
+		size_t length = MIN_MATCH;
+		while (position + length != size && data[source + length] == data[position + length]) {
+			++length;
+		}
+
+		write_count(out, position - literals);
+		out->insert(out->end(), data + literals, data + position);
+		write_count(out, length);
+		write_count(out, position - source);
+
+		position += length;
+		literals = position;
+	}
+
+	// The last sequence has no match
+	write_count(out, size - literals);
+	out->insert(out->end(), data + literals, data + size);
+}
+
+bool io::lz_decompress(const uint8_t* data, size_t data_size, uint8_t* out, size_t size) {
+	const uint8_t* position = data;
+	const uint8_t* end = data + data_size;
+	size_t written = 0;
+
+	while (true) {
+		uint64_t literals;
+		if (!read_count(position, end, &literals) || literals > uint64_t(end - position) || literals > size - written) {
+			return false;
+		}
+
+		std::memcpy(out + written, position, size_t(literals));
+		position += literals;
+		written += size_t(literals);
+
+		if (written == size) {
+			return position == end;
+		}
+
+		uint64_t length, distance;
+		if (!read_count(position, end, &length) || !read_count(position, end, &distance)) {
+			return false;
+		}
+		if (distance == 0 || distance > written || length > size - written) {
+			return false;
+		}
+
+		uint8_t* target = out + written;
+		const uint8_t* source = target - distance;
+		if (distance >= length) {
+			std::memcpy(target, source, size_t(length));
+		}
+		else {
+			// Overlapping match: each byte may depend on one written by this match
+			for (size_t i = 0; i != length; i++) {
+				target[i] = source[i];
+			}
+		}
+		written += size_t(length);
+	}
+}
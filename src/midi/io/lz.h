@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace io {
+
+	/// <summary>
+	/// Appends a compressed copy of <paramref name="data" /> to <paramref name="out" />.
+	/// A block is a series of sequences: a number of literal bytes followed by a match, which repeats
+	/// bytes from earlier in the output. Counts and distances are stored as LEB128 integers.
+	/// Runs of equal pixels and rows equal to the one above, which make up most of a piano roll frame,
+	/// both become a single match. Compresses greedily with a small hash table, so it is fast rather than tight.
+	/// </summary>
+	void lz_compress(const uint8_t* data, size_t size, std::vector<uint8_t>* out);
+
+	/// <summary>
+	/// Decompresses a block written by lz_compress into exactly <paramref name="size" /> bytes at <paramref name="out" />.
+	/// Returns false if the block is damaged or does not decompress to that size.
+	/// </summary>
+	bool lz_decompress(const uint8_t* data, size_t data_size, uint8_t* out, size_t size);
+}
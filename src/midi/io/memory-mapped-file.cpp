@@ -0,0 +1,202 @@
+#include "memory-mapped-file.h"
+#include "logging.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+io::MemoryMappedFile::MemoryMappedFile()
+	: m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) { }
+
+const char* io::MemoryMappedFile::map(const std::string& path) {
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		return "Could not open ";
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size)) {
+		return "Could not determine size of ";
+	}
+	m_size = size_t(size.QuadPart);
+
+	if (m_size != 0) {
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) {
+			return "Could not map ";
+		}
+
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data == nullptr) {
+			return "Could not map ";
+		}
+	}
+	return nullptr;
+}
+
+io::MemoryMappedFile::~MemoryMappedFile() {
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+}
+
+io::WritableMemoryMappedFile::WritableMemoryMappedFile(const std::string& path)
+	: m_path(path), m_size(0), m_mapping(nullptr) {
+	m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	CHECK(m_file != INVALID_HANDLE_VALUE) << "Could not create " << path;
+}
+
+io::WritableMemoryMappedFile::~WritableMemoryMappedFile() {
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	CloseHandle(m_file);
+}
+
+size_t io::WritableMemoryMappedFile::granularity() {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+}
+
+void io::WritableMemoryMappedFile::resize(uint64_t size) {
+	if (size <= m_size) {
+		return;
+	}
+
+	// A mapping cannot grow, so a larger one replaces it. Views of the old mapping keep it alive.
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, DWORD(size >> 32), DWORD(size), nullptr);
+	CHECK(m_mapping != nullptr) << "Could not grow " << m_path;
+	m_size = size;
+}
+
+uint8_t* io::WritableMemoryMappedFile::map(uint64_t offset, size_t size) {
+	void* address = MapViewOfFile(m_mapping, FILE_MAP_READ | FILE_MAP_WRITE, DWORD(offset >> 32), DWORD(offset), size);
+	CHECK(address != nullptr) << "Could not map " << m_path;
+	return static_cast<uint8_t*>(address);
+}
+
+void io::WritableMemoryMappedFile::unmap(uint8_t* data, size_t) {
+	UnmapViewOfFile(data);
+}
+
+#else
+
+io::MemoryMappedFile::MemoryMappedFile()
+	: m_data(nullptr), m_size(0), m_descriptor(-1) { }
+
+const char* io::MemoryMappedFile::map(const std::string& path) {
+	m_descriptor = open(path.c_str(), O_RDONLY);
+	if (m_descriptor < 0) {
+		return "Could not open ";
+	}
+
+	struct stat info;
+	if (fstat(m_descriptor, &info) != 0) {
+		return "Could not determine size of ";
+	}
+	m_size = size_t(info.st_size);
+
+	if (m_size != 0) {
+		void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_descriptor, 0);
+		if (address == MAP_FAILED) {
+			return "Could not map ";
+		}
+
+		m_data = static_cast<const uint8_t*>(address);
+		madvise(address, m_size, MADV_SEQUENTIAL);
+	}
+	return nullptr;
+}
+
+io::MemoryMappedFile::~MemoryMappedFile() {
+	if (m_data != nullptr) {
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+	if (m_descriptor >= 0) {
+		close(m_descriptor);
+	}
+}
+
+io::WritableMemoryMappedFile::WritableMemoryMappedFile(const std::string& path)
+	: m_path(path), m_size(0) {
+	m_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	CHECK(m_descriptor >= 0) << "Could not create " << path;
+}
+
+io::WritableMemoryMappedFile::~WritableMemoryMappedFile() {
+	close(m_descriptor);
+}
+
+size_t io::WritableMemoryMappedFile::granularity() {
+	return size_t(sysconf(_SC_PAGESIZE));
+}
+
+void io::WritableMemoryMappedFile::resize(uint64_t size) {
+	if (size <= m_size) {
+		return;
+	}
+
+	CHECK(ftruncate(m_descriptor, off_t(size)) == 0) << "Could not grow " << m_path;
+	m_size = size;
+}
+
+uint8_t* io::WritableMemoryMappedFile::map(uint64_t offset, size_t size) {
+	void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_descriptor, off_t(offset));
+	CHECK(address != MAP_FAILED) << "Could not map " << m_path;
+	return static_cast<uint8_t*>(address);
+}
+
+void io::WritableMemoryMappedFile::unmap(uint8_t* data, size_t size) {
+	munmap(data, size);
+}
+
+#endif
+
+uint64_t io::WritableMemoryMappedFile::size() const {
+	return m_size;
+}
+
+io::MemoryMappedFile::MemoryMappedFile(const std::string& path)
+	: MemoryMappedFile() {
+	const char* error = map(path);
+	CHECK(error == nullptr) << error << path;
+}
+
+std::unique_ptr<io::MemoryMappedFile> io::MemoryMappedFile::try_open(const std::string& path) {
+	std::unique_ptr<MemoryMappedFile> file(new MemoryMappedFile());
+	if (file->map(path) != nullptr) {
+		return nullptr;
+	}
+	return file;
+}
+
+const uint8_t* io::MemoryMappedFile::data() const {
+	return m_data;
+}
+
+size_t io::MemoryMappedFile::size() const {
+	return m_size;
+}
+
+io::ByteCursor io::MemoryMappedFile::cursor() const {
+	return ByteCursor(m_data, m_size);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "io/byte-cursor.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace io {
+
+	/// <summary>
+	/// Read-only view of a whole file mapped into memory.
+	/// The mapping lives as long as the object.
+	/// </summary>
+	class MemoryMappedFile {
+	public:
+		explicit MemoryMappedFile(const std::string& path);
+		~MemoryMappedFile();
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator =(const MemoryMappedFile&) = delete;
+
+		/// <summary>
+		/// Like the constructor, but returns nullptr instead of aborting when the file cannot be opened or mapped.
+		/// </summary>
+		static std::unique_ptr<MemoryMappedFile> try_open(const std::string& path);
+
+		const uint8_t* data() const;
+		size_t size() const;
+		ByteCursor cursor() const;
+
+	private:
+		MemoryMappedFile();
+
+		// Returns nullptr on success, or the start of an error message
+		const char* map(const std::string& path);
+
+		const uint8_t* m_data;
+		size_t m_size;
+#ifdef _WIN32
+		void* m_file;
+		void* m_mapping;
+#else
+		int m_descriptor;
+#endif
+	};
+
+	/// <summary>
+	/// File that is mapped into memory piece by piece for reading and writing, e.g. as backing store for data
+	/// that does not fit in RAM. The constructor creates the file (or empties an existing one); it grows with resize.
+	/// Pieces must start at a multiple of granularity(). Changes reach the file when a piece is unmapped, at the latest.
+	/// </summary>
+	class WritableMemoryMappedFile {
+	public:
+		explicit WritableMemoryMappedFile(const std::string& path);
+		~WritableMemoryMappedFile();
+
+		WritableMemoryMappedFile(const WritableMemoryMappedFile&) = delete;
+		WritableMemoryMappedFile& operator =(const WritableMemoryMappedFile&) = delete;
+
+		/// <summary>
+		/// Alignment of the offsets passed to map: the page size, or the allocation granularity on Windows.
+		/// </summary>
+		static size_t granularity();
+
+		uint64_t size() const;
+
+		/// <summary>
+		/// Grows the file to <paramref name="size" /> bytes. New bytes are zero. Mapped pieces stay valid.
+		/// </summary>
+		void resize(uint64_t size);
+
+		uint8_t* map(uint64_t offset, size_t size);
+		void unmap(uint8_t* data, size_t size);
+
+	private:
+		std::string m_path;
+		uint64_t m_size;
+#ifdef _WIN32
+		void* m_file;
+		void* m_mapping;
+#else
+		int m_descriptor;
+#endif
+	};
+}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "logging.h"
+#include "io/byte-cursor.h"
 #include <istream>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace io {
 
@@ -28,4 +32,42 @@ namespace io {
 		return array;
 	}
 
+	template<typename T>
+	void read_to(ByteCursor& in, T* buffer, size_t n = 1)
+	{
+		memcpy(buffer, in.take(sizeof(T) * n), sizeof(T) * n);
+	}
+
+	template<typename T, typename std::enable_if<std::is_fundamental<T>::value, T>::type* = nullptr>
+	T read(ByteCursor& in)
+	{
+		T t;
+		read_to(in, &t);
+		return t;
+	}
+
+	template<typename T>
+	std::unique_ptr<T[]> read_array(ByteCursor& in, size_t n)
+	{
+		std::unique_ptr<T[]> array = std::make_unique<T[]>(n);
+		read_to(in, array.get(), n);
+		return array;
+	}
+
+	/// <summary>
+	/// Reads everything that is left in <paramref name="in" /> into one contiguous buffer.
+	/// </summary>
+	inline std::vector<uint8_t> read_all(std::istream& in)
+	{
+		std::vector<uint8_t> buffer;
+		char chunk[4096];
+
+		while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0)
+		{
+			buffer.insert(buffer.end(), chunk, chunk + in.gcount());
+		}
+
+		return buffer;
+	}
+
 }
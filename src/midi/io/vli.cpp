@@ -18,4 +18,43 @@ uint64_t io::read_variable_length_integer(std::istream& in) {
 	}
 
 	return ((result << 7) | drop_first_bit(byte));	
-}
\ No newline at end of file
+}
+
+size_t io::details::decode_long_variable_length_integer(const uint8_t* data, size_t size, uint32_t* result) {
+	size_t limit = size < MAX_VARIABLE_LENGTH_INTEGER_SIZE ? size : MAX_VARIABLE_LENGTH_INTEGER_SIZE;
+	uint32_t value = 0;
+
+	for (size_t i = 0; i != limit; i++) {
+		value = (value << 7) | drop_first_bit(data[i]);
+
+		if (!significant_set(data[i])) {
+			*result = value;
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+void io::details::report_invalid_variable_length_integer() {
+	CHECK(false) << "read_variable_length_integer has failed.";
+}
+
+size_t io::decode_variable_length_integers(const uint8_t* data, size_t size, uint32_t* results, size_t count, size_t* consumed) {
+	const uint8_t* position = data;
+	const uint8_t* end = data + size;
+	size_t decoded = 0;
+
+	while (decoded != count) {
+		size_t length = decode_variable_length_integer(position, end - position, results + decoded);
+		if (length == 0) {
+			break;
+		}
+
+		position += length;
+		decoded++;
+	}
+
+	*consumed = position - data;
+	return decoded;
+}
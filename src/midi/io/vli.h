@@ -5,4 +5,62 @@
 
 namespace io {
 	uint64_t read_variable_length_integer(std::istream& in);
+
+	/// <summary>
+	/// Longest variable-length integer allowed in a standard MIDI file (28 bits of payload).
+	/// </summary>
+	const size_t MAX_VARIABLE_LENGTH_INTEGER_SIZE = 4;
+
+	namespace details {
+		size_t decode_long_variable_length_integer(const uint8_t* data, size_t size, uint32_t* result);
+
+		// Kept out of line so the CHECK does not stop read_variable_length_integer from being inlined
+		void report_invalid_variable_length_integer();
+	}
+
+	/// <summary>
+	/// Decodes one variable-length integer from <paramref name="data" /> without going through a stream.
+	/// Returns the number of bytes it occupies, or 0 if the buffer ends too soon or the integer is longer than
+	/// MAX_VARIABLE_LENGTH_INTEGER_SIZE bytes. 1- and 2-byte integers, which are nearly all delta times
+	/// in practice, are handled without a loop.
+	/// </summary>
+	inline size_t decode_variable_length_integer(const uint8_t* data, size_t size, uint32_t* result) {
+		if (size >= 2) {
+			uint32_t byte0 = data[0];
+			if (byte0 < 0x80) {
+				*result = byte0;
+				return 1;
+			}
+
+			uint32_t byte1 = data[1];
+			if (byte1 < 0x80) {
+				*result = ((byte0 & 0x7F) << 7) | byte1;
+				return 2;
+			}
+		}
+
+		return details::decode_long_variable_length_integer(data, size, result);
+	}
+
+	/// <summary>
+	/// Reads a variable-length integer of at most MAX_VARIABLE_LENGTH_INTEGER_SIZE bytes.
+	/// Defined here so read_mtrk can inline the fast path.
+	/// </summary>
+	inline uint64_t read_variable_length_integer(ByteCursor& in) {
+		uint32_t result;
+		size_t size = decode_variable_length_integer(in.position(), in.remaining(), &result);
+		if (size == 0) {
+			details::report_invalid_variable_length_integer();
+		}
+
+		in.skip(size);
+		return result;
+	}
+
+	/// <summary>
+	/// Decodes up to <paramref name="count" /> consecutive variable-length integers into <paramref name="results" />.
+	/// Stops early at the first integer that cannot be decoded. Returns how many were decoded; the number
+	/// of bytes they occupied is stored in <paramref name="consumed" />.
+	/// </summary>
+	size_t decode_variable_length_integers(const uint8_t* data, size_t size, uint32_t* results, size_t count, size_t* consumed);
 }
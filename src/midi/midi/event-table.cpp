@@ -0,0 +1,90 @@
+#include "event-table.h"
+#include "io/memory-mapped-file.h"
+#include <limits>
+
+namespace midi {
+
+	void EventTable::begin_track() {
+		(*this).track_starts.push_back((*this).deltas.size());
+	}
+
+	void EventTable::push(Duration dt, uint8_t status, uint8_t d1, uint8_t d2) {
+		CHECK(!(*this).track_starts.empty()) << "EventTable received an event before begin_track";
+		CHECK(value(dt) <= std::numeric_limits<uint32_t>::max()) << "Delta time does not fit in an EventTable";
+		CHECK((*this).payloads.size() <= std::numeric_limits<uint32_t>::max()) << "Payloads do not fit in an EventTable";
+
+		(*this).deltas.push_back(uint32_t(value(dt)));
+		(*this).statuses.push_back(status);
+		(*this).data1.push_back(d1);
+		(*this).data2.push_back(d2);
+		(*this).payload_offsets.push_back(uint32_t((*this).payloads.size()));
+	}
+
+	void EventTable::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+		(*this).meta(dt, type, data.get(), data_size);
+	}
+
+	void EventTable::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+		(*this).sysex(dt, data.get(), data_size);
+	}
+
+	void EventTable::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		(*this).push(dt, 0xFF, type, 0);
+		(*this).payloads.insert((*this).payloads.end(), data, data + data_size);
+	}
+
+	void EventTable::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		(*this).push(dt, 0xF0, 0, 0);
+		(*this).payloads.insert((*this).payloads.end(), data, data + data_size);
+	}
+
+	void EventTable::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+		(*this).push(dt, uint8_t(0x90 | value(channel)), value(note), velocity);
+	}
+
+	void EventTable::note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+		(*this).push(dt, uint8_t(0x80 | value(channel)), value(note), velocity);
+	}
+
+	void EventTable::polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) {
+		(*this).push(dt, uint8_t(0xA0 | value(channel)), value(note), pressure);
+	}
+
+	void EventTable::control_change(Duration dt, Channel channel, uint8_t controller, uint8_t controller_value) {
+		(*this).push(dt, uint8_t(0xB0 | value(channel)), controller, controller_value);
+	}
+
+	void EventTable::program_change(Duration dt, Channel channel, Instrument program) {
+		(*this).push(dt, uint8_t(0xC0 | value(channel)), value(program), 0);
+	}
+
+	void EventTable::channel_pressure(Duration dt, Channel channel, uint8_t pressure) {
+		(*this).push(dt, uint8_t(0xD0 | value(channel)), pressure, 0);
+	}
+
+	void EventTable::pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) {
+		(*this).push(dt, uint8_t(0xE0 | value(channel)), uint8_t(wheel_position & 0x7F), uint8_t((wheel_position >> 7) & 0x7F));
+	}
+
+	void EventTable::replay(size_t track, EventReceiver& receiver) const {
+		(*this).replay<EventReceiver>(track, receiver);
+	}
+
+	EventTable read_event_table(const uint8_t* data, size_t size) {
+		io::ByteCursor cursor(data, size);
+		MTHD mthd;
+		read_mthd(cursor, &mthd);
+
+		EventTable table;
+		for (int i = 0; i < mthd.ntracks; i++) {
+			table.begin_track();
+			read_mtrk(cursor, table);
+		}
+		return table;
+	}
+
+	EventTable read_event_table_from_file(const std::string& path) {
+		io::MemoryMappedFile file(path);
+		return read_event_table(file.data(), file.size());
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "midi.h"
+#include <vector>
+
+namespace midi {
+
+	/// <summary>
+	/// Columnar store for the events of one or more MTrk chunks. Use it as the receiver of read_mtrk
+	/// (after calling begin_track) and replay the events later as many times as needed, without
+	/// decoding the chunk again. Every event costs 11 bytes plus its meta/sysex payload.
+	/// </summary>
+	class EventTable final {
+	public:
+		/// <summary>
+		/// Starts a new track. Events received afterwards are appended to it.
+		/// </summary>
+		void begin_track();
+
+		size_t track_count() const {
+			return (*this).track_starts.size();
+		}
+
+		size_t event_count() const {
+			return (*this).deltas.size();
+		}
+
+		size_t event_count(size_t track) const {
+			return (*this).track_end(track) - (*this).track_starts[track];
+		}
+
+		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size);
+		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size);
+		void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size);
+		void sysex(Duration dt, const uint8_t* data, uint64_t data_size);
+		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity);
+		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity);
+		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure);
+		void control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value);
+		void program_change(Duration dt, Channel channel, Instrument program);
+		void channel_pressure(Duration dt, Channel channel, uint8_t pressure);
+		void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position);
+
+		/// <summary>
+		/// Feeds the events of <paramref name="track" /> to <paramref name="receiver" /> in their original order.
+		/// RECEIVER can be any type with the same member functions as EventReceiver.
+		/// </summary>
+		template<typename RECEIVER>
+		void replay(size_t track, RECEIVER& receiver) const {
+			size_t end = (*this).track_end(track);
+
+			for (size_t i = (*this).track_starts[track]; i != end; i++) {
+				Duration dt(deltas[i]);
+				uint8_t status = statuses[i];
+				const STATUS_INFO& info = status_table[status];
+				Channel channel(info.channel);
+
+				switch (info.kind) {
+				case EventKind::META:
+					details::deliver_meta(receiver, dt, data1[i], (*this).payload(i), (*this).payload_size(i), 0);
+					break;
+
+				case EventKind::SYSEX:
+					details::deliver_sysex(receiver, dt, (*this).payload(i), (*this).payload_size(i), 0);
+					break;
+
+				case EventKind::NOTE_OFF:
+					receiver.note_off(dt, channel, NoteNumber(data1[i]), data2[i]);
+					break;
+
+				case EventKind::NOTE_ON:
+					receiver.note_on(dt, channel, NoteNumber(data1[i]), data2[i]);
+					break;
+
+				case EventKind::POLYPHONIC_KEY_PRESSURE:
+					receiver.polyphonic_key_pressure(dt, channel, NoteNumber(data1[i]), data2[i]);
+					break;
+
+				case EventKind::CONTROL_CHANGE:
+					receiver.control_change(dt, channel, data1[i], data2[i]);
+					break;
+
+				case EventKind::PROGRAM_CHANGE:
+					receiver.program_change(dt, channel, Instrument(data1[i]));
+					break;
+
+				case EventKind::CHANNEL_PRESSURE:
+					receiver.channel_pressure(dt, channel, data1[i]);
+					break;
+
+				case EventKind::PITCH_WHEEL_CHANGE:
+					receiver.pitch_wheel_change(dt, channel, uint16_t(data1[i] | (data2[i] << 7)));
+					break;
+
+				default:
+					break;
+				}
+			}
+		}
+
+		void replay(size_t track, EventReceiver& receiver) const;
+
+	private:
+		std::vector<uint32_t> deltas;
+		std::vector<uint8_t> statuses;
+		std::vector<uint8_t> data1;
+		std::vector<uint8_t> data2;
+		std::vector<uint32_t> payload_offsets;
+		std::vector<uint8_t> payloads;
+		std::vector<size_t> track_starts;
+
+		size_t track_end(size_t track) const {
+			return track + 1 < (*this).track_starts.size() ? (*this).track_starts[track + 1] : (*this).deltas.size();
+		}
+
+		const uint8_t* payload(size_t i) const {
+			return (*this).payloads.data() + (*this).payload_offsets[i];
+		}
+
+		uint64_t payload_size(size_t i) const {
+			size_t end = i + 1 < (*this).payload_offsets.size() ? (*this).payload_offsets[i + 1] : (*this).payloads.size();
+			return end - (*this).payload_offsets[i];
+		}
+
+		void push(Duration dt, uint8_t status, uint8_t d1, uint8_t d2);
+	};
+
+	/// <summary>
+	/// Reads a complete MIDI file (MThd followed by its MTrk chunks) into an EventTable, one track per chunk.
+	/// </summary>
+	EventTable read_event_table(const uint8_t* data, size_t size);
+	EventTable read_event_table_from_file(const std::string& path);
+}
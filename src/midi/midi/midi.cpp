@@ -1,4 +1,6 @@
 #include "midi.h"
+#include "io/memory-mapped-file.h"
+#include "util/parallel.h"
 
 namespace midi {
 
@@ -7,6 +9,11 @@ namespace midi {
 		io::switch_endianness(&((*c).size));
 	}
 
+	void read_chunk_header(io::ByteCursor& s, CHUNK_HEADER* c) {
+		io::read_to(s, c);
+		io::switch_endianness(&((*c).size));
+	}
+
 	std::string header_id(const CHUNK_HEADER c) {
 		std::string s = "";
 		for (char c : c.id) {
@@ -23,6 +30,14 @@ namespace midi {
 		io::switch_endianness(&((*m).division));
 	}
 
+	void read_mthd(io::ByteCursor& s, MTHD* m) {
+		io::read_to(s, m);
+		io::switch_endianness(&(((*m).header).size));
+		io::switch_endianness(&((*m).type));
+		io::switch_endianness(&((*m).ntracks));
+		io::switch_endianness(&((*m).division));
+	}
+
 	bool is_sysex_event(uint8_t byte) {
 		return (byte == 0xF0) || (byte == 0xF7);
 	}
@@ -76,99 +91,32 @@ namespace midi {
 		return status == 0x0E;
 	}
 
-	void read_mtrk(std::istream& s, EventReceiver& event_receiver) {
-		CHUNK_HEADER header;
-		read_chunk_header(s, &header);
-
-		bool has_next = true;
-		uint8_t running_identifier;
-
-		while (has_next) {
-			Duration duration(io::read_variable_length_integer(s));
-			uint8_t identifier = io::read<uint8_t>(s);
-
-			if (is_running_status(identifier)){
-				s.putback(identifier);
-				identifier = running_identifier;
-			}
-			else {
-				running_identifier = identifier;
-			}
-
-			if (is_meta_event(identifier)) {
-				uint8_t type = io::read<uint8_t>(s);
-
-				if (type == 0x2F) {
-					has_next = false;
-				}
-
-				uint64_t data_size = io::read_variable_length_integer(s);
-				std::unique_ptr<uint8_t[]> data = io::read_array<uint8_t>(s, data_size);
-
-				event_receiver.meta(duration, type, std::move(data), data_size);
-			}
-
-			else if (is_sysex_event(identifier)) {
-				uint64_t data_size = io::read_variable_length_integer(s);
-				std::unique_ptr<uint8_t[]> data = io::read_array<uint8_t>(s, data_size);
-
-				event_receiver.sysex(duration, std::move(data), data_size);
-			}
-
-			else if (is_midi_event(identifier)) {
-				uint8_t type = extract_midi_event_type(identifier);
-				Channel channel(extract_midi_event_channel(identifier));
-
-				if (is_note_off(type)) {
-					NoteNumber note(io::read<uint8_t>(s));
-					uint8_t velocity = io::read<uint8_t>(s);
-
-					event_receiver.note_off(duration, channel, note, velocity);
-				}
-
-				else if (is_note_on(type)) {
-					NoteNumber note(io::read<uint8_t>(s));
-					uint8_t velocity = io::read<uint8_t>(s);
-
-					event_receiver.note_on(duration, channel, note, velocity);
-				}
-
-				else if (is_polyphonic_key_pressure(type)) {
-					NoteNumber note(io::read<uint8_t>(s));
-					uint8_t pressure = io::read<uint8_t>(s);
-
-					event_receiver.polyphonic_key_pressure(duration, channel, note, pressure);
-				}
-
-				else if (is_control_change(type)) {
-					uint8_t controller = io::read<uint8_t>(s);
-					uint8_t pressure = io::read<uint8_t>(s);
-
-					event_receiver.control_change(duration, channel, controller, pressure);
-				}
-
-				else if (is_program_change(type)) {
-					Instrument program(io::read<uint8_t>(s));
-
-					event_receiver.program_change(duration, channel, program);
-				}
+	void EventReceiver::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		std::unique_ptr<uint8_t[]> owned = std::make_unique<uint8_t[]>(data_size);
+		std::copy(data, data + data_size, owned.get());
+		meta(dt, type, std::move(owned), data_size);
+	}
 
-				else if (is_channel_pressure(type)) {
-					uint8_t pressure = io::read<uint8_t>(s);
+	void EventReceiver::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		std::unique_ptr<uint8_t[]> owned = std::make_unique<uint8_t[]>(data_size);
+		std::copy(data, data + data_size, owned.get());
+		sysex(dt, std::move(owned), data_size);
+	}
 
-					event_receiver.channel_pressure(duration, channel, pressure);
-				}
+	void read_mtrk(io::ByteCursor& s, EventReceiver& event_receiver) {
+		read_mtrk<EventReceiver>(s, event_receiver);
+	}
 
-				else if (is_pitch_wheel_change(type)) {
-					uint16_t lower = io::read<uint8_t>(s);
-					uint16_t upper = (io::read<uint8_t>(s) << 7);
-					uint16_t position = (upper | lower);
+	void read_mtrk(std::istream& s, EventReceiver& event_receiver) {
+		// Only this chunk is read, so the stream is left at the next chunk and need not be seekable
+		CHUNK_HEADER header;
+		read_chunk_header(s, &header);
 
-					event_receiver.pitch_wheel_change(duration, channel, position);
-				}
+		std::vector<uint8_t> buffer(header.size);
+		io::read_to(s, buffer.data(), buffer.size());
 
-			}
-		}
+		io::ByteCursor events(buffer.data(), buffer.size());
+		read_mtrk_events(events, event_receiver);
 	}
 
 	bool operator == (NOTE note0, NOTE note1) {
@@ -203,6 +151,14 @@ namespace midi {
 		(*this).current_time += dt;
 	}
 
+	void ChannelNoteCollector::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
+	void ChannelNoteCollector::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
 	void ChannelNoteCollector::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
 		if (velocity == 0) {
 			(*this).note_off(dt, channel, note, velocity);
@@ -262,55 +218,67 @@ namespace midi {
 	//EventMultiCaster------------------------------------------------------------------------
 
 	void EventMulticaster::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).meta(dt, type, std::move(copy(data, data_size)), data_size);
 		}
 	}
 
 	void EventMulticaster::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).sysex(dt, std::move(copy(data, data_size)), data_size);
 		}
 	}
 
+	void EventMulticaster::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
+			(*event).meta(dt, type, data, data_size);
+		}
+	}
+
+	void EventMulticaster::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
+			(*event).sysex(dt, data, data_size);
+		}
+	}
+
 	void EventMulticaster::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).note_on(dt, channel, note, velocity);
 		}
 	}
 
 	void EventMulticaster::note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).note_off(dt, channel, note, velocity);
 		}
 	}
 
 	void EventMulticaster::polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).polyphonic_key_pressure(dt, channel, note, pressure);
 		}
 	}
 
 	void EventMulticaster::control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).control_change(dt, channel, controller, value);
 		}
 	}
 
 	void EventMulticaster::program_change(Duration dt, Channel channel, Instrument program) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).program_change(dt, channel, program);
 		}
 	}
 
 	void EventMulticaster::channel_pressure(Duration dt, Channel channel, uint8_t pressure) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).channel_pressure(dt, channel, pressure);
 		}
 	}
 
 	void EventMulticaster::pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) {
-		for (std::shared_ptr<EventReceiver> event : (*this).channel_caster) {
+		for (const std::shared_ptr<EventReceiver>& event : (*this).channel_caster) {
 			(*event).pitch_wheel_change(dt, channel, wheel_position);
 		}
 	}
@@ -333,6 +301,14 @@ namespace midi {
 		(*this).event_multicaster.sysex(dt, std::move(data), data_size);
 	}
 
+	void NoteCollector::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		(*this).event_multicaster.meta(dt, type, data, data_size);
+	}
+
+	void NoteCollector::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		(*this).event_multicaster.sysex(dt, data, data_size);
+	}
+
 	void NoteCollector::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
 		(*this).event_multicaster.note_on(dt, channel, note, velocity);
 	}
@@ -361,15 +337,159 @@ namespace midi {
 		(*this).event_multicaster.pitch_wheel_change(dt, channel, wheel_postition);
 	}
 
+	//MultiChannelNoteCollector---------------------------------------------------------------------
+
+	MultiChannelNoteCollector::MultiChannelNoteCollector(std::function<void(const NOTE&)> note_receiver0)
+		: note_receiver(note_receiver0) {
+		for (int channel = 0; channel < 16; channel++) {
+			std::fill(std::begin(starttime_notes[channel]), std::end(starttime_notes[channel]), Time(0));
+			std::fill(std::begin(velocity_notes[channel]), std::end(velocity_notes[channel]), uint8_t(0));
+			instruments[channel] = Instrument(0);
+		}
+	}
+
+	void MultiChannelNoteCollector::end_note(Channel channel, NoteNumber note) {
+		Time start = (*this).starttime_notes[value(channel)][value(note)];
+
+		// Like ChannelNoteCollector, a note off for a note that is not sounding still produces a NOTE.
+		note_receiver(NOTE(note,
+			start,
+			((*this).current_time - start),
+			(*this).velocity_notes[value(channel)][value(note)],
+			(*this).instruments[value(channel)]));
+
+		(*this).velocity_notes[value(channel)][value(note)] = 0;
+		(*this).active[value(channel)].reset(value(note));
+	}
+
+	void MultiChannelNoteCollector::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+		(*this).current_time += dt;
+
+		if (velocity == 0) {
+			(*this).end_note(channel, note);
+		}
+		else {
+			if ((*this).active[value(channel)].test(value(note))) {
+				(*this).end_note(channel, note);
+			}
+			(*this).velocity_notes[value(channel)][value(note)] = velocity;
+			(*this).starttime_notes[value(channel)][value(note)] = (*this).current_time;
+			(*this).active[value(channel)].set(value(note));
+		}
+	}
+
+	void MultiChannelNoteCollector::note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+		(*this).current_time += dt;
+		(*this).end_note(channel, note);
+	}
+
+	void MultiChannelNoteCollector::polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::program_change(Duration dt, Channel channel, Instrument program) {
+		(*this).current_time += dt;
+		(*this).instruments[value(channel)] = program;
+	}
+
+	void MultiChannelNoteCollector::channel_pressure(Duration dt, Channel channel, uint8_t pressure) {
+		(*this).current_time += dt;
+	}
+
+	void MultiChannelNoteCollector::pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) {
+		(*this).current_time += dt;
+	}
+
 	std::vector<NOTE> read_notes(std::istream& s) {
+		std::vector<uint8_t> buffer = io::read_all(s);
+		return read_notes(buffer.data(), buffer.size());
+	}
+
+	std::vector<NOTE> read_notes(io::ByteCursor& s) {
 		MTHD mthd;
 		read_mthd(s, &mthd);
 		uint16_t ntracks = mthd.ntracks;
 		std::vector<NOTE> notes;
 		for (int i = 0; i < ntracks; i++) {
-			NoteCollector noteCollector = NoteCollector([&notes](const NOTE& note) { notes.push_back(note); });
-			read_mtrk(s, noteCollector);
+			MultiChannelNoteCollector collector([&notes](const NOTE& note) { notes.push_back(note); });
+			read_mtrk(s, collector);
 		}
 		return notes;
 	}
+
+	std::vector<NOTE> read_notes(const uint8_t* data, size_t size) {
+		io::ByteCursor cursor(data, size);
+		return read_notes(cursor);
+	}
+
+	std::vector<NOTE> read_notes_from_file(const std::string& path) {
+		io::MemoryMappedFile file(path);
+		return read_notes(file.data(), file.size());
+	}
+
+	std::vector<TRACK_LOCATION> locate_tracks(io::ByteCursor& s, const MTHD& mthd) {
+		std::vector<TRACK_LOCATION> tracks;
+		for (int i = 0; i < mthd.ntracks; i++) {
+			size_t offset = s.offset();
+			CHUNK_HEADER header;
+			read_chunk_header(s, &header);
+			s.skip(header.size);
+			tracks.push_back(TRACK_LOCATION{ offset, sizeof(CHUNK_HEADER) + header.size });
+		}
+		return tracks;
+	}
+
+	std::vector<NOTE> read_notes_parallel(const uint8_t* data, size_t size, unsigned threads) {
+		io::ByteCursor cursor(data, size);
+		MTHD mthd;
+		read_mthd(cursor, &mthd);
+
+		// Tracks are located through CHUNK_HEADER.size, the same bytes read_mtrk reads them from, so each can be parsed on its own.
+		std::vector<TRACK_LOCATION> tracks = locate_tracks(cursor, mthd);
+		std::vector<std::vector<NOTE>> track_notes(tracks.size());
+
+		parallel_for(tracks.size(), threads, [data, &tracks, &track_notes](size_t i) {
+			std::vector<NOTE>& notes = track_notes[i];
+			io::ByteCursor track(data + tracks[i].offset, tracks[i].size);
+			MultiChannelNoteCollector collector([&notes](const NOTE& note) { notes.push_back(note); });
+			read_mtrk(track, collector);
+		});
+
+		size_t total = 0;
+		for (const std::vector<NOTE>& notes : track_notes) {
+			total += notes.size();
+		}
+
+		std::vector<NOTE> notes;
+		notes.reserve(total);
+		for (const std::vector<NOTE>& per_track : track_notes) {
+			notes.insert(notes.end(), per_track.begin(), per_track.end());
+		}
+		return notes;
+	}
+
+	std::vector<NOTE> read_notes_from_file_parallel(const std::string& path, unsigned threads) {
+		io::MemoryMappedFile file(path);
+		return read_notes_parallel(file.data(), file.size(), threads);
+	}
 }
\ No newline at end of file
@@ -4,8 +4,14 @@
 #include "io/endianness.h"
 #include <string>
 #include "primitives.h"
+#include "status-table.h"
 #include "io/vli.h"
+#include "io/byte-cursor.h"
 #include <iostream>
+#include <bitset>
+#include <algorithm>
+#include <tuple>
+#include <utility>
 
 namespace midi {
 
@@ -15,6 +21,7 @@ namespace midi {
 	};
 
 	void read_chunk_header(std::istream& s, CHUNK_HEADER* c);
+	void read_chunk_header(io::ByteCursor& s, CHUNK_HEADER* c);
 	std::string header_id(const CHUNK_HEADER c);
 
 #pragma pack(push, 1)
@@ -27,6 +34,7 @@ namespace midi {
 #pragma pack(pop)
 
 	void read_mthd(std::istream& s, MTHD* m);
+	void read_mthd(io::ByteCursor& s, MTHD* m);
 
 	bool is_sysex_event(uint8_t byte);
 	bool is_meta_event(uint8_t byte);
@@ -55,9 +63,224 @@ namespace midi {
 		virtual void program_change(Duration dt, Channel channel, Instrument program) = 0;
 		virtual void channel_pressure(Duration dt, Channel channel, uint8_t pressure) = 0;
 		virtual void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) = 0;
+
+		/// <summary>
+		/// Non-owning variants of meta and sysex. <paramref name="data" /> points into the parsed buffer
+		/// and is only valid during the call. By default the payload is copied and passed to the owning variant.
+		/// </summary>
+		virtual void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size);
+		virtual void sysex(Duration dt, const uint8_t* data, uint64_t data_size);
 	};
 
+	namespace details {
+		// Receivers that only implement the owning meta/sysex variants get a copy of the payload.
+		template<typename RECEIVER>
+		auto deliver_meta(RECEIVER& receiver, Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size, int)
+			-> decltype(receiver.meta(dt, type, data, data_size)) {
+			return receiver.meta(dt, type, data, data_size);
+		}
+
+		template<typename RECEIVER>
+		void deliver_meta(RECEIVER& receiver, Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size, long) {
+			std::unique_ptr<uint8_t[]> payload = std::make_unique<uint8_t[]>(data_size);
+			std::copy(data, data + data_size, payload.get());
+			receiver.meta(dt, type, std::move(payload), data_size);
+		}
+
+		template<typename RECEIVER>
+		auto deliver_sysex(RECEIVER& receiver, Duration dt, const uint8_t* data, uint64_t data_size, int)
+			-> decltype(receiver.sysex(dt, data, data_size)) {
+			return receiver.sysex(dt, data, data_size);
+		}
+
+		template<typename RECEIVER>
+		void deliver_sysex(RECEIVER& receiver, Duration dt, const uint8_t* data, uint64_t data_size, long) {
+			std::unique_ptr<uint8_t[]> payload = std::make_unique<uint8_t[]>(data_size);
+			std::copy(data, data + data_size, payload.get());
+			receiver.sysex(dt, std::move(payload), data_size);
+		}
+	}
+
 	void read_mtrk(std::istream& s, EventReceiver& e);
+	void read_mtrk(io::ByteCursor& s, EventReceiver& e);
+
+	namespace details {
+		/// <summary>
+		/// Error policy of read_mtrk_events: every problem is CHECKed, so the steps always succeed and the
+		/// checks in decode_mtrk_events compile away.
+		/// </summary>
+		class AbortOnParseError final {
+		public:
+			bool read_variable_length_integer(io::ByteCursor& s, uint64_t* result) {
+				*result = io::read_variable_length_integer(s);
+				return true;
+			}
+
+			bool peek(io::ByteCursor& s, uint8_t* result) {
+				*result = s.peek();
+				return true;
+			}
+
+			bool take(io::ByteCursor& s, size_t n, const uint8_t** result) {
+				*result = s.take(n);
+				return true;
+			}
+
+			bool missing_status(const io::ByteCursor&) {
+				CHECK(false) << "Running status without preceding status byte";
+				return false;
+			}
+		};
+
+		/// <summary>
+		/// The MTrk event decoder shared by read_mtrk and try_read_mtrk. Every step that can fail goes through
+		/// <paramref name="policy" />, which either aborts or records the problem and returns false.
+		/// Returns true once End of Track has been read, false as soon as a step fails.
+		/// </summary>
+		template<typename RECEIVER, typename POLICY>
+		bool decode_mtrk_events(io::ByteCursor& s, RECEIVER& event_receiver, POLICY& policy) {
+			bool has_next = true;
+			uint8_t running_identifier = 0;
+
+			while (has_next) {
+				uint64_t delta;
+				uint8_t identifier;
+				if (!policy.read_variable_length_integer(s, &delta) || !policy.peek(s, &identifier)) {
+					return false;
+				}
+
+				Duration duration(delta);
+
+				if (identifier >= 0x80) {
+					s.skip(1);
+					running_identifier = identifier;
+				}
+
+				const STATUS_INFO& status = status_table[running_identifier];
+				if (status.kind == EventKind::DATA) {
+					return policy.missing_status(s);
+				}
+
+				Channel channel(status.channel);
+				const uint8_t* data;
+				if (!policy.take(s, status.data_bytes, &data)) {
+					return false;
+				}
+
+				switch (status.kind) {
+				case EventKind::META: {
+					const uint8_t* type;
+					uint64_t data_size;
+					const uint8_t* payload;
+					if (!policy.take(s, 1, &type) || !policy.read_variable_length_integer(s, &data_size) || !policy.take(s, size_t(data_size), &payload)) {
+						return false;
+					}
+
+					if (*type == 0x2F) {
+						has_next = false;
+					}
+
+					deliver_meta(event_receiver, duration, *type, payload, data_size, 0);
+					break;
+				}
+
+				case EventKind::SYSEX: {
+					uint64_t data_size;
+					const uint8_t* payload;
+					if (!policy.read_variable_length_integer(s, &data_size) || !policy.take(s, size_t(data_size), &payload)) {
+						return false;
+					}
+
+					deliver_sysex(event_receiver, duration, payload, data_size, 0);
+					break;
+				}
+
+				case EventKind::NOTE_OFF:
+					event_receiver.note_off(duration, channel, NoteNumber(data[0]), data[1]);
+					break;
+
+				case EventKind::NOTE_ON:
+					event_receiver.note_on(duration, channel, NoteNumber(data[0]), data[1]);
+					break;
+
+				case EventKind::POLYPHONIC_KEY_PRESSURE:
+					event_receiver.polyphonic_key_pressure(duration, channel, NoteNumber(data[0]), data[1]);
+					break;
+
+				case EventKind::CONTROL_CHANGE:
+					event_receiver.control_change(duration, channel, data[0], data[1]);
+					break;
+
+				case EventKind::PROGRAM_CHANGE:
+					event_receiver.program_change(duration, channel, Instrument(data[0]));
+					break;
+
+				case EventKind::CHANNEL_PRESSURE:
+					event_receiver.channel_pressure(duration, channel, data[0]);
+					break;
+
+				case EventKind::PITCH_WHEEL_CHANGE:
+					event_receiver.pitch_wheel_change(duration, channel, uint16_t(data[0] | (data[1] << 7)));
+					break;
+
+				case EventKind::DATA:
+				case EventKind::UNSUPPORTED:
+					break;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	/// <summary>
+	/// Reads the events of an MTrk chunk, i.e. the CHUNK_HEADER.size bytes after its header, up to End of Track.
+	/// Events running past the end of <paramref name="s" /> fail the bounds checks of the cursor.
+	/// </summary>
+	template<typename RECEIVER>
+	void read_mtrk_events(io::ByteCursor& s, RECEIVER& event_receiver) {
+		details::AbortOnParseError policy;
+		details::decode_mtrk_events(s, event_receiver, policy);
+	}
+
+	/// <summary>
+	/// Reads an MTrk chunk and reports its events to <paramref name="event_receiver" />.
+	/// The chunk is CHUNK_HEADER.size bytes long, as in locate_tracks: its events are read from those bytes only,
+	/// and <paramref name="s" /> is left at the next chunk even if End of Track comes earlier.
+	/// RECEIVER can be any type with the same member functions as EventReceiver. When it is a
+	/// concrete (ideally final) type, the callbacks are bound at compile time and can be inlined.
+	/// </summary>
+	template<typename RECEIVER>
+	void read_mtrk(io::ByteCursor& s, RECEIVER& event_receiver) {
+		CHUNK_HEADER header;
+		read_chunk_header(s, &header);
+
+		io::ByteCursor events = s.sub_cursor(header.size);
+		read_mtrk_events(events, event_receiver);
+	}
+
+	/// <summary>
+	/// Exposes a statically dispatched receiver through the virtual EventReceiver interface.
+	/// </summary>
+	template<typename RECEIVER>
+	class EventReceiverWrapper final : public EventReceiver {
+	public:
+		RECEIVER& receiver;
+
+		EventReceiverWrapper(RECEIVER& r) : receiver(r) { }
+
+		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override { receiver.meta(dt, type, std::move(data), data_size); }
+		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override { receiver.sysex(dt, std::move(data), data_size); }
+		void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) override { details::deliver_meta(receiver, dt, type, data, data_size, 0); }
+		void sysex(Duration dt, const uint8_t* data, uint64_t data_size) override { details::deliver_sysex(receiver, dt, data, data_size, 0); }
+		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override { receiver.note_on(dt, channel, note, velocity); }
+		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override { receiver.note_off(dt, channel, note, velocity); }
+		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override { receiver.polyphonic_key_pressure(dt, channel, note, pressure); }
+		void control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value) override { receiver.control_change(dt, channel, controller, value); }
+		void program_change(Duration dt, Channel channel, Instrument program) override { receiver.program_change(dt, channel, program); }
+		void channel_pressure(Duration dt, Channel channel, uint8_t pressure) override { receiver.channel_pressure(dt, channel, pressure); }
+		void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) override { receiver.pitch_wheel_change(dt, channel, wheel_position); }
+	};
 
 	struct NOTE {
 		NoteNumber note_number;
@@ -99,6 +322,8 @@ namespace midi {
 
 		virtual void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		virtual void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		virtual void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) override;
+		virtual void sysex(Duration dt, const uint8_t* data, uint64_t data_size) override;
 		virtual void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override;
@@ -124,6 +349,8 @@ namespace midi {
 
 		virtual void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		virtual void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		virtual void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) override;
+		virtual void sysex(Duration dt, const uint8_t* data, uint64_t data_size) override;
 		virtual void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override;
@@ -135,7 +362,81 @@ namespace midi {
 
 	std::unique_ptr<uint8_t[]> copy(std::unique_ptr<uint8_t[]>& to_copy, uint64_t data_size);
 
-	class NoteCollector : public EventReceiver {
+	/// <summary>
+	/// Fan-out to a list of receivers that is fixed at compile time.
+	/// Each event turns into one direct call per receiver, in the order the receivers were given;
+	/// there is no virtual dispatch and no reference counting.
+	/// </summary>
+	template<typename... RECEIVERS>
+	class StaticEventMulticaster final {
+	public:
+		StaticEventMulticaster(RECEIVERS&... receivers) : receivers(receivers...) { }
+
+		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+			meta(dt, type, static_cast<const uint8_t*>(data.get()), data_size);
+		}
+
+		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) {
+			sysex(dt, static_cast<const uint8_t*>(data.get()), data_size);
+		}
+
+		void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) {
+			for_each([&](auto& receiver) { details::deliver_meta(receiver, dt, type, data, data_size, 0); });
+		}
+
+		void sysex(Duration dt, const uint8_t* data, uint64_t data_size) {
+			for_each([&](auto& receiver) { details::deliver_sysex(receiver, dt, data, data_size, 0); });
+		}
+
+		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+			for_each([&](auto& receiver) { receiver.note_on(dt, channel, note, velocity); });
+		}
+
+		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) {
+			for_each([&](auto& receiver) { receiver.note_off(dt, channel, note, velocity); });
+		}
+
+		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) {
+			for_each([&](auto& receiver) { receiver.polyphonic_key_pressure(dt, channel, note, pressure); });
+		}
+
+		void control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value) {
+			for_each([&](auto& receiver) { receiver.control_change(dt, channel, controller, value); });
+		}
+
+		void program_change(Duration dt, Channel channel, Instrument program) {
+			for_each([&](auto& receiver) { receiver.program_change(dt, channel, program); });
+		}
+
+		void channel_pressure(Duration dt, Channel channel, uint8_t pressure) {
+			for_each([&](auto& receiver) { receiver.channel_pressure(dt, channel, pressure); });
+		}
+
+		void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) {
+			for_each([&](auto& receiver) { receiver.pitch_wheel_change(dt, channel, wheel_position); });
+		}
+
+	private:
+		std::tuple<RECEIVERS&...> receivers;
+
+		template<typename FUNCTION>
+		void for_each(FUNCTION function) {
+			for_each(function, std::index_sequence_for<RECEIVERS...>());
+		}
+
+		template<typename FUNCTION, size_t... INDICES>
+		void for_each(FUNCTION& function, std::index_sequence<INDICES...>) {
+			int expand[] = { 0, (function(std::get<INDICES>(receivers)), 0)... };
+			(void)expand;
+		}
+	};
+
+	template<typename... RECEIVERS>
+	StaticEventMulticaster<RECEIVERS...> make_static_multicaster(RECEIVERS&... receivers) {
+		return StaticEventMulticaster<RECEIVERS...>(receivers...);
+	}
+
+	class NoteCollector final : public EventReceiver {
 	public:
 		EventMulticaster event_multicaster;
 		std::function<void(const NOTE&)> note_receiver;
@@ -156,6 +457,8 @@ namespace midi {
 
 		virtual void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		virtual void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		virtual void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size) override;
+		virtual void sysex(Duration dt, const uint8_t* data, uint64_t data_size) override;
 		virtual void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		virtual void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override;
@@ -165,5 +468,62 @@ namespace midi {
 		virtual void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position) override;
 	};
 
+	/// <summary>
+	/// Collects notes on all 16 channels from a single 16x128 state table and a single clock.
+	/// Produces the same NOTE stream as NoteCollector, but every event is handled once instead of
+	/// being fanned out to 16 ChannelNoteCollectors. Not an EventReceiver: pass it to the read_mtrk
+	/// template directly, or wrap it in an EventReceiverWrapper.
+	/// </summary>
+	class MultiChannelNoteCollector final {
+	public:
+		MultiChannelNoteCollector(std::function<void(const NOTE&)> note_receiver);
+
+		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size);
+		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size);
+		void meta(Duration dt, uint8_t type, const uint8_t* data, uint64_t data_size);
+		void sysex(Duration dt, const uint8_t* data, uint64_t data_size);
+		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity);
+		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity);
+		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure);
+		void control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value);
+		void program_change(Duration dt, Channel channel, Instrument program);
+		void channel_pressure(Duration dt, Channel channel, uint8_t pressure);
+		void pitch_wheel_change(Duration dt, Channel channel, uint16_t wheel_position);
+
+		/// <summary>
+		/// Notes that are currently sounding on the given channel, indexed by note number.
+		/// </summary>
+		const std::bitset<128>& active_notes(Channel channel) const {
+			return (*this).active[value(channel)];
+		}
+
+	private:
+		std::function<void(const NOTE&)> note_receiver;
+		Time current_time = Time(0);
+		std::bitset<128> active[16];
+		Time starttime_notes[16][128];
+		uint8_t velocity_notes[16][128];
+		Instrument instruments[16];
+
+		void end_note(Channel channel, NoteNumber note);
+	};
+
 	std::vector<NOTE> read_notes(std::istream& s);
+	std::vector<NOTE> read_notes(io::ByteCursor& s);
+	std::vector<NOTE> read_notes(const uint8_t* data, size_t size);
+	std::vector<NOTE> read_notes_from_file(const std::string& path);
+
+	struct TRACK_LOCATION {
+		size_t offset;
+		size_t size;
+	};
+
+	std::vector<TRACK_LOCATION> locate_tracks(io::ByteCursor& s, const MTHD& mthd);
+
+	/// <summary>
+	/// Gives the same notes in the same order as read_notes, but parses the tracks at the same time on
+	/// <paramref name="threads" /> workers (0 meaning one per core) of the shared ThreadPool.
+	/// </summary>
+	std::vector<NOTE> read_notes_parallel(const uint8_t* data, size_t size, unsigned threads = 0);
+	std::vector<NOTE> read_notes_from_file_parallel(const std::string& path, unsigned threads = 0);
 }
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "note-cache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace midi {
+
+	namespace {
+		const char NOTE_CACHE_ID[8] = { 'M', 'I', 'D', 'I', 'N', 'O', 'T', 'E' };
+
+		bool stat_file(const std::string& path, uint64_t* size, int64_t* mtime) {
+#ifdef _WIN32
+			struct _stat64 info;
+			if (_stat64(path.c_str(), &info) != 0) {
+				return false;
+			}
+#else
+			struct stat info;
+			if (stat(path.c_str(), &info) != 0) {
+				return false;
+			}
+#endif
+			*size = uint64_t(info.st_size);
+			*mtime = int64_t(info.st_mtime);
+			return true;
+		}
+
+		SOURCE_KEY source_key(const std::string& path, const io::MemoryMappedFile& file) {
+			SOURCE_KEY key;
+			CHECK(stat_file(path, &key.size, &key.mtime)) << "Could not stat " << path;
+			key.hash = hash_bytes(file.data(), file.size());
+			return key;
+		}
+
+		template<typename T>
+		void append(std::vector<uint8_t>& buffer, const T& record) {
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		void write_bytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+			std::ofstream out(path, std::ios::binary | std::ios::trunc);
+			CHECK(out) << "Could not open " << path;
+			out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+			CHECK(out) << "Could not write " << path;
+		}
+	}
+
+	bool operator == (const SOURCE_KEY& key0, const SOURCE_KEY& key1) {
+		return key0.size == key1.size && key0.mtime == key1.mtime && key0.hash == key1.hash;
+	}
+
+	bool operator != (const SOURCE_KEY& key0, const SOURCE_KEY& key1) {
+		return !(key0 == key1);
+	}
+
+	NOTE to_note(const CACHED_NOTE& note) {
+		return NOTE(NoteNumber(note.note_number), Time(note.start), Duration(note.duration), note.velocity, Instrument(note.instrument));
+	}
+
+	// 64-bit FNV-1a
+	uint64_t hash_bytes(const uint8_t* data, size_t size) {
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		for (size_t i = 0; i != size; i++) {
+			hash ^= data[i];
+			hash *= 0x100000001B3ULL;
+		}
+		return hash;
+	}
+
+	SOURCE_KEY source_key(const std::string& path) {
+		io::MemoryMappedFile file(path);
+		return source_key(path, file);
+	}
+
+	std::vector<uint8_t> build_note_cache(const uint8_t* data, size_t size, const SOURCE_KEY& source) {
+		io::ByteCursor cursor(data, size);
+		MTHD mthd;
+		read_mthd(cursor, &mthd);
+
+		std::vector<CACHED_TRACK> tracks;
+		std::vector<CACHED_NOTE> notes;
+		for (int i = 0; i < mthd.ntracks; i++) {
+			CACHED_TRACK track = {};
+			track.first_note = notes.size();
+			track.lowest_note = 127;
+
+			MultiChannelNoteCollector collector([&notes, &track](const NOTE& note) {
+				CACHED_NOTE cached = {};
+				cached.start = value(note.start);
+				cached.duration = value(note.duration);
+				cached.note_number = value(note.note_number);
+				cached.velocity = note.velocity;
+				cached.instrument = value(note.instrument);
+				notes.push_back(cached);
+
+				track.end = std::max<uint64_t>(track.end, cached.start + cached.duration);
+				track.lowest_note = std::min(track.lowest_note, cached.note_number);
+				track.highest_note = std::max(track.highest_note, cached.note_number);
+			});
+			read_mtrk(cursor, collector);
+
+			track.note_count = notes.size() - track.first_note;
+			tracks.push_back(track);
+		}
+
+		NOTE_CACHE_HEADER header = {};
+		std::memcpy(header.id, NOTE_CACHE_ID, sizeof(NOTE_CACHE_ID));
+		header.version = NOTE_CACHE_VERSION;
+		header.header_size = sizeof(NOTE_CACHE_HEADER);
+		header.source = source;
+		header.type = mthd.type;
+		header.ntracks = mthd.ntracks;
+		header.division = mthd.division;
+		header.tracks_offset = sizeof(NOTE_CACHE_HEADER);
+		header.notes_offset = header.tracks_offset + tracks.size() * sizeof(CACHED_TRACK);
+		header.note_count = notes.size();
+
+		std::vector<uint8_t> buffer;
+		buffer.reserve(size_t(header.notes_offset + notes.size() * sizeof(CACHED_NOTE)));
+		append(buffer, header);
+		for (const CACHED_TRACK& track : tracks) {
+			append(buffer, track);
+		}
+		for (const CACHED_NOTE& note : notes) {
+			append(buffer, note);
+		}
+		return buffer;
+	}
+
+	bool is_note_cache(const uint8_t* data, size_t size) {
+		if (size < sizeof(NOTE_CACHE_HEADER)) {
+			return false;
+		}
+
+		const NOTE_CACHE_HEADER& header = *reinterpret_cast<const NOTE_CACHE_HEADER*>(data);
+		if (std::memcmp(header.id, NOTE_CACHE_ID, sizeof(NOTE_CACHE_ID)) != 0
+			|| header.version != NOTE_CACHE_VERSION
+			|| header.header_size != sizeof(NOTE_CACHE_HEADER)
+			|| header.tracks_offset != sizeof(NOTE_CACHE_HEADER)) {
+			return false;
+		}
+
+		// The track table has to fit before the notes are sized, or size - notes_offset would wrap around.
+		// The notes must fill the rest of the file exactly; dividing instead of multiplying cannot overflow
+		uint64_t notes_offset = header.tracks_offset + uint64_t(header.ntracks) * sizeof(CACHED_TRACK);
+		if (header.notes_offset != notes_offset || notes_offset > size) {
+			return false;
+		}
+		uint64_t notes_size = size - notes_offset;
+		if (notes_size % sizeof(CACHED_NOTE) != 0 || header.note_count != notes_size / sizeof(CACHED_NOTE)) {
+			return false;
+		}
+
+		const CACHED_TRACK* tracks = reinterpret_cast<const CACHED_TRACK*>(data + header.tracks_offset);
+		uint64_t next_note = 0;
+		for (size_t i = 0; i != header.ntracks; i++) {
+			if (tracks[i].first_note != next_note || tracks[i].note_count > header.note_count - next_note) {
+				return false;
+			}
+			next_note += tracks[i].note_count;
+		}
+		return next_note == header.note_count;
+	}
+
+	NoteCache::NoteCache(const uint8_t* data, size_t size) {
+		CHECK(is_note_cache(data, size)) << "Not a valid note cache";
+
+		(*this).m_header = reinterpret_cast<const NOTE_CACHE_HEADER*>(data);
+		(*this).m_tracks = reinterpret_cast<const CACHED_TRACK*>(data + (*this).m_header->tracks_offset);
+		(*this).m_notes = reinterpret_cast<const CACHED_NOTE*>(data + (*this).m_header->notes_offset);
+	}
+
+	std::vector<NOTE> NoteCache::to_notes() const {
+		std::vector<NOTE> notes;
+		notes.reserve((*this).note_count());
+		for (size_t i = 0; i != (*this).note_count(); i++) {
+			notes.push_back(to_note((*this).m_notes[i]));
+		}
+		return notes;
+	}
+
+	MappedNoteCache::MappedNoteCache(const std::string& path)
+		: MappedNoteCache(std::make_unique<io::MemoryMappedFile>(path)) { }
+
+	MappedNoteCache::MappedNoteCache(std::unique_ptr<io::MemoryMappedFile> file)
+		: m_file(std::move(file)), m_cache(m_file->data(), m_file->size()) { }
+
+	void write_note_cache(const std::string& midi_path, const std::string& cache_path) {
+		io::MemoryMappedFile midi(midi_path);
+		write_bytes(cache_path, build_note_cache(midi.data(), midi.size(), source_key(midi_path, midi)));
+	}
+
+	std::unique_ptr<MappedNoteCache> load_or_create_note_cache(const std::string& midi_path, const std::string& cache_path) {
+		{
+			io::MemoryMappedFile midi(midi_path);
+			SOURCE_KEY key = source_key(midi_path, midi);
+
+			uint64_t cache_size;
+			int64_t cache_mtime;
+			if (stat_file(cache_path, &cache_size, &cache_mtime)) {
+				std::unique_ptr<io::MemoryMappedFile> cache = std::make_unique<io::MemoryMappedFile>(cache_path);
+				if (is_note_cache(cache->data(), cache->size())
+					&& reinterpret_cast<const NOTE_CACHE_HEADER*>(cache->data())->source == key) {
+					return std::make_unique<MappedNoteCache>(std::move(cache));
+				}
+			}
+
+			// The stale mapping has been released, so the file can be overwritten (also on Windows).
+			write_bytes(cache_path, build_note_cache(midi.data(), midi.size(), key));
+		}
+
+		return std::make_unique<MappedNoteCache>(cache_path);
+	}
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "midi.h"
+#include "io/memory-mapped-file.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace midi {
+
+	const uint32_t NOTE_CACHE_VERSION = 1;
+
+	/// <summary>
+	/// Identifies the MIDI file a cache was built from. A cache is only reused when all three fields match.
+	/// </summary>
+	struct SOURCE_KEY {
+		uint64_t size;
+		int64_t mtime;
+		uint64_t hash;
+	};
+
+	bool operator == (const SOURCE_KEY& key0, const SOURCE_KEY& key1);
+	bool operator != (const SOURCE_KEY& key0, const SOURCE_KEY& key1);
+
+	// On-disk layout: the header, then NOTE_CACHE_HEADER::ntracks CACHED_TRACKs, then note_count CACHED_NOTEs.
+	// Records are written in the byte order of the host and every record is a multiple of 8 bytes, so a mapping
+	// of the file can be used as is. A cache written on a host with the other byte order fails the version check
+	// (is_note_cache) and is rebuilt.
+#pragma pack(push, 1)
+	struct NOTE_CACHE_HEADER {
+		char id[8];
+		uint32_t version;
+		uint32_t header_size;
+		SOURCE_KEY source;
+		uint16_t type;
+		uint16_t ntracks;
+		uint16_t division;
+		uint16_t reserved;
+		uint64_t tracks_offset;
+		uint64_t notes_offset;
+		uint64_t note_count;
+	};
+
+	struct CACHED_TRACK {
+		uint64_t first_note;
+		uint64_t note_count;
+		uint64_t end;
+		uint8_t lowest_note;
+		uint8_t highest_note;
+		uint8_t reserved[6];
+	};
+
+	struct CACHED_NOTE {
+		uint64_t start;
+		uint64_t duration;
+		uint8_t note_number;
+		uint8_t velocity;
+		uint8_t instrument;
+		uint8_t reserved[5];
+	};
+#pragma pack(pop)
+
+	NOTE to_note(const CACHED_NOTE& note);
+
+	uint64_t hash_bytes(const uint8_t* data, size_t size);
+	SOURCE_KEY source_key(const std::string& path);
+
+	/// <summary>
+	/// Parses a complete MIDI file and returns the bytes of its note cache.
+	/// Notes are stored in the same order as read_notes returns them.
+	/// </summary>
+	std::vector<uint8_t> build_note_cache(const uint8_t* data, size_t size, const SOURCE_KEY& source);
+
+	/// <summary>
+	/// Checks the id, version and bounds of a note cache. Does not compare the source key.
+	/// </summary>
+	bool is_note_cache(const uint8_t* data, size_t size);
+
+	/// <summary>
+	/// Non-owning view of a note cache. Accessors point straight into <paramref name="data" />.
+	/// </summary>
+	class NoteCache final {
+	public:
+		NoteCache(const uint8_t* data, size_t size);
+
+		const NOTE_CACHE_HEADER& header() const {
+			return *(*this).m_header;
+		}
+
+		size_t track_count() const {
+			return (*this).m_header->ntracks;
+		}
+
+		const CACHED_TRACK& track(size_t index) const {
+			return (*this).m_tracks[index];
+		}
+
+		size_t note_count() const {
+			return size_t((*this).m_header->note_count);
+		}
+
+		const CACHED_NOTE* notes() const {
+			return (*this).m_notes;
+		}
+
+		const CACHED_NOTE* notes(size_t track) const {
+			return (*this).m_notes + (*this).m_tracks[track].first_note;
+		}
+
+		/// <summary>
+		/// Converts every record to a NOTE, for code that takes a std::vector&lt;NOTE&gt;. This is a copy, but no parsing:
+		/// NOTE is made of tagged types with a different layout, so the records cannot be used as NOTEs in place.
+		/// Code that only needs some fields can read notes() directly instead.
+		/// </summary>
+		std::vector<NOTE> to_notes() const;
+
+	private:
+		const NOTE_CACHE_HEADER* m_header;
+		const CACHED_TRACK* m_tracks;
+		const CACHED_NOTE* m_notes;
+	};
+
+	/// <summary>
+	/// A note cache file mapped into memory. The view stays valid as long as the object.
+	/// </summary>
+	class MappedNoteCache final {
+	public:
+		explicit MappedNoteCache(const std::string& path);
+		explicit MappedNoteCache(std::unique_ptr<io::MemoryMappedFile> file);
+
+		const NoteCache& cache() const {
+			return (*this).m_cache;
+		}
+
+	private:
+		std::unique_ptr<io::MemoryMappedFile> m_file;
+		NoteCache m_cache;
+	};
+
+	void write_note_cache(const std::string& midi_path, const std::string& cache_path);
+
+	/// <summary>
+	/// Maps the cache at <paramref name="cache_path" /> if it was built from the current contents of
+	/// <paramref name="midi_path" />. Otherwise (re)builds the cache first.
+	/// </summary>
+	std::unique_ptr<MappedNoteCache> load_or_create_note_cache(const std::string& midi_path, const std::string& cache_path);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+
+namespace midi {
+
+	enum class EventKind : uint8_t {
+		DATA,
+		NOTE_OFF,
+		NOTE_ON,
+		POLYPHONIC_KEY_PRESSURE,
+		CONTROL_CHANGE,
+		PROGRAM_CHANGE,
+		CHANNEL_PRESSURE,
+		PITCH_WHEEL_CHANGE,
+		SYSEX,
+		META,
+		UNSUPPORTED
+	};
+
+	/// <summary>
+	/// Everything read_mtrk needs to know about a status byte.
+	/// data_bytes is only meaningful for MIDI events; meta and sysex events carry a length prefix.
+	/// </summary>
+	struct STATUS_INFO {
+		EventKind kind;
+		uint8_t data_bytes;
+		uint8_t channel;
+	};
+
+	constexpr STATUS_INFO decode_status_byte(uint8_t status) {
+		if (status < 0x80) {
+			return STATUS_INFO{ EventKind::DATA, 0, 0 };
+		}
+
+		if (status == 0xFF) {
+			return STATUS_INFO{ EventKind::META, 0, 0 };
+		}
+
+		if (status == 0xF0 || status == 0xF7) {
+			return STATUS_INFO{ EventKind::SYSEX, 0, 0 };
+		}
+
+		uint8_t channel = status & 0x0F;
+
+		switch (status >> 4) {
+		case 0x08: return STATUS_INFO{ EventKind::NOTE_OFF, 2, channel };
+		case 0x09: return STATUS_INFO{ EventKind::NOTE_ON, 2, channel };
+		case 0x0A: return STATUS_INFO{ EventKind::POLYPHONIC_KEY_PRESSURE, 2, channel };
+		case 0x0B: return STATUS_INFO{ EventKind::CONTROL_CHANGE, 2, channel };
+		case 0x0C: return STATUS_INFO{ EventKind::PROGRAM_CHANGE, 1, channel };
+		case 0x0D: return STATUS_INFO{ EventKind::CHANNEL_PRESSURE, 1, channel };
+		case 0x0E: return STATUS_INFO{ EventKind::PITCH_WHEEL_CHANGE, 2, channel };
+		default: return STATUS_INFO{ EventKind::UNSUPPORTED, 0, 0 };
+		}
+	}
+
+	struct STATUS_TABLE {
+		STATUS_INFO entries[256];
+
+		constexpr const STATUS_INFO& operator [](uint8_t status) const {
+			return entries[status];
+		}
+	};
+
+	constexpr STATUS_TABLE build_status_table() {
+		STATUS_TABLE table{};
+		for (int status = 0; status != 256; status++) {
+			table.entries[status] = decode_status_byte(uint8_t(status));
+		}
+		return table;
+	}
+
+	/// <summary>
+	/// Decoded form of all 256 possible status bytes, computed at compile time.
+	/// </summary>
+	constexpr STATUS_TABLE status_table = build_status_table();
+
+	static_assert(status_table[0x93].kind == EventKind::NOTE_ON && status_table[0x93].channel == 3, "status table is broken");
+	static_assert(status_table[0xC5].data_bytes == 1, "status table is broken");
+}
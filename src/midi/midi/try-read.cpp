@@ -0,0 +1,73 @@
+#include "try-read.h"
+#include "io/memory-mapped-file.h"
+
+namespace midi {
+
+	std::ostream& operator << (std::ostream& ostream, ParseError error) {
+		switch (error) {
+		case ParseError::NONE:
+			return ostream << "no error";
+		case ParseError::CANNOT_OPEN:
+			return ostream << "cannot open file";
+		case ParseError::UNEXPECTED_END:
+			return ostream << "unexpected end of data";
+		case ParseError::BAD_CHUNK_ID:
+			return ostream << "bad chunk id";
+		case ParseError::BAD_VARIABLE_LENGTH_INTEGER:
+			return ostream << "variable-length integer longer than 4 bytes";
+		case ParseError::MISSING_STATUS:
+			return ostream << "running status without preceding status byte";
+		}
+		return ostream << "unknown error";
+	}
+
+	PARSE_RESULT try_read_chunk_header(io::ByteCursor& s, CHUNK_HEADER* c) {
+		const uint8_t* bytes;
+		if (!s.try_take(sizeof(CHUNK_HEADER), &bytes)) {
+			return details::parse_failure(ParseError::UNEXPECTED_END, s);
+		}
+
+		std::memcpy(c, bytes, sizeof(CHUNK_HEADER));
+		io::switch_endianness(&((*c).size));
+		return PARSE_RESULT{ ParseError::NONE, s.offset() };
+	}
+
+	PARSE_RESULT try_read_mthd(io::ByteCursor& s, MTHD* m) {
+		size_t chunk_offset = s.offset();
+		const uint8_t* bytes;
+		if (!s.try_take(sizeof(MTHD), &bytes)) {
+			return details::parse_failure(ParseError::UNEXPECTED_END, s);
+		}
+
+		std::memcpy(m, bytes, sizeof(MTHD));
+		if (std::memcmp((*m).header.id, "MThd", sizeof((*m).header.id)) != 0) {
+			return PARSE_RESULT{ ParseError::BAD_CHUNK_ID, chunk_offset };
+		}
+
+		io::switch_endianness(&(((*m).header).size));
+		io::switch_endianness(&((*m).type));
+		io::switch_endianness(&((*m).ntracks));
+		io::switch_endianness(&((*m).division));
+		return PARSE_RESULT{ ParseError::NONE, s.offset() };
+	}
+
+	PARSE_RESULT try_read_notes(const uint8_t* data, size_t size, std::vector<NOTE>* notes) {
+		io::ByteCursor cursor(data, size);
+		MTHD mthd;
+		PARSE_RESULT result = try_read_mthd(cursor, &mthd);
+
+		for (int i = 0; result.ok() && i < mthd.ntracks; i++) {
+			MultiChannelNoteCollector collector([notes](const NOTE& note) { notes->push_back(note); });
+			result = try_read_mtrk(cursor, collector);
+		}
+		return result;
+	}
+
+	PARSE_RESULT try_read_notes_from_file(const std::string& path, std::vector<NOTE>* notes) {
+		std::unique_ptr<io::MemoryMappedFile> file = io::MemoryMappedFile::try_open(path);
+		if (file == nullptr) {
+			return PARSE_RESULT{ ParseError::CANNOT_OPEN, 0 };
+		}
+		return try_read_notes(file->data(), file->size(), notes);
+	}
+}
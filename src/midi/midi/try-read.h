@@ -0,0 +1,154 @@
+#pragma once
+#include "midi.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace midi {
+
+	enum class ParseError : uint8_t {
+		NONE,
+		CANNOT_OPEN,
+		UNEXPECTED_END,
+		BAD_CHUNK_ID,
+		BAD_VARIABLE_LENGTH_INTEGER,
+		MISSING_STATUS
+	};
+
+	std::ostream& operator << (std::ostream& ostream, ParseError error);
+
+	/// <summary>
+	/// Outcome of a non-aborting read. <paramref name="offset" /> is the position in the buffer at which
+	/// the problem was found (0 for CANNOT_OPEN).
+	/// </summary>
+	struct PARSE_RESULT {
+		ParseError error;
+		size_t offset;
+
+		bool ok() const {
+			return (*this).error == ParseError::NONE;
+		}
+	};
+
+	namespace details {
+		inline PARSE_RESULT parse_failure(ParseError error, const io::ByteCursor& s) {
+			return PARSE_RESULT{ error, s.offset() };
+		}
+
+		inline ParseError try_read_variable_length_integer(io::ByteCursor& s, uint64_t* result) {
+			uint32_t value;
+			size_t size = io::decode_variable_length_integer(s.position(), s.remaining(), &value);
+			const uint8_t* bytes;
+
+			if (size == 0) {
+				// Fewer than 4 bytes left, all with the continuation bit set, means the data ends mid-integer
+				return s.remaining() < io::MAX_VARIABLE_LENGTH_INTEGER_SIZE ? ParseError::UNEXPECTED_END : ParseError::BAD_VARIABLE_LENGTH_INTEGER;
+			}
+
+			s.try_take(size, &bytes);
+			*result = value;
+			return ParseError::NONE;
+		}
+	}
+
+	PARSE_RESULT try_read_chunk_header(io::ByteCursor& s, CHUNK_HEADER* c);
+	PARSE_RESULT try_read_mthd(io::ByteCursor& s, MTHD* m);
+
+	namespace details {
+		/// <summary>
+		/// Error policy of try_read_mtrk: the first problem is recorded with its offset and stops decoding.
+		/// </summary>
+		class ReportParseError final {
+		public:
+			PARSE_RESULT result = PARSE_RESULT{ ParseError::NONE, 0 };
+
+			bool read_variable_length_integer(io::ByteCursor& s, uint64_t* value) {
+				ParseError error = try_read_variable_length_integer(s, value);
+				return error == ParseError::NONE || fail(error, s);
+			}
+
+			bool peek(io::ByteCursor& s, uint8_t* value) {
+				if (s.at_end()) {
+					return fail(ParseError::UNEXPECTED_END, s);
+				}
+				*value = *s.position();
+				return true;
+			}
+
+			bool take(io::ByteCursor& s, size_t n, const uint8_t** value) {
+				return s.try_take(n, value) || fail(ParseError::UNEXPECTED_END, s);
+			}
+
+			bool missing_status(const io::ByteCursor& s) {
+				return fail(ParseError::MISSING_STATUS, s);
+			}
+
+		private:
+			bool fail(ParseError error, const io::ByteCursor& s) {
+				(*this).result = parse_failure(error, s);
+				return false;
+			}
+		};
+
+		/// <summary>
+		/// Reads events up to End of Track. <paramref name="s" /> holds the bytes of one chunk, so offsets
+		/// in the result are relative to the start of its events.
+		/// </summary>
+		template<typename RECEIVER>
+		PARSE_RESULT try_read_mtrk_events(io::ByteCursor& s, RECEIVER& event_receiver) {
+			ReportParseError policy;
+
+			if (!decode_mtrk_events(s, event_receiver, policy)) {
+				return policy.result;
+			}
+			return PARSE_RESULT{ ParseError::NONE, s.offset() };
+		}
+	}
+
+	/// <summary>
+	/// Non-aborting counterpart of read_mtrk. Instead of CHECKing, it stops at the first problem and
+	/// returns where it was found; events before that point have already been reported.
+	/// Also checks that the chunk is an MTrk chunk. As in read_mtrk, events are read from the
+	/// CHUNK_HEADER.size bytes of the chunk only, and a chunk that is longer than the data left fails
+	/// with UNEXPECTED_END once the events that are there have been read.
+	/// </summary>
+	template<typename RECEIVER>
+	PARSE_RESULT try_read_mtrk(io::ByteCursor& s, RECEIVER& event_receiver) {
+		size_t chunk_offset = s.offset();
+		CHUNK_HEADER header;
+		PARSE_RESULT result = try_read_chunk_header(s, &header);
+
+		if (!result.ok()) {
+			return result;
+		}
+		if (std::memcmp(header.id, "MTrk", sizeof(header.id)) != 0) {
+			return PARSE_RESULT{ ParseError::BAD_CHUNK_ID, chunk_offset };
+		}
+
+		size_t events_offset = s.offset();
+		io::ByteCursor events(s.position(), std::min(size_t(header.size), s.remaining()));
+		result = details::try_read_mtrk_events(events, event_receiver);
+		result.offset += events_offset;
+
+		if (!result.ok()) {
+			return result;
+		}
+
+		const uint8_t* chunk;
+		if (!s.try_take(header.size, &chunk)) {
+			s.try_take(s.remaining(), &chunk);
+			return details::parse_failure(ParseError::UNEXPECTED_END, s);
+		}
+		return PARSE_RESULT{ ParseError::NONE, s.offset() };
+	}
+
+	/// <summary>
+	/// Non-aborting counterparts of read_notes and read_notes_from_file, meant for batch jobs over
+	/// many (possibly damaged) files. On failure, <paramref name="notes" /> holds the notes that were
+	/// completed before the problem was found.
+	/// </summary>
+	PARSE_RESULT try_read_notes(const uint8_t* data, size_t size, std::vector<NOTE>* notes);
+	PARSE_RESULT try_read_notes_from_file(const std::string& path, std::vector<NOTE>* notes);
+}
@@ -0,0 +1,99 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/read.h"
+#include "io/vli.h"
+#include "Catch.h"
+
+
+TEST_CASE("ByteCursor, reading uint8_t advances by one byte")
+{
+    const uint8_t buffer[] = { 1, 2, 3 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+
+    CATCH_CHECK(io::read<uint8_t>(cursor) == 1);
+    CATCH_CHECK(io::read<uint8_t>(cursor) == 2);
+    CATCH_CHECK(cursor.offset() == 2);
+    CATCH_CHECK(cursor.remaining() == 1);
+}
+
+TEST_CASE("ByteCursor, reading uint32_t")
+{
+    const uint8_t buffer[] = { 0x78, 0x56, 0x34, 0x12 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+
+    CATCH_CHECK(io::read<uint32_t>(cursor) == 0x12345678);
+    CATCH_CHECK(cursor.at_end());
+}
+
+TEST_CASE("ByteCursor, peek does not consume")
+{
+    const uint8_t buffer[] = { 5, 6 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+
+    CATCH_CHECK(cursor.peek() == 5);
+    CATCH_CHECK(cursor.peek() == 5);
+    CATCH_CHECK(cursor.offset() == 0);
+}
+
+TEST_CASE("ByteCursor, take returns pointer into buffer without copying")
+{
+    const uint8_t buffer[] = { 1, 2, 3, 4 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+    cursor.skip(1);
+
+    const uint8_t* taken = cursor.take(2);
+
+    CATCH_CHECK(taken == buffer + 1);
+    CATCH_CHECK(cursor.offset() == 3);
+}
+
+TEST_CASE("ByteCursor, sub_cursor is restricted to its range")
+{
+    const uint8_t buffer[] = { 1, 2, 3, 4, 5 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+    cursor.skip(1);
+
+    io::ByteCursor sub = cursor.sub_cursor(3);
+
+    CATCH_CHECK(sub.remaining() == 3);
+    CATCH_CHECK(io::read<uint8_t>(sub) == 2);
+    CATCH_CHECK(cursor.offset() == 4);
+    CATCH_CHECK(io::read<uint8_t>(cursor) == 5);
+}
+
+TEST_CASE("ByteCursor, read_array")
+{
+    const uint8_t buffer[] = { 7, 8, 9 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+
+    auto array = io::read_array<uint8_t>(cursor, 3);
+
+    CATCH_CHECK(array[0] == 7);
+    CATCH_CHECK(array[1] == 8);
+    CATCH_CHECK(array[2] == 9);
+}
+
+TEST_CASE("ByteCursor, reading variable sized integer from { 0x81, 0x80, 0x00, 0x05 }")
+{
+    const uint8_t buffer[] = { 0x81, 0x80, 0x00, 0x05 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+
+    CATCH_CHECK(io::read_variable_length_integer(cursor) == (1 << 14));
+    CATCH_CHECK(io::read_variable_length_integer(cursor) == 5);
+}
+
+TEST_CASE("ByteCursor, try_take fails without moving when too few bytes are left")
+{
+    const uint8_t buffer[] = { 1, 2, 3 };
+    io::ByteCursor cursor(buffer, sizeof(buffer));
+    const uint8_t* taken = nullptr;
+
+    CATCH_CHECK(cursor.try_take(2, &taken));
+    CATCH_CHECK(taken == buffer);
+    CATCH_CHECK(!cursor.try_take(2, &taken));
+    CATCH_CHECK(cursor.offset() == 2);
+}
+
+#endif
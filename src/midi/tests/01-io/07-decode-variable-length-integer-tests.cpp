@@ -0,0 +1,148 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/vli.h"
+#include "Catch.h"
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    void check_decode(const std::vector<uint8_t>& buffer, uint32_t expected, size_t expected_size)
+    {
+        uint32_t actual = 0;
+        size_t size = io::decode_variable_length_integer(buffer.data(), buffer.size(), &actual);
+
+        CATCH_CHECK(size == expected_size);
+        CATCH_CHECK(actual == expected);
+    }
+
+    void encode(uint32_t value, std::vector<uint8_t>& out)
+    {
+        uint8_t bytes[4];
+        size_t size = 0;
+
+        do
+        {
+            bytes[size++] = value & 0x7F;
+            value >>= 7;
+        } while (value != 0);
+
+        while (size != 0)
+        {
+            --size;
+            out.push_back(bytes[size] | (size != 0 ? 0x80 : 0x00));
+        }
+    }
+}
+
+TEST_CASE("Decoding variable sized integer from { 0x00 }")
+{
+    check_decode({ 0x00 }, 0, 1);
+}
+
+TEST_CASE("Decoding variable sized integer from { 0x7F, 0x7F }")
+{
+    check_decode({ 0x7F, 0x7F }, 0x7F, 1);
+}
+
+TEST_CASE("Decoding variable sized integer from { 0x81, 0x00 }")
+{
+    check_decode({ 0x81, 0x00 }, 1 << 7, 2);
+}
+
+TEST_CASE("Decoding variable sized integer from { 0xFF, 0x7F, 0x05 }")
+{
+    check_decode({ 0xFF, 0x7F, 0x05 }, 0x3FFF, 2);
+}
+
+TEST_CASE("Decoding variable sized integer from { 0x81, 0x80, 0x00 }")
+{
+    check_decode({ 0x81, 0x80, 0x00 }, 1 << 14, 3);
+}
+
+TEST_CASE("Decoding variable sized integer from { 0xFF, 0xFF, 0xFF, 0x7F }")
+{
+    check_decode({ 0xFF, 0xFF, 0xFF, 0x7F }, 0x0FFFFFFF, 4);
+}
+
+TEST_CASE("Decoding variable sized integer longer than 4 bytes fails")
+{
+    std::vector<uint8_t> buffer = { 0xFF, 0x80, 0x80, 0x8C, 0x02 };
+    uint32_t actual;
+
+    CATCH_CHECK(io::decode_variable_length_integer(buffer.data(), buffer.size(), &actual) == 0);
+}
+
+TEST_CASE("Decoding truncated variable sized integer fails")
+{
+    std::vector<uint8_t> buffer = { 0x81, 0x80 };
+    uint32_t actual;
+
+    CATCH_CHECK(io::decode_variable_length_integer(buffer.data(), buffer.size(), &actual) == 0);
+    CATCH_CHECK(io::decode_variable_length_integer(buffer.data(), 1, &actual) == 0);
+    CATCH_CHECK(io::decode_variable_length_integer(buffer.data(), 0, &actual) == 0);
+}
+
+TEST_CASE("Decoding a run of variable sized integers")
+{
+    std::vector<uint8_t> buffer = { 0x00, 0x81, 0x00, 0x7F, 0x81, 0x80, 0x00, 0x05 };
+    uint32_t actual[5] = { 0 };
+    size_t consumed = 0;
+
+    CATCH_CHECK(io::decode_variable_length_integers(buffer.data(), buffer.size(), actual, 5, &consumed) == 5);
+    CATCH_CHECK(consumed == buffer.size());
+    CATCH_CHECK(actual[0] == 0);
+    CATCH_CHECK(actual[1] == 1 << 7);
+    CATCH_CHECK(actual[2] == 0x7F);
+    CATCH_CHECK(actual[3] == 1 << 14);
+    CATCH_CHECK(actual[4] == 5);
+}
+
+TEST_CASE("Decoding a run of variable sized integers stops at count")
+{
+    std::vector<uint8_t> buffer = { 0x01, 0x02, 0x03 };
+    uint32_t actual[2] = { 0 };
+    size_t consumed = 0;
+
+    CATCH_CHECK(io::decode_variable_length_integers(buffer.data(), buffer.size(), actual, 2, &consumed) == 2);
+    CATCH_CHECK(consumed == 2);
+}
+
+TEST_CASE("Decoding a run of variable sized integers stops at a truncated integer")
+{
+    std::vector<uint8_t> buffer = { 0x01, 0x81, 0x00, 0x81 };
+    uint32_t actual[3] = { 0 };
+    size_t consumed = 0;
+
+    CATCH_CHECK(io::decode_variable_length_integers(buffer.data(), buffer.size(), actual, 3, &consumed) == 2);
+    CATCH_CHECK(consumed == 3);
+}
+
+TEST_CASE("Buffer decoder agrees with the stream decoder", "[vli]")
+{
+    const size_t count = 10000;
+    std::mt19937 random(42);
+    std::vector<uint8_t> buffer;
+
+    // Integers of every length from 1 to 4 bytes
+    for (size_t i = 0; i != count; ++i)
+    {
+        encode(random() % (1u << (7 * (1 + i % 4))), buffer);
+    }
+
+    std::stringstream ss(std::string(buffer.begin(), buffer.end()));
+    io::ByteCursor cursor(buffer.data(), buffer.size());
+
+    for (size_t i = 0; i != count; ++i)
+    {
+        CATCH_REQUIRE(io::read_variable_length_integer(cursor) == io::read_variable_length_integer(ss));
+    }
+    CATCH_CHECK(cursor.at_end());
+}
+
+#endif
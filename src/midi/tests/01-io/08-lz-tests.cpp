@@ -0,0 +1,113 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/lz.h"
+#include "Catch.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    std::vector<uint8_t> round_trip(const std::vector<uint8_t>& data)
+    {
+        std::vector<uint8_t> compressed;
+        io::lz_compress(data.data(), data.size(), &compressed);
+
+        std::vector<uint8_t> result(data.size());
+        CATCH_REQUIRE(io::lz_decompress(compressed.data(), compressed.size(), result.data(), result.size()));
+
+        return result;
+    }
+
+    std::vector<uint8_t> random_bytes(size_t size, unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::vector<uint8_t> result(size);
+
+        for (uint8_t& byte : result)
+        {
+            byte = uint8_t(generator());
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("LZ round trips empty and short blocks")
+{
+    for (size_t size = 0; size != 12; ++size)
+    {
+        std::vector<uint8_t> data(size, 7);
+
+        CATCH_CHECK(round_trip(data) == data);
+    }
+}
+
+TEST_CASE("LZ round trips random bytes")
+{
+    std::vector<uint8_t> data = random_bytes(10000, 1);
+
+    CATCH_CHECK(round_trip(data) == data);
+}
+
+TEST_CASE("LZ compresses runs of pixels and repeated rows")
+{
+    // Rows of opaque black BGRA pixels with a coloured note in the middle
+    std::vector<uint8_t> data;
+    for (unsigned y = 0; y != 64; ++y)
+    {
+        for (unsigned x = 0; x != 256; ++x)
+        {
+            bool note = x >= 100 && x < 180 && y >= 16 && y < 32;
+            uint8_t pixel[] = { uint8_t(note ? 200 : 0), uint8_t(note ? 50 : 0), 0, 255 };
+            data.insert(data.end(), pixel, pixel + 4);
+        }
+    }
+
+    std::vector<uint8_t> compressed;
+    io::lz_compress(data.data(), data.size(), &compressed);
+
+    CATCH_CHECK(compressed.size() * 100 < data.size());
+    CATCH_CHECK(round_trip(data) == data);
+}
+
+TEST_CASE("LZ appends to the output")
+{
+    std::vector<uint8_t> data = random_bytes(100, 2);
+    std::vector<uint8_t> compressed = { 1, 2, 3 };
+
+    io::lz_compress(data.data(), data.size(), &compressed);
+
+    std::vector<uint8_t> result(data.size());
+    CATCH_CHECK(compressed[0] == 1);
+    CATCH_CHECK(io::lz_decompress(compressed.data() + 3, compressed.size() - 3, result.data(), result.size()));
+    CATCH_CHECK(result == data);
+}
+
+TEST_CASE("LZ rejects damaged blocks")
+{
+    std::vector<uint8_t> data(1000, 0);
+    data[500] = 1;
+    std::vector<uint8_t> compressed;
+    io::lz_compress(data.data(), data.size(), &compressed);
+    std::vector<uint8_t> result(data.size());
+
+    // Wrong size
+    CATCH_CHECK(!io::lz_decompress(compressed.data(), compressed.size(), result.data(), result.size() - 1));
+    CATCH_CHECK(!io::lz_decompress(compressed.data(), compressed.size(), result.data(), result.size() + 1));
+
+    // Truncated
+    for (size_t size = 0; size != compressed.size(); ++size)
+    {
+        CATCH_CHECK(!io::lz_decompress(compressed.data(), size, result.data(), result.size()));
+    }
+
+    // Match reaching before the start of the output
+    std::vector<uint8_t> bad = { 1, 'a', 4, 2 };
+    CATCH_CHECK(!io::lz_decompress(bad.data(), bad.size(), result.data(), 5));
+}
+
+#endif
@@ -1,4 +1,5 @@
 #ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
 #define TEST_CASE CATCH_TEST_CASE
 
 #include "tests/tests-util.h"
@@ -22,4 +23,25 @@ TEST_CASE("Reading empty MTrk")
     receiver->check_finished();
 }
 
+TEST_CASE("Reading MTrk skips bytes after end of track up to the chunk length")
+{
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 0x06, // Length
+        END_OF_TRACK,
+        'p', 'q',
+        'n', 'e', 'x', 't'
+    };
+    std::string data(buffer, sizeof(buffer));
+    std::stringstream ss(data);
+
+    auto receiver = Builder().meta(midi::Duration(0), 0x2F, "").build();
+    read_mtrk(ss, *receiver);
+    receiver->check_finished();
+
+    std::string rest;
+    ss >> rest;
+    CATCH_CHECK(rest == "next");
+}
+
 #endif
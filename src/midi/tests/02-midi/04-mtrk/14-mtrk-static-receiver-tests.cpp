@@ -0,0 +1,79 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include <sstream>
+
+using namespace testutils;
+
+
+namespace
+{
+    struct CountingReceiver final
+    {
+        int meta_count = 0;
+        int note_on_count = 0;
+        int note_off_count = 0;
+        int other_count = 0;
+        uint64_t total_dt = 0;
+
+        void meta(midi::Duration dt, uint8_t, std::unique_ptr<uint8_t[]>, uint64_t) { ++meta_count; total_dt += value(dt); }
+        void sysex(midi::Duration dt, std::unique_ptr<uint8_t[]>, uint64_t) { ++other_count; total_dt += value(dt); }
+        void note_on(midi::Duration dt, midi::Channel, midi::NoteNumber, uint8_t) { ++note_on_count; total_dt += value(dt); }
+        void note_off(midi::Duration dt, midi::Channel, midi::NoteNumber, uint8_t) { ++note_off_count; total_dt += value(dt); }
+        void polyphonic_key_pressure(midi::Duration dt, midi::Channel, midi::NoteNumber, uint8_t) { ++other_count; total_dt += value(dt); }
+        void control_change(midi::Duration dt, midi::Channel, uint8_t, uint8_t) { ++other_count; total_dt += value(dt); }
+        void program_change(midi::Duration dt, midi::Channel, midi::Instrument) { ++other_count; total_dt += value(dt); }
+        void channel_pressure(midi::Duration dt, midi::Channel, uint8_t) { ++other_count; total_dt += value(dt); }
+        void pitch_wheel_change(midi::Duration dt, midi::Channel, uint16_t) { ++other_count; total_dt += value(dt); }
+    };
+}
+
+TEST_CASE("Reading MTrk into receiver that does not derive from EventReceiver")
+{
+    const char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 22, // Length
+        0, NOTE_ON(0, 5, 127),
+        10, NOTE_ON_RS(6, 127),
+        10, NOTE_OFF(0, 5, 0),
+        3, CONTROL_CHANGE(1, 7, 100),
+        4, PROGRAM_CHANGE(1, 5),
+        END_OF_TRACK
+    };
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+    CountingReceiver receiver;
+
+    midi::read_mtrk(cursor, receiver);
+
+    CATCH_CHECK(receiver.note_on_count == 2);
+    CATCH_CHECK(receiver.note_off_count == 1);
+    CATCH_CHECK(receiver.other_count == 2);
+    CATCH_CHECK(receiver.meta_count == 1);
+    CATCH_CHECK(receiver.total_dt == 27);
+}
+
+TEST_CASE("EventReceiverWrapper forwards virtual calls to wrapped receiver")
+{
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 12, // Length
+        0, NOTE_ON(0, 5, 127),
+        10, NOTE_OFF(0, 5, 0),
+        END_OF_TRACK
+    };
+    std::string data(buffer, sizeof(buffer));
+    std::stringstream ss(data);
+    CountingReceiver receiver;
+    midi::EventReceiverWrapper<CountingReceiver> wrapper(receiver);
+
+    midi::read_mtrk(ss, wrapper);
+
+    CATCH_CHECK(receiver.note_on_count == 1);
+    CATCH_CHECK(receiver.note_off_count == 1);
+    CATCH_CHECK(receiver.meta_count == 1);
+    CATCH_CHECK(receiver.total_dt == 10);
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include <sstream>
+#include <vector>
+
+using namespace testutils;
+
+
+namespace
+{
+    class PayloadViewReceiver : public midi::EventReceiver
+    {
+    public:
+        std::vector<const uint8_t*> views;
+        int owning_calls = 0;
+
+        void meta(midi::Duration, uint8_t, std::unique_ptr<uint8_t[]>, uint64_t) override { ++owning_calls; }
+        void sysex(midi::Duration, std::unique_ptr<uint8_t[]>, uint64_t) override { ++owning_calls; }
+        void meta(midi::Duration, uint8_t, const uint8_t* data, uint64_t) override { views.push_back(data); }
+        void sysex(midi::Duration, const uint8_t* data, uint64_t) override { views.push_back(data); }
+        void note_on(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) override { }
+        void note_off(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) override { }
+        void polyphonic_key_pressure(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) override { }
+        void control_change(midi::Duration, midi::Channel, uint8_t, uint8_t) override { }
+        void program_change(midi::Duration, midi::Channel, midi::Instrument) override { }
+        void channel_pressure(midi::Duration, midi::Channel, uint8_t) override { }
+        void pitch_wheel_change(midi::Duration, midi::Channel, uint16_t) override { }
+    };
+
+    const char lyric_track[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 16, // Length
+        0, char(0xFF), 0x05, 0x03, 'l', 'a', ' ', // Lyric
+        0, char(0xF0), 0x02, 0x7E, 0x01, // Sysex
+        END_OF_TRACK
+    };
+}
+
+TEST_CASE("Reading MTrk, meta and sysex payloads point into the input buffer")
+{
+    auto data = reinterpret_cast<const uint8_t*>(lyric_track);
+    io::ByteCursor cursor(data, sizeof(lyric_track));
+    PayloadViewReceiver receiver;
+
+    midi::read_mtrk(cursor, receiver);
+
+    CATCH_REQUIRE(receiver.views.size() == 3);
+    CATCH_CHECK(receiver.views[0] == data + 12);
+    CATCH_CHECK(receiver.views[1] == data + 18);
+    CATCH_CHECK(receiver.owning_calls == 0);
+}
+
+TEST_CASE("Reading MTrk, receivers with only owning meta/sysex still get a copy of the payload")
+{
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(lyric_track), sizeof(lyric_track));
+
+    auto receiver = Builder()
+        .meta(midi::Duration(0), 0x05, "la ")
+        .sysex(midi::Duration(0), std::string("\x7E\x01", 2))
+        .meta(midi::Duration(0), 0x2F, "")
+        .build();
+
+    midi::read_mtrk(cursor, *receiver);
+    receiver->check_finished();
+}
+
+TEST_CASE("EventMulticaster forwards payload views without copying")
+{
+    auto first = std::make_shared<PayloadViewReceiver>();
+    auto second = std::make_shared<PayloadViewReceiver>();
+    midi::EventMulticaster multicaster(std::vector<std::shared_ptr<midi::EventReceiver>>{ first, second });
+    const uint8_t payload[] = { 1, 2, 3 };
+
+    multicaster.meta(midi::Duration(0), 0x05, payload, sizeof(payload));
+
+    CATCH_REQUIRE(first->views.size() == 1);
+    CATCH_REQUIRE(second->views.size() == 1);
+    CATCH_CHECK(first->views[0] == payload);
+    CATCH_CHECK(second->views[0] == payload);
+}
+
+TEST_CASE("read_notes, meta events between notes")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 26, // MTrk size
+        0, NOTE_ON(0, 60, 100),
+        5, char(0xFF), 0x05, 0x03, 'l', 'a', ' ', // Lyric
+        5, char(0xFF), 0x05, 0x03, 'l', 'a', ' ', // Lyric
+        5, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK
+    };
+
+    auto notes = midi::read_notes(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    CATCH_REQUIRE(notes.size() == 1);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(60), midi::Time(0), midi::Duration(15), 100, midi::Instrument(0)));
+}
+
+#endif
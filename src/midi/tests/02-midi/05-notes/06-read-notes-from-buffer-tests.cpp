@@ -0,0 +1,111 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+#include <sstream>
+
+using namespace testutils;
+
+
+TEST_CASE("Reading MTrk from ByteCursor, running status")
+{
+    const char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 15, // Length
+        0, NOTE_ON(0, 5, 127),
+        10, NOTE_ON_RS(6, 127),
+        10, NOTE_OFF(0, 5, 0),
+        END_OF_TRACK
+    };
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    auto receiver = Builder()
+        .note_on(midi::Duration(0), midi::Channel(0), midi::NoteNumber(5), 127)
+        .note_on(midi::Duration(10), midi::Channel(0), midi::NoteNumber(6), 127)
+        .note_off(midi::Duration(10), midi::Channel(0), midi::NoteNumber(5), 0)
+        .meta(midi::Duration(0), 0x2F, "")
+        .build();
+
+    midi::read_mtrk(cursor, *receiver);
+    receiver->check_finished();
+    CATCH_CHECK(cursor.at_end());
+}
+
+TEST_CASE("Reading MTrk from ByteCursor, cursor is positioned after end of track")
+{
+    const char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 4, // Length
+        END_OF_TRACK,
+        0x12, 0x34
+    };
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    auto receiver = Builder()
+        .meta(midi::Duration(0), 0x2F, "")
+        .build();
+
+    midi::read_mtrk(cursor, *receiver);
+    receiver->check_finished();
+    CATCH_CHECK(cursor.remaining() == 2);
+}
+
+TEST_CASE("Reading MTrk from stream leaves stream positioned after end of track")
+{
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 4, // Length
+        END_OF_TRACK,
+        0x12, 0x34
+    };
+    std::string data(buffer, sizeof(buffer));
+    std::stringstream ss(data);
+
+    auto receiver = Builder()
+        .meta(midi::Duration(0), 0x2F, "")
+        .build();
+
+    midi::read_mtrk(ss, *receiver);
+    receiver->check_finished();
+    CATCH_CHECK(ss.get() == 0x12);
+}
+
+TEST_CASE("read_notes from buffer gives same result as from stream")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 21, // MTrk size
+        0, PROGRAM_CHANGE(1, 20),
+        0, NOTE_ON(1, 60, 100),
+        0, char(0xFF), 0x05, 0x02, 'l', 'a', // Lyric
+        20, NOTE_OFF(1, 60, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 14, // MTrk size
+        5, NOTE_ON(2, 40, 50),
+        5, NOTE_ON_RS(40, 0),
+        0, NOTE_ON_RS(41, 1),
+        END_OF_TRACK
+    };
+    std::string data(buffer, sizeof(buffer));
+    std::stringstream ss(data);
+
+    std::vector<midi::NOTE> from_stream = midi::read_notes(ss);
+    std::vector<midi::NOTE> from_buffer = midi::read_notes(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    CATCH_REQUIRE(from_buffer.size() == 2);
+    CATCH_CHECK(from_buffer == from_stream);
+    CATCH_CHECK(from_buffer[0] == midi::NOTE(midi::NoteNumber(60), midi::Time(0), midi::Duration(20), 100, midi::Instrument(20)));
+    CATCH_CHECK(from_buffer[1] == midi::NOTE(midi::NoteNumber(40), midi::Time(5), midi::Duration(5), 50, midi::Instrument(0)));
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+
+
+namespace
+{
+    std::vector<char> build_multitrack_file(int ntracks)
+    {
+        std::vector<char> buffer = {
+            MTHD,
+            0x00, 0x00, 0x00, 0x06, // MThd size
+            0x00, 0x01, // Type
+            0x00, char(ntracks), // Number of tracks
+            0x01, 0x00, // Division
+        };
+
+        for (int i = 0; i != ntracks; ++i)
+        {
+            const char track[] = {
+                MTRK,
+                0x00, 0x00, 0x00, 21, // MTrk size
+                0, PROGRAM_CHANGE(i % 16, i),
+                char(i), NOTE_ON(i % 16, 60 + i, 100),
+                10, NOTE_ON_RS(61 + i, 90),
+                5, NOTE_OFF(i % 16, 60 + i, 0),
+                1, NOTE_OFF_RS(61 + i, 0),
+                END_OF_TRACK
+            };
+
+            buffer.insert(buffer.end(), track, track + sizeof(track));
+        }
+
+        return buffer;
+    }
+}
+
+// The MTHD byte macro from tests-util.h hides midi::MTHD
+#undef MTHD
+
+TEST_CASE("locate_tracks finds all MTrk chunks")
+{
+    auto buffer = build_multitrack_file(3);
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
+    midi::MTHD mthd;
+    midi::read_mthd(cursor, &mthd);
+
+    auto tracks = midi::locate_tracks(cursor, mthd);
+
+    CATCH_REQUIRE(tracks.size() == 3);
+    CATCH_CHECK(tracks[0].offset == 14);
+    CATCH_CHECK(tracks[0].size == 29);
+    CATCH_CHECK(tracks[1].offset == 43);
+    CATCH_CHECK(tracks[2].offset == 72);
+    CATCH_CHECK(cursor.at_end());
+}
+
+TEST_CASE("read_notes_parallel gives same notes in same order as read_notes")
+{
+    for (unsigned threads : { 1u, 2u, 4u, 0u })
+    {
+        auto buffer = build_multitrack_file(20);
+        auto data = reinterpret_cast<const uint8_t*>(buffer.data());
+
+        auto expected = midi::read_notes(data, buffer.size());
+        auto actual = midi::read_notes_parallel(data, buffer.size(), threads);
+
+        CATCH_REQUIRE(expected.size() == 40);
+        CATCH_CHECK(actual == expected);
+    }
+}
+
+TEST_CASE("read_notes_parallel, zero tracks")
+{
+    auto buffer = build_multitrack_file(0);
+
+    auto notes = midi::read_notes_parallel(reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size(), 4);
+
+    CATCH_CHECK(notes.size() == 0);
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include <vector>
+
+using namespace testutils;
+
+
+TEST_CASE("Static multicaster, two receivers, one event (note on)")
+{
+    auto first = Builder().note_on(midi::Duration(1), midi::Channel(2), midi::NoteNumber(3), 4).build();
+    auto second = Builder().note_on(midi::Duration(1), midi::Channel(2), midi::NoteNumber(3), 4).build();
+    auto multicaster = midi::make_static_multicaster(*first, *second);
+
+    multicaster.note_on(midi::Duration(1), midi::Channel(2), midi::NoteNumber(3), 4);
+
+    first->check_finished();
+    second->check_finished();
+}
+
+TEST_CASE("Static multicaster, receivers of different types")
+{
+    std::vector<midi::NOTE> notes;
+    midi::ChannelNoteCollector collector(midi::Channel(0), [&notes](const midi::NOTE& note) { notes.push_back(note); });
+    auto checker = Builder()
+        .note_on(midi::Duration(0), midi::Channel(0), midi::NoteNumber(5), 100)
+        .meta(midi::Duration(10), 0x05, "la")
+        .note_off(midi::Duration(10), midi::Channel(0), midi::NoteNumber(5), 0)
+        .build();
+    auto multicaster = midi::make_static_multicaster(collector, *checker);
+    const uint8_t lyric[] = { 'l', 'a' };
+
+    multicaster.note_on(midi::Duration(0), midi::Channel(0), midi::NoteNumber(5), 100);
+    multicaster.meta(midi::Duration(10), 0x05, lyric, sizeof(lyric));
+    multicaster.note_off(midi::Duration(10), midi::Channel(0), midi::NoteNumber(5), 0);
+
+    checker->check_finished();
+    CATCH_REQUIRE(notes.size() == 1);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(5), midi::Time(0), midi::Duration(20), 100, midi::Instrument(0)));
+}
+
+TEST_CASE("Static multicaster as read_mtrk receiver")
+{
+    const char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 12, // Length
+        0, NOTE_ON(1, 10, 55),
+        7, CONTROL_CHANGE(1, 7, 100),
+        END_OF_TRACK
+    };
+    auto build_receiver = []() {
+        return Builder()
+            .note_on(midi::Duration(0), midi::Channel(1), midi::NoteNumber(10), 55)
+            .control_change(midi::Duration(7), midi::Channel(1), 7, 100)
+            .meta(midi::Duration(0), 0x2F, "")
+            .build();
+    };
+    auto first = build_receiver();
+    auto second = build_receiver();
+    auto multicaster = midi::make_static_multicaster(*first, *second);
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    midi::read_mtrk(cursor, multicaster);
+
+    first->check_finished();
+    second->check_finished();
+}
+
+#endif
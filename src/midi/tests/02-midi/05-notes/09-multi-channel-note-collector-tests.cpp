@@ -0,0 +1,134 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "Catch.h"
+#include <set>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+    std::vector<midi::NOTE> collect(const std::function<void(midi::MultiChannelNoteCollector&)>& events)
+    {
+        std::vector<midi::NOTE> notes;
+        midi::MultiChannelNoteCollector collector([&notes](const midi::NOTE& note) { notes.push_back(note); });
+        events(collector);
+        return notes;
+    }
+}
+
+TEST_CASE("Multi channel collector, notes on different channels")
+{
+    auto notes = collect([](midi::MultiChannelNoteCollector& collector) {
+        collector.program_change(midi::Duration(0), midi::Channel(3), midi::Instrument(7));
+        collector.note_on(midi::Duration(0), midi::Channel(3), midi::NoteNumber(60), 100);
+        collector.note_on(midi::Duration(5), midi::Channel(9), midi::NoteNumber(60), 80);
+        collector.note_off(midi::Duration(5), midi::Channel(3), midi::NoteNumber(60), 0);
+        collector.note_off(midi::Duration(5), midi::Channel(9), midi::NoteNumber(60), 0);
+    });
+
+    CATCH_REQUIRE(notes.size() == 2);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(60), midi::Time(0), midi::Duration(10), 100, midi::Instrument(7)));
+    CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(60), midi::Time(5), midi::Duration(10), 80, midi::Instrument(0)));
+}
+
+TEST_CASE("Multi channel collector, note on with velocity zero ends the note")
+{
+    auto notes = collect([](midi::MultiChannelNoteCollector& collector) {
+        collector.note_on(midi::Duration(0), midi::Channel(0), midi::NoteNumber(10), 50);
+        collector.note_on(midi::Duration(20), midi::Channel(0), midi::NoteNumber(10), 0);
+    });
+
+    CATCH_REQUIRE(notes.size() == 1);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(10), midi::Time(0), midi::Duration(20), 50, midi::Instrument(0)));
+}
+
+TEST_CASE("Multi channel collector, repeated note on ends the sounding note")
+{
+    auto notes = collect([](midi::MultiChannelNoteCollector& collector) {
+        collector.note_on(midi::Duration(0), midi::Channel(1), midi::NoteNumber(10), 50);
+        collector.note_on(midi::Duration(20), midi::Channel(1), midi::NoteNumber(10), 60);
+        collector.note_off(midi::Duration(5), midi::Channel(1), midi::NoteNumber(10), 0);
+    });
+
+    CATCH_REQUIRE(notes.size() == 2);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(10), midi::Time(0), midi::Duration(20), 50, midi::Instrument(0)));
+    CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(10), midi::Time(20), midi::Duration(5), 60, midi::Instrument(0)));
+}
+
+TEST_CASE("Multi channel collector, active notes")
+{
+    midi::MultiChannelNoteCollector collector([](const midi::NOTE&) {});
+
+    collector.note_on(midi::Duration(0), midi::Channel(2), midi::NoteNumber(64), 50);
+    collector.note_on(midi::Duration(0), midi::Channel(2), midi::NoteNumber(67), 50);
+    collector.note_off(midi::Duration(1), midi::Channel(2), midi::NoteNumber(64), 0);
+
+    CATCH_CHECK(collector.active_notes(midi::Channel(2)).count() == 1);
+    CATCH_CHECK(collector.active_notes(midi::Channel(2)).test(67));
+    CATCH_CHECK(collector.active_notes(midi::Channel(3)).none());
+}
+
+TEST_CASE("Multi channel collector produces the same notes as NoteCollector")
+{
+    std::vector<midi::NOTE> expected;
+    midi::NoteCollector reference([&expected](const midi::NOTE& note) { expected.push_back(note); });
+    std::vector<midi::NOTE> actual;
+    midi::MultiChannelNoteCollector collector([&actual](const midi::NOTE& note) { actual.push_back(note); });
+
+    // ChannelNoteCollector leaves instruments and start times uninitialized, so every channel gets a
+    // program and notes are only released after they have been started once.
+    for (uint8_t channel = 0; channel < 16; channel++) {
+        reference.program_change(midi::Duration(1), midi::Channel(channel), midi::Instrument(channel));
+        collector.program_change(midi::Duration(1), midi::Channel(channel), midi::Instrument(channel));
+    }
+
+    std::set<std::pair<uint8_t, uint8_t>> started;
+    uint32_t state = 12345;
+    auto next = [&state]() { state = state * 1103515245 + 12345; return (state >> 16) & 0x7FFF; };
+
+    for (int i = 0; i < 5000; i++) {
+        midi::Duration dt(next() % 8);
+        midi::Channel channel(uint8_t(next() % 16));
+        midi::NoteNumber note(uint8_t(60 + next() % 6));
+        auto key = std::make_pair(value(channel), value(note));
+
+        switch (next() % 5) {
+        case 0:
+        case 1:
+        {
+            uint8_t velocity = uint8_t(next() % 4 == 0 ? 0 : 1 + next() % 127);
+            if (velocity != 0 || started.count(key)) {
+                reference.note_on(dt, channel, note, velocity);
+                collector.note_on(dt, channel, note, velocity);
+                started.insert(key);
+            }
+            break;
+        }
+        case 2:
+            if (started.count(key)) {
+                reference.note_off(dt, channel, note, 0);
+                collector.note_off(dt, channel, note, 0);
+            }
+            break;
+        case 3:
+        {
+            midi::Instrument program(uint8_t(next() % 128));
+            reference.program_change(dt, channel, program);
+            collector.program_change(dt, channel, program);
+            break;
+        }
+        default:
+            reference.control_change(dt, channel, 7, 100);
+            collector.control_change(dt, channel, 7, 100);
+            break;
+        }
+    }
+
+    CATCH_CHECK(actual == expected);
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/event-table.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+
+using namespace testutils;
+
+
+namespace
+{
+    const char every_event[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 42, // Length
+        0, NOTE_ON(1, 60, 100),
+        5, NOTE_OFF(1, 60, 10),
+        1, POLYPHONIC_KEY_PRESSURE(2, 61, 20),
+        2, CONTROL_CHANGE(3, 7, 30),
+        3, PROGRAM_CHANGE(4, 40),
+        4, CHANNEL_PRESSURE(5, 50),
+        char(0x81), 0x00, PITCH_WHEEL_CHANGE(6, 0x1234),
+        7, char(0xFF), 0x05, 2, 'l', 'a',
+        8, char(0xF0), 2, 0x7E, 0x01,
+        END_OF_TRACK
+    };
+
+    std::unique_ptr<TestEventReceiver> expect_every_event()
+    {
+        return Builder()
+            .note_on(midi::Duration(0), midi::Channel(1), midi::NoteNumber(60), 100)
+            .note_off(midi::Duration(5), midi::Channel(1), midi::NoteNumber(60), 10)
+            .polyphonic_key_pressure(midi::Duration(1), midi::Channel(2), midi::NoteNumber(61), 20)
+            .control_change(midi::Duration(2), midi::Channel(3), 7, 30)
+            .program_change(midi::Duration(3), midi::Channel(4), midi::Instrument(40))
+            .channel_pressure(midi::Duration(4), midi::Channel(5), 50)
+            .pitch_wheel_change(midi::Duration(128), midi::Channel(6), 0x1234)
+            .meta(midi::Duration(7), 0x05, "la")
+            .sysex(midi::Duration(8), std::string("\x7E\x01", 2))
+            .meta(midi::Duration(0), 0x2F, "")
+            .build();
+    }
+
+    midi::EventTable read_every_event()
+    {
+        io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(every_event), sizeof(every_event));
+        midi::EventTable table;
+        table.begin_track();
+        midi::read_mtrk(cursor, table);
+        return table;
+    }
+}
+
+TEST_CASE("EventTable stores one entry per event")
+{
+    midi::EventTable table = read_every_event();
+
+    CATCH_CHECK(table.track_count() == 1);
+    CATCH_CHECK(table.event_count() == 10);
+    CATCH_CHECK(table.event_count(0) == 10);
+}
+
+TEST_CASE("EventTable replays every event kind to an EventReceiver")
+{
+    midi::EventTable table = read_every_event();
+    auto receiver = expect_every_event();
+
+    table.replay(0, static_cast<midi::EventReceiver&>(*receiver));
+
+    receiver->check_finished();
+}
+
+TEST_CASE("EventTable can be replayed more than once")
+{
+    midi::EventTable table = read_every_event();
+    auto first = expect_every_event();
+    auto second = expect_every_event();
+
+    table.replay(0, *first);
+    table.replay(0, *second);
+
+    first->check_finished();
+    second->check_finished();
+}
+
+// The MTHD byte macro from tests-util.h hides midi::MTHD
+TEST_CASE("EventTable replay gives the same notes as read_notes")
+{
+    const char buffer[] = {
+        'M', 'T', 'h', 'd',
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 18, // MTrk size
+        0, PROGRAM_CHANGE(0, 3),
+        0, NOTE_ON(0, 60, 100),
+        10, NOTE_ON_RS(64, 90),
+        5, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 16, // MTrk size
+        2, NOTE_ON(9, 36, 120),
+        0, char(0xFF), 0x01, 1, 'x',
+        3, NOTE_ON_RS(36, 0),
+        END_OF_TRACK
+    };
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer);
+
+    midi::EventTable table = midi::read_event_table(data, sizeof(buffer));
+    std::vector<midi::NOTE> replayed;
+    for (size_t track = 0; track != table.track_count(); ++track)
+    {
+        midi::MultiChannelNoteCollector collector([&replayed](const midi::NOTE& note) { replayed.push_back(note); });
+        table.replay(track, collector);
+    }
+
+    CATCH_CHECK(table.track_count() == 2);
+    CATCH_CHECK(table.event_count(0) == 5);
+    CATCH_CHECK(table.event_count(1) == 4);
+    CATCH_CHECK(replayed == midi::read_notes(data, sizeof(buffer)));
+}
+
+#endif
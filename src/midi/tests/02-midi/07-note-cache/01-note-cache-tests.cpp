@@ -0,0 +1,149 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/note-cache.h"
+#include "util/check-size.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace testutils;
+
+
+namespace
+{
+    const char song[] = {
+        'M', 'T', 'h', 'd',
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 22, // MTrk size
+        0, PROGRAM_CHANGE(0, 3),
+        0, NOTE_ON(0, 60, 100),
+        10, NOTE_ON_RS(64, 90),
+        5, NOTE_OFF(0, 60, 0),
+        0, NOTE_OFF(0, 64, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 12, // MTrk size
+        2, NOTE_ON(9, 36, 120),
+        3, NOTE_OFF(9, 36, 0),
+        END_OF_TRACK
+    };
+
+    const midi::SOURCE_KEY source = { sizeof(song), 1234, 5678 };
+
+    std::vector<uint8_t> build_song_cache()
+    {
+        return midi::build_note_cache(reinterpret_cast<const uint8_t*>(song), sizeof(song), source);
+    }
+}
+
+TEST_CASE("Checking that the note cache records have a fixed layout")
+{
+    check_size<midi::SOURCE_KEY, 24>();
+    check_size<midi::NOTE_CACHE_HEADER, 72>();
+    check_size<midi::CACHED_TRACK, 32>();
+    check_size<midi::CACHED_NOTE, 24>();
+
+    static_assert(offsetof(midi::NOTE_CACHE_HEADER, source) == 16, "NOTE_CACHE_HEADER's source field does not have the correct offset");
+    static_assert(offsetof(midi::NOTE_CACHE_HEADER, tracks_offset) == 48, "NOTE_CACHE_HEADER's tracks_offset field does not have the correct offset");
+    static_assert(offsetof(midi::CACHED_NOTE, note_number) == 16, "CACHED_NOTE's note_number field does not have the correct offset");
+}
+
+TEST_CASE("Note cache holds the notes in read_notes order")
+{
+    std::vector<uint8_t> bytes = build_song_cache();
+    midi::NoteCache cache(bytes.data(), bytes.size());
+
+    CATCH_CHECK(cache.to_notes() == midi::read_notes(reinterpret_cast<const uint8_t*>(song), sizeof(song)));
+    CATCH_CHECK(cache.note_count() == 3);
+    CATCH_CHECK(cache.notes() == reinterpret_cast<const midi::CACHED_NOTE*>(bytes.data() + cache.header().notes_offset));
+}
+
+TEST_CASE("Note cache header and track metadata")
+{
+    std::vector<uint8_t> bytes = build_song_cache();
+    midi::NoteCache cache(bytes.data(), bytes.size());
+
+    CATCH_CHECK(cache.header().version == midi::NOTE_CACHE_VERSION);
+    CATCH_CHECK(cache.header().source == source);
+    CATCH_CHECK(cache.header().type == 1);
+    CATCH_CHECK(cache.header().division == 0x100);
+    CATCH_REQUIRE(cache.track_count() == 2);
+
+    CATCH_CHECK(cache.track(0).first_note == 0);
+    CATCH_CHECK(cache.track(0).note_count == 2);
+    CATCH_CHECK(cache.track(0).end == 15);
+    CATCH_CHECK(cache.track(0).lowest_note == 60);
+    CATCH_CHECK(cache.track(0).highest_note == 64);
+
+    CATCH_CHECK(cache.track(1).first_note == 2);
+    CATCH_CHECK(cache.track(1).note_count == 1);
+    CATCH_CHECK(cache.track(1).end == 5);
+    CATCH_CHECK(cache.notes(1)->note_number == 36);
+    CATCH_CHECK(cache.notes(1)->instrument == 0);
+}
+
+TEST_CASE("Note cache validation rejects damaged caches")
+{
+    std::vector<uint8_t> bytes = build_song_cache();
+    CATCH_CHECK(midi::is_note_cache(bytes.data(), bytes.size()));
+
+    CATCH_CHECK(!midi::is_note_cache(bytes.data(), bytes.size() - 1));
+    CATCH_CHECK(!midi::is_note_cache(bytes.data(), sizeof(midi::NOTE_CACHE_HEADER) - 1));
+
+    std::vector<uint8_t> wrong_version = bytes;
+    reinterpret_cast<midi::NOTE_CACHE_HEADER*>(wrong_version.data())->version = midi::NOTE_CACHE_VERSION + 1;
+    CATCH_CHECK(!midi::is_note_cache(wrong_version.data(), wrong_version.size()));
+
+    // As written by a host with the other byte order
+    std::vector<uint8_t> swapped_version = bytes;
+    std::reverse(swapped_version.begin() + 8, swapped_version.begin() + 12);
+    CATCH_CHECK(!midi::is_note_cache(swapped_version.data(), swapped_version.size()));
+
+    std::vector<uint8_t> wrong_count = bytes;
+    reinterpret_cast<midi::NOTE_CACHE_HEADER*>(wrong_count.data())->note_count = 1000;
+    CATCH_CHECK(!midi::is_note_cache(wrong_count.data(), wrong_count.size()));
+}
+
+TEST_CASE("Note cache validation rejects a track table that does not fit")
+{
+    std::vector<uint8_t> bytes = build_song_cache();
+    uint64_t notes_offset = sizeof(midi::NOTE_CACHE_HEADER) + uint64_t(0xFFFF) * sizeof(midi::CACHED_TRACK);
+
+    // notes_offset lies past the end of the data, and the padding lets notes_offset + note_count * sizeof(CACHED_NOTE)
+    // wrap around to exactly the size
+    while ((bytes.size() - notes_offset) % sizeof(midi::CACHED_NOTE) != 0)
+    {
+        bytes.push_back(0);
+    }
+
+    midi::NOTE_CACHE_HEADER& header = *reinterpret_cast<midi::NOTE_CACHE_HEADER*>(bytes.data());
+    header.ntracks = 0xFFFF;
+    header.notes_offset = notes_offset;
+    header.note_count = (bytes.size() - notes_offset) / sizeof(midi::CACHED_NOTE);
+    CATCH_CHECK(header.notes_offset + header.note_count * sizeof(midi::CACHED_NOTE) == bytes.size());
+    CATCH_CHECK(!midi::is_note_cache(bytes.data(), bytes.size()));
+}
+
+TEST_CASE("Source keys only match when size, mtime and hash match")
+{
+    midi::SOURCE_KEY other_hash = source;
+    other_hash.hash++;
+    midi::SOURCE_KEY other_mtime = source;
+    other_mtime.mtime++;
+
+    CATCH_CHECK(source == source);
+    CATCH_CHECK(source != other_hash);
+    CATCH_CHECK(source != other_mtime);
+    CATCH_CHECK(midi::hash_bytes(reinterpret_cast<const uint8_t*>("a"), 1) != midi::hash_bytes(reinterpret_cast<const uint8_t*>("b"), 1));
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/try-read.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+
+using namespace testutils;
+
+
+namespace
+{
+    midi::PARSE_RESULT try_read(const char* buffer, size_t size, std::vector<midi::NOTE>* notes)
+    {
+        return midi::try_read_notes(reinterpret_cast<const uint8_t*>(buffer), size, notes);
+    }
+}
+
+TEST_CASE("try_read_notes gives the same notes as read_notes")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 18, // MTrk size
+        0, PROGRAM_CHANGE(0, 3),
+        0, NOTE_ON(0, 60, 100),
+        10, NOTE_ON_RS(64, 90),
+        5, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 16, // MTrk size
+        2, NOTE_ON(9, 36, 120),
+        0, char(0xF0), 1, 0x7E,
+        3, NOTE_OFF(9, 36, 0),
+        END_OF_TRACK
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.ok());
+    CATCH_CHECK(result.offset == sizeof(buffer));
+    CATCH_CHECK(notes == midi::read_notes(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer)));
+}
+
+TEST_CASE("try_read_notes reports a truncated MThd")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01 // Type
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::UNEXPECTED_END);
+    CATCH_CHECK(result.offset == 0);
+}
+
+TEST_CASE("try_read_notes reports a bad MThd id")
+{
+    const char buffer[] = {
+        'R', 'I', 'F', 'F',
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00 // Division
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::BAD_CHUNK_ID);
+    CATCH_CHECK(result.offset == 0);
+}
+
+TEST_CASE("try_read_notes reports a missing MTrk and keeps the notes read so far")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 12, // MTrk size
+        0, NOTE_ON(0, 60, 100),
+        5, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK,
+        'X', 'Y', 'Z', 'W',
+        0x00, 0x00, 0x00, 0x00
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::BAD_CHUNK_ID);
+    CATCH_CHECK(result.offset == 34);
+    CATCH_CHECK(notes.size() == 1);
+}
+
+TEST_CASE("try_read_notes reports a track that ends without end of track")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 7, // MTrk size
+        0, NOTE_ON(0, 60, 100),
+        5, char(0x80), 60
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::UNEXPECTED_END);
+    CATCH_CHECK(result.offset == 28);
+}
+
+TEST_CASE("try_read_notes reports a track longer than the data left")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 20, // MTrk size
+        0, NOTE_ON(0, 60, 100),
+        5, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::UNEXPECTED_END);
+    CATCH_CHECK(result.offset == 34);
+    CATCH_CHECK(notes.size() == 1);
+}
+
+TEST_CASE("try_read_notes reports a truncated meta payload")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 6, // MTrk size
+        0, char(0xFF), 0x01, 10, 'a', 'b'
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::UNEXPECTED_END);
+    CATCH_CHECK(result.offset == 26);
+}
+
+TEST_CASE("try_read_notes reports running status without status byte")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 7, // MTrk size
+        0, NOTE_ON_RS(60, 100),
+        END_OF_TRACK
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::MISSING_STATUS);
+    CATCH_CHECK(result.offset == 23);
+}
+
+TEST_CASE("try_read_notes reports a delta time longer than 4 bytes")
+{
+    const char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 9, // MTrk size
+        char(0x81), char(0x80), char(0x80), char(0x80), 0x00, NOTE_ON(0, 60, 100),
+        END_OF_TRACK
+    };
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = try_read(buffer, sizeof(buffer), &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::BAD_VARIABLE_LENGTH_INTEGER);
+    CATCH_CHECK(result.offset == 22);
+}
+
+TEST_CASE("try_read_notes_from_file reports a missing file")
+{
+    std::vector<midi::NOTE> notes;
+
+    midi::PARSE_RESULT result = midi::try_read_notes_from_file("this-file-does-not-exist.mid", &notes);
+
+    CATCH_CHECK(result.error == midi::ParseError::CANNOT_OPEN);
+    CATCH_CHECK(notes.empty());
+}
+
+#endif
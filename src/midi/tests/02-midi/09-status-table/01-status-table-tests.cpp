@@ -0,0 +1,52 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "midi/status-table.h"
+#include "Catch.h"
+
+
+namespace
+{
+    // Classification as read_mtrk did it before the status table
+    midi::EventKind classify_with_chain(uint8_t status)
+    {
+        if (midi::is_meta_event(status)) return midi::EventKind::META;
+        if (midi::is_sysex_event(status)) return midi::EventKind::SYSEX;
+        if (midi::is_midi_event(status))
+        {
+            uint8_t type = midi::extract_midi_event_type(status);
+
+            if (midi::is_note_off(type)) return midi::EventKind::NOTE_OFF;
+            if (midi::is_note_on(type)) return midi::EventKind::NOTE_ON;
+            if (midi::is_polyphonic_key_pressure(type)) return midi::EventKind::POLYPHONIC_KEY_PRESSURE;
+            if (midi::is_control_change(type)) return midi::EventKind::CONTROL_CHANGE;
+            if (midi::is_program_change(type)) return midi::EventKind::PROGRAM_CHANGE;
+            if (midi::is_channel_pressure(type)) return midi::EventKind::CHANNEL_PRESSURE;
+            if (midi::is_pitch_wheel_change(type)) return midi::EventKind::PITCH_WHEEL_CHANGE;
+        }
+        return midi::EventKind::UNSUPPORTED;
+    }
+}
+
+TEST_CASE("Status table agrees with is_* classification", "[status-table]")
+{
+    for (int status = 0x80; status != 0x100; ++status)
+    {
+        CATCH_CHECK(midi::status_table[uint8_t(status)].kind == classify_with_chain(uint8_t(status)));
+    }
+}
+
+TEST_CASE("Status table gives channel and data byte count", "[status-table]")
+{
+    CATCH_CHECK(midi::status_table[0x00].kind == midi::EventKind::DATA);
+    CATCH_CHECK(midi::status_table[0x7F].kind == midi::EventKind::DATA);
+    CATCH_CHECK(midi::status_table[0x9A].channel == 0x0A);
+    CATCH_CHECK(midi::status_table[0x9A].data_bytes == 2);
+    CATCH_CHECK(midi::status_table[0xD3].data_bytes == 1);
+    CATCH_CHECK(midi::status_table[0xE1].data_bytes == 2);
+    CATCH_CHECK(midi::status_table[0xF1].kind == midi::EventKind::UNSUPPORTED);
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    // Counts events without keeping them, so the benchmark measures read_mtrk and not the receiver
+    class CountingReceiver final
+    {
+    public:
+        uint64_t events = 0;
+        uint64_t checksum = 0;
+
+        void meta(midi::Duration dt, uint8_t type, std::unique_ptr<uint8_t[]>, uint64_t) { count(dt, type); }
+        void sysex(midi::Duration dt, std::unique_ptr<uint8_t[]>, uint64_t data_size) { count(dt, uint8_t(data_size)); }
+        void meta(midi::Duration dt, uint8_t type, const uint8_t*, uint64_t) { count(dt, type); }
+        void sysex(midi::Duration dt, const uint8_t*, uint64_t data_size) { count(dt, uint8_t(data_size)); }
+        void note_on(midi::Duration dt, midi::Channel, midi::NoteNumber note, uint8_t) { count(dt, value(note)); }
+        void note_off(midi::Duration dt, midi::Channel, midi::NoteNumber note, uint8_t) { count(dt, value(note)); }
+        void polyphonic_key_pressure(midi::Duration dt, midi::Channel, midi::NoteNumber, uint8_t pressure) { count(dt, pressure); }
+        void control_change(midi::Duration dt, midi::Channel, uint8_t, uint8_t controller_value) { count(dt, controller_value); }
+        void program_change(midi::Duration dt, midi::Channel, midi::Instrument) { count(dt, 0); }
+        void channel_pressure(midi::Duration dt, midi::Channel, uint8_t pressure) { count(dt, pressure); }
+        void pitch_wheel_change(midi::Duration dt, midi::Channel, uint16_t wheel_position) { count(dt, uint8_t(wheel_position)); }
+
+    private:
+        void count(midi::Duration dt, uint8_t data)
+        {
+            ++events;
+            checksum += value(dt) + data;
+        }
+    };
+
+    void encode(uint32_t value, std::vector<uint8_t>& out)
+    {
+        if (value >= 0x80)
+        {
+            out.push_back(uint8_t(0x80 | (value >> 7)));
+        }
+        out.push_back(value & 0x7F);
+    }
+
+    // A complete MTrk chunk of mostly the requested channel event type (0x9 for note on, 0xB for control change),
+    // mixed with note offs and the occasional text event, using running status whenever a track writer would
+    std::vector<uint8_t> generate_track(uint8_t type, size_t count)
+    {
+        std::mt19937 random(42);
+        std::vector<uint8_t> events;
+        uint8_t running = 0;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            unsigned roll = random() % 16;
+            uint8_t channel = random() % 4;
+
+            encode(random() % 4 == 0 ? random() % 500 : 0, events);
+
+            if (roll == 0)
+            {
+                events.insert(events.end(), { 0xFF, 0x01, 0x03, 'a', 'b', 'c' });
+                running = 0;
+                continue;
+            }
+
+            uint8_t status = uint8_t((roll < 5 ? 0x8 : type) << 4) | channel;
+            if (status != running)
+            {
+                events.push_back(status);
+                running = status;
+            }
+            events.push_back(random() % 128);
+            events.push_back(random() % 128);
+        }
+        events.insert(events.end(), { 0x00, 0xFF, 0x2F, 0x00 });
+
+        uint32_t size = uint32_t(events.size());
+        std::vector<uint8_t> track = { 'M', 'T', 'r', 'k', uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size) };
+        track.insert(track.end(), events.begin(), events.end());
+
+        return track;
+    }
+
+    void compare(const std::string& name, const std::vector<uint8_t>& track, size_t count)
+    {
+        // End of Track is an event too
+        uint64_t events = count + 1;
+
+        CountingReceiver all;
+        io::ByteCursor whole(track.data(), track.size());
+        midi::read_mtrk(whole, all);
+        CATCH_REQUIRE(all.events == events);
+
+        auto dynamic = benchmarks::measure(name + ", read_mtrk with EventReceiver", "events", events, 20, [&track]() {
+            CountingReceiver counter;
+            midi::EventReceiverWrapper<CountingReceiver> receiver(counter);
+            io::ByteCursor cursor(track.data(), track.size());
+            midi::read_mtrk(cursor, static_cast<midi::EventReceiver&>(receiver));
+            benchmarks::keep(counter.checksum);
+        });
+
+        auto bound = benchmarks::measure(name + ", read_mtrk with final receiver", "events", events, 20, [&track]() {
+            CountingReceiver counter;
+            io::ByteCursor cursor(track.data(), track.size());
+            midi::read_mtrk(cursor, counter);
+            benchmarks::keep(counter.checksum);
+        });
+
+        std::cout << name << ", speed-up of compile-time binding: " << bound / dynamic << "x" << std::endl;
+    }
+}
+
+TEST_CASE("Benchmark status decoding, note-dense track", "[.benchmark]")
+{
+    const size_t count = 1 << 20;
+    compare("Note-dense", generate_track(0x9, count), count);
+}
+
+TEST_CASE("Benchmark status decoding, controller-dense track", "[.benchmark]")
+{
+    const size_t count = 1 << 20;
+    compare("Controller-dense", generate_track(0xB, count), count);
+}
+
+#endif
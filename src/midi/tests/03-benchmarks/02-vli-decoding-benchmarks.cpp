@@ -0,0 +1,117 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/vli.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // Decoding as read_variable_length_integer(ByteCursor&) did it before the buffer decoder
+    uint64_t read_byte_by_byte(io::ByteCursor& in)
+    {
+        uint64_t result = 0;
+        uint8_t byte = io::read<uint8_t>(in);
+
+        while (byte & 0x80)
+        {
+            result = (result << 7) | (byte & 0x7F);
+            byte = io::read<uint8_t>(in);
+        }
+
+        return (result << 7) | (byte & 0x7F);
+    }
+
+    template<typename READ>
+    uint64_t sum_deltas(io::ByteCursor cursor, size_t count, READ read)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i != count; ++i)
+        {
+            sum += read(cursor);
+        }
+        return sum;
+    }
+
+    void encode(uint32_t value, std::vector<uint8_t>& out)
+    {
+        uint8_t bytes[4];
+        size_t size = 0;
+
+        do
+        {
+            bytes[size++] = value & 0x7F;
+            value >>= 7;
+        } while (value != 0);
+
+        while (size != 0)
+        {
+            --size;
+            out.push_back(bytes[size] | (size != 0 ? 0x80 : 0x00));
+        }
+    }
+
+    // Delta times as they occur in typical SMF tracks: mostly simultaneous events (0),
+    // then short gaps below a beat, some longer gaps and very rarely a long rest.
+    std::vector<uint8_t> generate_deltas(size_t count)
+    {
+        std::mt19937 random(42);
+        std::vector<uint8_t> buffer;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            unsigned roll = random() % 1000;
+
+            if (roll < 550) encode(0, buffer);
+            else if (roll < 850) encode(1 + random() % 127, buffer);
+            else if (roll < 995) encode(128 + random() % (0x4000 - 128), buffer);
+            else encode(0x4000 + random() % (0x200000 - 0x4000), buffer);
+        }
+
+        return buffer;
+    }
+}
+
+TEST_CASE("Benchmark delta time decoding", "[.benchmark]")
+{
+    const size_t count = 1 << 20;
+    std::vector<uint8_t> buffer = generate_deltas(count);
+    std::string text(buffer.begin(), buffer.end());
+    std::vector<uint32_t> deltas(count);
+
+    auto stream = benchmarks::measure("VLI, istream", "integers", count, 10, [&text, count]() {
+        std::stringstream ss(text);
+        uint64_t sum = 0;
+        for (size_t i = 0; i != count; ++i)
+        {
+            sum += io::read_variable_length_integer(ss);
+        }
+        benchmarks::keep(sum);
+    });
+
+    auto byte_by_byte = benchmarks::measure("VLI, cursor byte by byte", "integers", count, 50, [&buffer, count]() {
+        benchmarks::keep(sum_deltas(io::ByteCursor(buffer.data(), buffer.size()), count, [](io::ByteCursor& cursor) { return read_byte_by_byte(cursor); }));
+    });
+
+    auto cursor = benchmarks::measure("VLI, cursor fast path", "integers", count, 50, [&buffer, count]() {
+        benchmarks::keep(sum_deltas(io::ByteCursor(buffer.data(), buffer.size()), count, [](io::ByteCursor& cursor) { return io::read_variable_length_integer(cursor); }));
+    });
+
+    auto batch = benchmarks::measure("VLI, batch", "integers", count, 50, [&buffer, &deltas, count]() {
+        size_t consumed;
+        size_t decoded = io::decode_variable_length_integers(buffer.data(), buffer.size(), deltas.data(), count, &consumed);
+        benchmarks::keep(decoded + deltas[count - 1]);
+    });
+
+    std::cout << "VLI, cursor fast path speed-up over istream: " << cursor / stream << "x" << std::endl;
+    std::cout << "VLI, cursor fast path speed-up over byte by byte: " << cursor / byte_by_byte << "x" << std::endl;
+    std::cout << "VLI, batch speed-up over byte by byte: " << batch / byte_by_byte << "x" << std::endl;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/framebuffer.h"
+#include "util/grid.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <sstream>
+
+
+using namespace imaging;
+
+
+namespace
+{
+    const unsigned WIDTH = 1920;
+    const unsigned HEIGHT = 1080;
+    const unsigned NOTE_HEIGHT = 16;
+    const unsigned NOTE_WIDTH = 200;
+    const unsigned RECTANGLES = 1000;
+
+    Position rectangle_position(unsigned i)
+    {
+        return Position((i * 389) % (WIDTH - NOTE_WIDTH), (i * 97) % (HEIGHT - NOTE_HEIGHT));
+    }
+}
+
+TEST_CASE("Rectangle fill rate", "[.benchmark]")
+{
+    const uint64_t pixels = uint64_t(RECTANGLES) * NOTE_WIDTH * NOTE_HEIGHT;
+    RGBA8 color(200, 100, 50);
+
+    // Per-pixel writes through the virtual Grid interface, as Bitmap did before Framebuffer
+    std::shared_ptr<Grid<RGBA8>> grid = std::make_shared<ConcreteGrid<RGBA8>>(WIDTH, HEIGHT, RGBA8());
+    std::shared_ptr<Grid<RGBA8>> grid_slice = subgrid(grid, Position(0, 0), WIDTH, HEIGHT);
+    double grid_rate = benchmarks::measure("Grid per pixel", "pixels", pixels, 10, [&]() {
+        for (unsigned i = 0; i != RECTANGLES; ++i)
+        {
+            Position p = rectangle_position(i);
+
+            for (unsigned x = p.x; x != p.x + NOTE_WIDTH; ++x)
+            {
+                for (unsigned y = p.y; y != p.y + NOTE_HEIGHT; ++y)
+                {
+                    (*grid_slice)[Position(x, y)] = color;
+                }
+            }
+        }
+    });
+
+    RGBA8Bitmap bitmap(WIDTH, HEIGHT);
+    auto bitmap_slice = bitmap.slice(0, 0, WIDTH, HEIGHT);
+    double view_rate = benchmarks::measure("FramebufferView fill", "pixels", pixels, 10, [&]() {
+        for (unsigned i = 0; i != RECTANGLES; ++i)
+        {
+            Position p = rectangle_position(i);
+
+            bitmap_slice->view().sub_view(p.x, p.y, NOTE_WIDTH, NOTE_HEIGHT).fill(color);
+        }
+    });
+
+    std::cout << "speedup: " << view_rate / grid_rate << "x" << std::endl;
+}
+
+TEST_CASE("BMP encoding rate", "[.benchmark]")
+{
+    RGBA8Bitmap bitmap(WIDTH * 2, HEIGHT);
+    auto frame = bitmap.slice(WIDTH / 2, 0, WIDTH, HEIGHT);
+    std::stringstream out;
+
+    benchmarks::measure("save_as_bmp (RGBA8 slice)", "pixels", uint64_t(WIDTH) * HEIGHT, 20, [&]() {
+        out.str(std::string());
+        save_as_bmp(out, *frame);
+        benchmarks::keep(uint64_t(out.tellp()));
+    });
+}
+
+#endif
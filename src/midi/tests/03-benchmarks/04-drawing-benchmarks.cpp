@@ -0,0 +1,139 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/drawing.h"
+#include "imaging/piano-roll.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+
+
+using namespace imaging;
+
+
+namespace
+{
+    const unsigned WIDTH = 4096;
+    const unsigned HEIGHT = 128 * 16;
+    const unsigned NOTE_HEIGHT = 16;
+    const unsigned RECTANGLES = 2000;
+
+    // Note rectangles as the app draws them: 16 pixels tall, a few dozen to a few hundred pixels wide
+    struct RECTANGLE
+    {
+        unsigned x, y, width;
+    };
+
+    std::vector<RECTANGLE> note_rectangles()
+    {
+        std::vector<RECTANGLE> result;
+
+        for (unsigned i = 0; i != RECTANGLES; ++i)
+        {
+            unsigned width = 24 + (i * 37) % 360;
+
+            result.push_back(RECTANGLE{ (i * 389) % (WIDTH - width), ((i * 13) % 128) * NOTE_HEIGHT, width });
+        }
+
+        return result;
+    }
+
+    uint64_t pixel_count(const std::vector<RECTANGLE>& rectangles)
+    {
+        uint64_t result = 0;
+
+        for (auto& r : rectangles)
+        {
+            result += uint64_t(r.width) * NOTE_HEIGHT;
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("Note rectangle fill rate", "[.benchmark]")
+{
+    auto rectangles = note_rectangles();
+    uint64_t pixels = pixel_count(rectangles);
+    RGBA8 color(200, 100, 50);
+    RGBA8Bitmap bitmap(WIDTH, HEIGHT);
+
+    // Column-major loop through Bitmap::operator[], as draw_rectangle in app.cpp used to do
+    double old_rate = benchmarks::measure("Column-major operator[]", "pixels", pixels, 5, [&]() {
+        for (auto& r : rectangles)
+        {
+            for (unsigned x = r.x; x != r.x + r.width; ++x)
+            {
+                for (unsigned y = r.y; y != r.y + NOTE_HEIGHT; ++y)
+                {
+                    bitmap[Position(x, y)] = color;
+                }
+            }
+        }
+    });
+
+    benchmarks::measure("Row-major scalar", "pixels", pixels, 20, [&]() {
+        for (auto& r : rectangles)
+        {
+            for (unsigned y = r.y; y != r.y + NOTE_HEIGHT; ++y)
+            {
+                details::fill_row_scalar(bitmap.row(y) + r.x, r.width, color);
+            }
+        }
+    });
+
+    double new_rate = benchmarks::measure("fill_rect", "pixels", pixels, 20, [&]() {
+        for (auto& r : rectangles)
+        {
+            fill_rect(bitmap.view(), r.x, r.y, r.width, NOTE_HEIGHT, color);
+        }
+    });
+
+    std::cout << "speedup: " << new_rate / old_rate << "x" << std::endl;
+}
+
+TEST_CASE("Whole roll drawing", "[.benchmark]")
+{
+    std::vector<midi::NOTE> notes;
+    for (unsigned i = 0; i != 200000; ++i)
+    {
+        notes.push_back(midi::NOTE(midi::NoteNumber(uint8_t(20 + (i * 7) % 90)), midi::Time(uint64_t(i) * 40), midi::Duration(60 + (i * 13) % 300), 127, midi::Instrument(uint8_t(i % 16))));
+    }
+    unsigned scale = 2;
+    unsigned note_height = 4;
+    RGBA8Bitmap bitmap(unsigned(uint64_t(notes.size()) * 40 * scale / 100 + 100), 128 * note_height);
+
+    // The loop app.cpp used: one pass over all notes for each of the 128 pitches
+    double old_rate = benchmarks::measure("128 passes", "notes", notes.size(), 3, [&]() {
+        for (int i = 0; i <= 127; i++)
+        {
+            for (const midi::NOTE& note : notes)
+            {
+                if (note.note_number == midi::NoteNumber(i))
+                {
+                    fill_rect(bitmap.view(), int64_t(uint32_t(value(note.start) * (scale / 100.0))), (127 - i) * note_height,
+                        uint32_t(value(note.duration) * (scale / 100.0)), note_height, instrument_color(note.instrument));
+                }
+            }
+        }
+    });
+
+    double new_rate = benchmarks::measure("draw_note_rows", "notes", notes.size(), 3, [&]() {
+        draw_note_rows(bitmap.view(), notes, scale, note_height, 0);
+    });
+
+    std::cout << "speedup: " << new_rate / old_rate << "x" << std::endl;
+}
+
+TEST_CASE("Blit rate", "[.benchmark]")
+{
+    RGBA8Bitmap source(1920, 1080);
+    RGBA8Bitmap target(1920, 1080);
+
+    benchmarks::measure("blit 1920x1080", "pixels", uint64_t(1920) * 1080, 50, [&]() {
+        blit(target.view(), 0, 0, source.view());
+    });
+}
+
+#endif
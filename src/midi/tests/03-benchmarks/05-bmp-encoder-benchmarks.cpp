@@ -0,0 +1,114 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/drawing.h"
+#include "imaging/framebuffer.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <sstream>
+
+
+using namespace imaging;
+
+
+namespace
+{
+    const unsigned FRAME_WIDTH = 1920;
+    const unsigned FRAME_HEIGHT = 1080;
+    const unsigned FRAMES = 30;
+
+    // Header plus one write per row, each pixel fetched through operator[], as save_as_bmp used to do
+    void save_row_by_row(std::ostream& out, const RGBA8Bitmap& bitmap)
+    {
+        char header[138] = { 0 };
+        out.write(header, sizeof(header));
+
+        std::unique_ptr<RGBA8[]> scanline = std::make_unique<RGBA8[]>(bitmap.width());
+
+        for (int y = bitmap.height() - 1; y >= 0; --y)
+        {
+            for (unsigned x = 0; x < bitmap.width(); ++x)
+            {
+                scanline[x] = to_rgba8(bitmap[Position(x, y)]);
+            }
+
+            out.write(reinterpret_cast<char*>(scanline.get()), sizeof(RGBA8) * bitmap.width());
+        }
+    }
+
+    template<typename SAVE>
+    double measure_frames(const std::string& name, const RGBA8Bitmap& song, SAVE save)
+    {
+        std::stringstream out;
+
+        return benchmarks::measure(name, "frames", FRAMES, 3, [&]() {
+            for (unsigned i = 0; i != FRAMES; ++i)
+            {
+                out.str(std::string());
+                save(out, *song.slice(i * 16, 0, FRAME_WIDTH, FRAME_HEIGHT));
+            }
+            benchmarks::keep(uint64_t(out.tellp()));
+        });
+    }
+}
+
+TEST_CASE("BMP frame export rate", "[.benchmark]")
+{
+    RGBA8Bitmap song(FRAME_WIDTH + FRAMES * 16, FRAME_HEIGHT, [](const Position& p) { return RGBA8(uint8_t(p.x), uint8_t(p.y), 0); });
+    BmpEncoder encoder32(BmpFormat::BGRA32);
+    BmpEncoder encoder24(BmpFormat::BGR24);
+
+    double old_rate = measure_frames("Row by row", song, save_row_by_row);
+    double new_rate = measure_frames("BmpEncoder BGRA32", song, [&](std::ostream& out, const RGBA8Bitmap& frame) { encoder32.write(out, frame); });
+    measure_frames("BmpEncoder BGR24", song, [&](std::ostream& out, const RGBA8Bitmap& frame) { encoder24.write(out, frame); });
+
+    std::cout << "speedup: " << new_rate / old_rate << "x" << std::endl;
+}
+
+TEST_CASE("Indexed frame encoding rate", "[.benchmark]")
+{
+    unsigned song_width = FRAME_WIDTH + FRAMES * 16;
+    Framebuffer<uint8_t> indices(song_width, FRAME_HEIGHT);
+    indices.view().for_each_row([song_width](unsigned y, uint8_t* row) {
+        for (unsigned x = 0; x != song_width; ++x)
+        {
+            row[x] = uint8_t((x / 64 + y / 16) % 5);
+        }
+    });
+    Palette palette;
+    for (unsigned i = 0; i != palette.size(); ++i)
+    {
+        palette[i] = RGBA8(uint8_t(i * 40), uint8_t(i * 90), uint8_t(i * 13));
+    }
+    Framebuffer<RGBA8> colors(song_width, FRAME_HEIGHT);
+    apply_palette(colors.view(), indices.view(), palette);
+
+    std::cout << "song raster: " << size_t(song_width) * FRAME_HEIGHT * sizeof(RGBA8) << " bytes as RGBA8, "
+        << size_t(song_width) * FRAME_HEIGHT << " bytes as indices" << std::endl;
+
+    auto measure_encoder = [&](const std::string& name, BmpFormat format, bool indexed) {
+        BmpEncoder encoder(format);
+
+        return benchmarks::measure(name, "frames", FRAMES, 3, [&]() {
+            size_t size = 0;
+            for (unsigned i = 0; i != FRAMES; ++i)
+            {
+                size += indexed
+                    ? encoder.encode(FramebufferView<const uint8_t>(indices.view().sub_view(i * 16, 0, FRAME_WIDTH, FRAME_HEIGHT)), palette).size()
+                    : encoder.encode(colors.view().sub_view(i * 16, 0, FRAME_WIDTH, FRAME_HEIGHT)).size();
+            }
+            benchmarks::keep(uint64_t(size));
+        });
+    };
+
+    double rgba_rate = measure_encoder("RGBA8 to BGRA32", BmpFormat::BGRA32, false);
+    double lookup_rate = measure_encoder("Indices to BGRA32", BmpFormat::BGRA32, true);
+    double indexed_rate = measure_encoder("Indices to INDEXED8", BmpFormat::INDEXED8, true);
+
+    std::cout << "palette lookup: " << lookup_rate / rgba_rate << "x, 8-bit files: " << indexed_rate / rgba_rate << "x" << std::endl;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/frame-export.h"
+#include "imaging/piano-roll.h"
+#include "util/parallel.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <atomic>
+#include <random>
+
+
+using namespace imaging;
+
+
+TEST_CASE("Parallel frame export rate", "[.benchmark]")
+{
+    const unsigned FRAME_WIDTH = 1280;
+    const unsigned FRAMES = 512;
+    RGBA8Bitmap song(FRAME_WIDTH + FRAMES, 720, [](const Position& p) { return RGBA8(uint8_t(p.x), uint8_t(p.y), 0); });
+    std::atomic<uint64_t> bytes(0);
+    FrameSink sink = [&bytes](size_t, const std::vector<uint8_t>& file) { bytes += file.size(); };
+
+    double single = 0;
+    for (unsigned threads = 1; threads <= default_thread_count(); threads *= 2)
+    {
+        double rate = benchmarks::measure("export_frames, " + std::to_string(threads) + " threads", "frames", FRAMES, 2, [&]() {
+            export_frames(song.view(), FRAME_WIDTH, 1, BmpFormat::BGRA32, threads, sink);
+        });
+
+        if (threads == 1)
+        {
+            single = rate;
+        }
+
+        std::cout << "  speedup: " << rate / single << "x" << std::endl;
+    }
+
+    benchmarks::keep(uint64_t(bytes));
+}
+
+TEST_CASE("Scrolling frame export rate", "[.benchmark]")
+{
+    const unsigned FRAME_WIDTH = 1280;
+    const unsigned NOTE_HEIGHT = 8;
+    const unsigned FRAMES = 1000;
+    std::mt19937 random(1);
+    std::vector<midi::NOTE> notes;
+
+    for (unsigned i = 0; i != 5000; ++i)
+    {
+        notes.push_back(midi::NOTE(midi::NoteNumber(uint8_t(36 + random() % 48)), midi::Time(i * 20), midi::Duration(20 + random() % 200), 100, midi::Instrument(uint8_t(random() % 128))));
+    }
+
+    PianoRoll roll(notes, 100, NOTE_HEIGHT);
+    unsigned height = 48 * NOTE_HEIGHT;
+    int64_t top = (128 - 84) * NOTE_HEIGHT;
+    std::atomic<uint64_t> bytes(0);
+    FrameSink sink = [&bytes](size_t, const std::vector<uint8_t>& file) { bytes += file.size(); };
+    unsigned width = FRAME_WIDTH + FRAMES - 1;
+
+    double full = benchmarks::measure("Full redraw per frame", "frames", FRAMES, 2, [&]() {
+        export_frames(FRAMES, FRAME_WIDTH, height, [&](size_t frame, const FramebufferView<RGBA8>& target) {
+            roll.render(target, int64_t(frame), top);
+        }, BmpFormat::BGRA32, 1, sink);
+    });
+
+    double scrolling = benchmarks::measure("Scrolling framebuffer", "frames", FRAMES, 2, [&]() {
+        export_scrolling_frames(width, FRAME_WIDTH, height, 1, [&](const FramebufferView<RGBA8>& target, int64_t x) {
+            roll.render(target, x, top);
+        }, BmpFormat::BGRA32, 1, sink);
+    });
+
+    std::cout << "speedup: " << scrolling / full << "x" << std::endl;
+    benchmarks::keep(uint64_t(bytes));
+}
+
+#endif
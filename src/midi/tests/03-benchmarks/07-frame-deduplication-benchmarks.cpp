@@ -0,0 +1,43 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/frame-deduplication.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+
+
+using namespace imaging;
+
+
+namespace
+{
+    const unsigned FRAME_WIDTH = 1920;
+    const unsigned FRAME_HEIGHT = 1080;
+    const unsigned FRAMES = 30;
+}
+
+TEST_CASE("Frame hashing versus encoding", "[.benchmark]")
+{
+    RGBA8Bitmap song(FRAME_WIDTH + FRAMES * 16, FRAME_HEIGHT, [](const Position& p) { return RGBA8(uint8_t(p.x), uint8_t(p.y), 0); });
+    BmpEncoder encoder(BmpFormat::BGR24);
+
+    double encode_rate = benchmarks::measure("BmpEncoder BGR24", "frames", FRAMES, 3, [&]() {
+        for (unsigned i = 0; i != FRAMES; ++i)
+        {
+            benchmarks::keep(uint64_t(encoder.encode(song.view().sub_view(i * 16, 0, FRAME_WIDTH, FRAME_HEIGHT)).size()));
+        }
+    });
+    double hash_rate = benchmarks::measure("frame_hash", "frames", FRAMES, 3, [&]() {
+        for (unsigned i = 0; i != FRAMES; ++i)
+        {
+            benchmarks::keep(frame_hash(song.view().sub_view(i * 16, 0, FRAME_WIDTH, FRAME_HEIGHT)));
+        }
+    });
+
+    std::cout << "hashing a frame takes " << encode_rate / hash_rate << " of the time of encoding it" << std::endl;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/framebuffer.h"
+#include "imaging/piano-roll.h"
+#include "imaging/roll-image.h"
+#include "tests/benchmarks-util.h"
+#include "Catch.h"
+#include <random>
+#include <vector>
+
+
+using namespace imaging;
+
+
+namespace
+{
+    const unsigned FRAME_WIDTH = 1920;
+    const unsigned NOTE_HEIGHT = 8;
+    const unsigned FRAMES = 30;
+
+    std::vector<midi::NOTE> dense_song(unsigned count)
+    {
+        std::mt19937 random(3);
+        std::vector<midi::NOTE> notes;
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            uint64_t start = uint64_t(i) * 20 + random() % 40;
+            notes.push_back(midi::NOTE(midi::NoteNumber(uint8_t(30 + random() % 70)), midi::Time(start), midi::Duration(50 + random() % 400), 127, midi::Instrument(uint8_t(random() % 16))));
+        }
+
+        return notes;
+    }
+}
+
+TEST_CASE("RollImage window rendering", "[.benchmark]")
+{
+    std::vector<midi::NOTE> notes = dense_song(100000);
+    RollImage roll(notes);
+    Palette palette = instrument_palette();
+    Framebuffer<RGBA8> frame(FRAME_WIDTH, 128 * NOTE_HEIGHT);
+
+    std::cout << "spans: " << roll.span_count() * sizeof(NOTE_SPAN) << " bytes, roll at 100%: "
+        << roll.width(100) * 128 * NOTE_HEIGHT * sizeof(RGBA8) << " bytes of RGBA8 pixels" << std::endl;
+
+    for (unsigned scale : { 10u, 100u })
+    {
+        PianoRoll piano_roll(notes, scale, NOTE_HEIGHT);
+        uint64_t step = (roll.width(scale) - FRAME_WIDTH) / FRAMES;
+
+        double piano_roll_rate = benchmarks::measure("PianoRoll at " + std::to_string(scale) + "%", "frames", FRAMES, 3, [&]() {
+            for (unsigned i = 0; i != FRAMES; ++i)
+            {
+                piano_roll.render(frame.view(), int64_t(i * step), 0);
+            }
+            benchmarks::keep(frame.view()[Position(0, 0)].r);
+        });
+        double roll_rate = benchmarks::measure("RollImage at " + std::to_string(scale) + "%", "frames", FRAMES, 3, [&]() {
+            for (unsigned i = 0; i != FRAMES; ++i)
+            {
+                roll.render(frame.view(), int64_t(i * step), 0, scale, NOTE_HEIGHT, palette);
+            }
+            benchmarks::keep(frame.view()[Position(0, 0)].r);
+        });
+
+        std::cout << "speedup: " << roll_rate / piano_roll_rate << "x" << std::endl;
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/pixel-format.h"
+#include "util/check-size.h"
+#include "Catch.h"
+#include <sstream>
+#include <string>
+
+using namespace imaging;
+
+
+namespace
+{
+    Color pattern(const Position& p)
+    {
+        return Color((p.x % 5) / 4.0, (p.y % 3) / 2.0, ((p.x + p.y) % 7) / 6.0);
+    }
+
+    template<typename PIXEL>
+    std::string encode_pattern(unsigned width, unsigned height)
+    {
+        BasicBitmap<PIXEL> bitmap(width, height, [](const Position& p) { return from_color<PIXEL>(pattern(p)); });
+        std::stringstream out;
+
+        save_as_bmp(out, bitmap);
+
+        return out.str();
+    }
+}
+
+TEST_CASE("Checking pixel format sizes")
+{
+    check_size<RGBA8, 4>();
+    check_size<RGBF32, 12>();
+}
+
+TEST_CASE("RGBA8 is stored in BMP channel order")
+{
+    RGBA8 pixel(1, 2, 3);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pixel);
+
+    CATCH_CHECK(bytes[0] == 3);
+    CATCH_CHECK(bytes[1] == 2);
+    CATCH_CHECK(bytes[2] == 1);
+    CATCH_CHECK(bytes[3] == 255);
+}
+
+TEST_CASE("Converting Color to RGBA8 truncates channels")
+{
+    CATCH_CHECK(from_color<RGBA8>(colors::white()) == RGBA8(255, 255, 255));
+    CATCH_CHECK(from_color<RGBA8>(colors::orange()) == RGBA8(255, 163, 0));
+    CATCH_CHECK(from_color<RGBA8>(Color(0.5, 0.25, 0)) == RGBA8(127, 63, 0));
+}
+
+TEST_CASE("Converting between pixel formats")
+{
+    CATCH_CHECK(to_color(RGBA8(255, 0, 255)) == colors::magenta());
+    CATCH_CHECK(to_rgba8(RGBF32(1, 0.5f, 0)) == RGBA8(255, 127, 0));
+    CATCH_CHECK(to_color(from_color<RGBF32>(colors::cyan())) == colors::cyan());
+}
+
+TEST_CASE("New bitmaps are black in every pixel format")
+{
+    RGBA8Bitmap rgba8(3, 2);
+    RGBF32Bitmap rgbf32(3, 2);
+
+    CATCH_CHECK(rgba8[Position(2, 1)] == RGBA8(0, 0, 0));
+    CATCH_CHECK(rgbf32[Position(2, 1)] == RGBF32(0, 0, 0));
+}
+
+TEST_CASE("Slicing an RGBA8 bitmap shares its pixels")
+{
+    RGBA8Bitmap bitmap(4, 4);
+    auto slice = bitmap.slice(1, 2, 2, 2);
+
+    (*slice)[Position(1, 1)] = RGBA8(9, 8, 7);
+
+    CATCH_CHECK(bitmap[Position(2, 3)] == RGBA8(9, 8, 7));
+}
+
+TEST_CASE("save_as_bmp writes the same file for every pixel format")
+{
+    std::string color = encode_pattern<Color>(13, 7);
+
+    CATCH_CHECK(encode_pattern<RGBA8>(13, 7) == color);
+    CATCH_CHECK(encode_pattern<RGBF32>(13, 7) == color);
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "Catch.h"
+#include <sstream>
+#include <string>
+
+using namespace imaging;
+
+
+namespace
+{
+    RGBA8 pattern(const Position& p)
+    {
+        return RGBA8(uint8_t(p.x), uint8_t(p.y), uint8_t(p.x + p.y));
+    }
+}
+
+TEST_CASE("Framebuffer is initialized to the given value")
+{
+    Framebuffer<RGBA8> framebuffer(5, 3, RGBA8(1, 2, 3));
+
+    CATCH_CHECK(framebuffer.width() == 5);
+    CATCH_CHECK(framebuffer.height() == 3);
+    CATCH_CHECK(framebuffer.view().stride() == 5);
+    CATCH_CHECK(framebuffer.view().is_contiguous());
+    framebuffer.view().for_each_pixel([](const RGBA8& pixel) { CATCH_CHECK(pixel == RGBA8(1, 2, 3)); });
+}
+
+TEST_CASE("FramebufferView rows are stride pixels apart")
+{
+    Framebuffer<RGBA8> framebuffer(8, 4);
+    FramebufferView<RGBA8> view = framebuffer.view();
+
+    CATCH_CHECK(view.row(0) == view.data());
+    CATCH_CHECK(view.row(3) == view.data() + 24);
+    CATCH_CHECK(&view[Position(5, 2)] == view.data() + 21);
+}
+
+TEST_CASE("FramebufferView sub_view shares pixels with its parent")
+{
+    Framebuffer<RGBA8> framebuffer(8, 6);
+    FramebufferView<RGBA8> sub = framebuffer.view().sub_view(2, 1, 3, 4);
+
+    CATCH_CHECK(sub.width() == 3);
+    CATCH_CHECK(sub.height() == 4);
+    CATCH_CHECK(sub.stride() == 8);
+    CATCH_CHECK(!sub.is_contiguous());
+
+    sub[Position(0, 0)] = RGBA8(9, 9, 9);
+    CATCH_CHECK(framebuffer.view()[Position(2, 1)] == RGBA8(9, 9, 9));
+
+    FramebufferView<RGBA8> nested = sub.sub_view(1, 2, 2, 2);
+    nested[Position(1, 1)] = RGBA8(7, 7, 7);
+    CATCH_CHECK(framebuffer.view()[Position(4, 4)] == RGBA8(7, 7, 7));
+}
+
+TEST_CASE("FramebufferView for_each_row visits rows top to bottom")
+{
+    Framebuffer<RGBA8> framebuffer(4, 5);
+    FramebufferView<RGBA8> sub = framebuffer.view().sub_view(1, 2, 2, 3);
+    unsigned expected_y = 0;
+
+    sub.for_each_row([&](unsigned y, RGBA8* row) {
+        CATCH_CHECK(y == expected_y);
+        CATCH_CHECK(row == framebuffer.view().row(y + 2) + 1);
+        ++expected_y;
+    });
+    CATCH_CHECK(expected_y == 3);
+}
+
+TEST_CASE("FramebufferView fill only touches the pixels inside the view")
+{
+    Framebuffer<RGBA8> framebuffer(6, 5);
+    framebuffer.view().sub_view(1, 1, 3, 2).fill(RGBA8(255, 0, 0));
+
+    for (unsigned y = 0; y != 5; ++y)
+    {
+        for (unsigned x = 0; x != 6; ++x)
+        {
+            bool inside = 1 <= x && x < 4 && 1 <= y && y < 3;
+            RGBA8 expected = inside ? RGBA8(255, 0, 0) : RGBA8();
+
+            CATCH_CHECK(framebuffer.view()[Position(x, y)] == expected);
+        }
+    }
+}
+
+TEST_CASE("FramebufferView copy_from copies between strided views")
+{
+    Framebuffer<RGBA8> source(7, 7);
+    Framebuffer<RGBA8> target(5, 5);
+
+    source.view().for_each_row([](unsigned y, RGBA8* row) {
+        for (unsigned x = 0; x != 7; ++x)
+        {
+            row[x] = pattern(Position(x, y));
+        }
+    });
+
+    FramebufferView<const RGBA8> from = source.view().sub_view(3, 2, 3, 4);
+    target.view().sub_view(1, 0, 3, 4).copy_from(from);
+
+    for (unsigned y = 0; y != 4; ++y)
+    {
+        for (unsigned x = 0; x != 3; ++x)
+        {
+            CATCH_CHECK(target.view()[Position(x + 1, y)] == pattern(Position(x + 3, y + 2)));
+        }
+    }
+    CATCH_CHECK(target.view()[Position(0, 0)] == RGBA8());
+    CATCH_CHECK(target.view()[Position(1, 4)] == RGBA8());
+}
+
+TEST_CASE("Bitmap rows and views reflect slices")
+{
+    RGBA8Bitmap bitmap(10, 8, pattern);
+    auto slice = bitmap.slice(3, 2, 4, 5);
+
+    CATCH_CHECK(slice->row(0) == bitmap.row(2) + 3);
+    CATCH_CHECK(slice->view().stride() == 10);
+
+    slice->clear(RGBA8(1, 1, 1));
+    CATCH_CHECK(bitmap[Position(3, 2)] == RGBA8(1, 1, 1));
+    CATCH_CHECK(bitmap[Position(6, 6)] == RGBA8(1, 1, 1));
+    CATCH_CHECK(bitmap[Position(2, 2)] == pattern(Position(2, 2)));
+    CATCH_CHECK(bitmap[Position(7, 6)] == pattern(Position(7, 6)));
+    CATCH_CHECK(bitmap[Position(3, 7)] == pattern(Position(3, 7)));
+}
+
+TEST_CASE("Bitmap for_each_position visits every position once")
+{
+    RGBA8Bitmap bitmap(4, 3);
+    auto slice = bitmap.slice(1, 1, 2, 2);
+    unsigned count = 0;
+
+    slice->for_each_position([&](const Position& p) {
+        CATCH_CHECK(slice->is_inside(p));
+        ++count;
+    });
+    CATCH_CHECK(count == 4);
+}
+
+TEST_CASE("Saving a slice as BMP gives the same file as saving a copy")
+{
+    RGBA8Bitmap bitmap(20, 15, pattern);
+    auto slice = bitmap.slice(5, 4, 9, 7);
+    RGBA8Bitmap copy(9, 7, [](const Position& p) { return pattern(Position(p.x + 5, p.y + 4)); });
+    std::stringstream sliced, copied;
+
+    save_as_bmp(sliced, *slice);
+    save_as_bmp(copied, copy);
+
+    CATCH_CHECK(sliced.str() == copied.str());
+}
+
+TEST_CASE("BMP rows are written bottom-up")
+{
+    RGBA8Bitmap bitmap(2, 2);
+    bitmap[Position(0, 0)] = RGBA8(10, 20, 30);
+    bitmap[Position(1, 1)] = RGBA8(40, 50, 60);
+    std::stringstream out;
+
+    save_as_bmp(out, bitmap);
+    std::string bytes = out.str();
+    std::string pixels = bytes.substr(bytes.size() - 16);
+
+    // Bottom row first: (0, 1) black, (1, 1); then top row: (0, 0), (1, 0) black
+    CATCH_CHECK(pixels == std::string("\0\0\0\xFF" "\x3C\x32\x28\xFF" "\x1E\x14\x0A\xFF" "\0\0\0\xFF", 16));
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/drawing.h"
+#include "imaging/framebuffer.h"
+#include "imaging/pixel-format.h"
+#include "Catch.h"
+
+using namespace imaging;
+
+
+namespace
+{
+    RGBA8 pattern(unsigned x, unsigned y)
+    {
+        return RGBA8(uint8_t(x), uint8_t(y), uint8_t(x * 7 + y));
+    }
+
+    void fill_pattern(const FramebufferView<RGBA8>& view)
+    {
+        view.for_each_row([&view](unsigned y, RGBA8* row) {
+            for (unsigned x = 0; x != view.width(); ++x)
+            {
+                row[x] = pattern(x, y);
+            }
+        });
+    }
+
+    bool inside(int64_t x, int64_t y, int64_t left, int64_t top, int64_t width, int64_t height)
+    {
+        return left <= x && x < left + width && top <= y && y < top + height;
+    }
+
+    void check_fill(int64_t left, int64_t top, int64_t width, int64_t height)
+    {
+        Framebuffer<RGBA8> framebuffer(37, 20);
+        RGBA8 color(1, 2, 3, 4);
+
+        fill_rect(framebuffer.view(), left, top, width, height, color);
+
+        for (unsigned y = 0; y != 20; ++y)
+        {
+            for (unsigned x = 0; x != 37; ++x)
+            {
+                RGBA8 expected = inside(x, y, left, top, width, height) ? color : RGBA8();
+
+                CATCH_CHECK(framebuffer.view()[Position(x, y)] == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("fill_row fills exactly count pixels for every length")
+{
+    RGBA8 color(10, 20, 30, 40);
+
+    for (size_t count = 0; count != 70; ++count)
+    {
+        for (size_t offset = 0; offset != 3; ++offset)
+        {
+            RGBA8 simd[80], scalar[80];
+
+            details::fill_row(simd + offset, count, color);
+            details::fill_row_scalar(scalar + offset, count, color);
+
+            for (size_t i = 0; i != 80; ++i)
+            {
+                bool filled = offset <= i && i < offset + count;
+
+                CATCH_CHECK(simd[i] == (filled ? color : RGBA8()));
+                CATCH_CHECK(scalar[i] == simd[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("fill_rect inside the framebuffer")
+{
+    check_fill(3, 2, 20, 16);
+    check_fill(0, 0, 37, 20);
+    check_fill(36, 19, 1, 1);
+}
+
+TEST_CASE("fill_rect clips to the framebuffer")
+{
+    check_fill(-5, 4, 10, 3);
+    check_fill(30, -2, 20, 5);
+    check_fill(-10, -10, 100, 100);
+    check_fill(30, 15, 20, 20);
+}
+
+TEST_CASE("fill_rect outside the framebuffer or empty does nothing")
+{
+    check_fill(-10, 0, 10, 5);
+    check_fill(37, 0, 3, 3);
+    check_fill(0, 20, 3, 3);
+    check_fill(0, -3, 3, 3);
+    check_fill(4, 4, 0, 5);
+    check_fill(4, 4, 5, 0);
+}
+
+TEST_CASE("fill_rect on a sub view stays within the view")
+{
+    Framebuffer<RGBA8> framebuffer(10, 10);
+    FramebufferView<RGBA8> view = framebuffer.view().sub_view(2, 3, 4, 4);
+
+    fill_rect(view, -1, -1, 10, 2, RGBA8(9, 9, 9));
+
+    for (unsigned y = 0; y != 10; ++y)
+    {
+        for (unsigned x = 0; x != 10; ++x)
+        {
+            RGBA8 expected = inside(x, y, 2, 3, 4, 1) ? RGBA8(9, 9, 9) : RGBA8();
+
+            CATCH_CHECK(framebuffer.view()[Position(x, y)] == expected);
+        }
+    }
+}
+
+TEST_CASE("fill_rect works on other pixel formats")
+{
+    Framebuffer<RGBF32> framebuffer(4, 4);
+
+    fill_rect(framebuffer.view(), 1, 1, 2, 2, RGBF32(0.5f, 0.25f, 1));
+
+    CATCH_CHECK(framebuffer.view()[Position(1, 2)] == RGBF32(0.5f, 0.25f, 1));
+    CATCH_CHECK(framebuffer.view()[Position(3, 2)] == RGBF32());
+}
+
+TEST_CASE("blit copies a source view to the given position")
+{
+    Framebuffer<RGBA8> source(5, 4);
+    Framebuffer<RGBA8> target(12, 10);
+    fill_pattern(source.view());
+
+    blit(target.view(), 3, 2, source.view());
+
+    for (unsigned y = 0; y != 10; ++y)
+    {
+        for (unsigned x = 0; x != 12; ++x)
+        {
+            RGBA8 expected = inside(x, y, 3, 2, 5, 4) ? pattern(x - 3, y - 2) : RGBA8();
+
+            CATCH_CHECK(target.view()[Position(x, y)] == expected);
+        }
+    }
+}
+
+TEST_CASE("blit clips the source to the target")
+{
+    Framebuffer<RGBA8> source(6, 6);
+    Framebuffer<RGBA8> target(8, 8);
+    fill_pattern(source.view());
+
+    blit(target.view(), -2, 5, source.view());
+
+    for (unsigned y = 0; y != 8; ++y)
+    {
+        for (unsigned x = 0; x != 8; ++x)
+        {
+            RGBA8 expected = inside(x, y, 0, 5, 4, 3) ? pattern(x + 2, y - 5) : RGBA8();
+
+            CATCH_CHECK(target.view()[Position(x, y)] == expected);
+        }
+    }
+
+    blit(target.view(), 8, 0, source.view());
+    blit(target.view(), -6, 0, source.view());
+    CATCH_CHECK(target.view()[Position(0, 0)] == RGBA8());
+}
+
+TEST_CASE("copy_rows copies whole rows between framebuffers")
+{
+    Framebuffer<RGBA8> source(6, 5);
+    Framebuffer<RGBA8> target(4, 5);
+    fill_pattern(source.view());
+
+    copy_rows(target.view(), 1, source.view(), 2, 10);
+
+    for (unsigned y = 0; y != 5; ++y)
+    {
+        for (unsigned x = 0; x != 4; ++x)
+        {
+            RGBA8 expected = (1 <= y && y < 4) ? pattern(x, y + 1) : RGBA8();
+
+            CATCH_CHECK(target.view()[Position(x, y)] == expected);
+        }
+    }
+}
+
+TEST_CASE("copy_rows handles overlapping rows within one framebuffer")
+{
+    Framebuffer<RGBA8> framebuffer(3, 8);
+    fill_pattern(framebuffer.view());
+
+    // Scroll down by two rows
+    copy_rows(framebuffer.view(), 2, framebuffer.view(), 0, 6);
+    for (unsigned y = 2; y != 8; ++y)
+    {
+        CATCH_CHECK(framebuffer.view()[Position(1, y)] == pattern(1, y - 2));
+    }
+
+    // And back up again
+    copy_rows(framebuffer.view(), 0, framebuffer.view(), 2, 6);
+    for (unsigned y = 0; y != 6; ++y)
+    {
+        CATCH_CHECK(framebuffer.view()[Position(1, y)] == pattern(1, y));
+    }
+}
+
+TEST_CASE("copy_rows handles horizontally shifted views on one framebuffer")
+{
+    Framebuffer<RGBA8> framebuffer(10, 1);
+    fill_pattern(framebuffer.view());
+
+    copy_rows(framebuffer.view().sub_view(2, 0, 8, 1), 0, framebuffer.view().sub_view(0, 0, 8, 1), 0, 1);
+
+    for (unsigned x = 2; x != 10; ++x)
+    {
+        CATCH_CHECK(framebuffer.view()[Position(x, 0)] == pattern(x - 2, 0));
+    }
+}
+
+#endif
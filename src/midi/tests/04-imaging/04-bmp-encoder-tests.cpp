@@ -0,0 +1,148 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/pixel-format.h"
+#include "Catch.h"
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace imaging;
+
+
+namespace
+{
+    const size_t HEADER_SIZE = 14 + 124;
+
+    RGBA8 pattern(const Position& p)
+    {
+        return RGBA8(uint8_t(p.x * 10), uint8_t(p.y * 20), uint8_t(p.x + p.y));
+    }
+
+    template<typename T>
+    T field(const std::vector<uint8_t>& file, size_t offset)
+    {
+        T result;
+        std::memcpy(&result, file.data() + offset, sizeof(T));
+        return result;
+    }
+}
+
+TEST_CASE("BmpEncoder file sizes")
+{
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::BGRA32, 3, 2) == HEADER_SIZE + 24);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::BGR24, 3, 2) == HEADER_SIZE + 24);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::BGR24, 4, 2) == HEADER_SIZE + 24);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::BGR24, 5, 2) == HEADER_SIZE + 32);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::BGR24, 1, 1) == HEADER_SIZE + 4);
+}
+
+TEST_CASE("BmpEncoder BGRA32 output equals save_as_bmp")
+{
+    RGBA8Bitmap bitmap(7, 5, pattern);
+    BmpEncoder encoder;
+    std::stringstream out;
+
+    save_as_bmp(out, bitmap);
+    const std::vector<uint8_t>& file = encoder.encode(bitmap.view());
+
+    CATCH_CHECK(std::string(file.begin(), file.end()) == out.str());
+    CATCH_CHECK(field<uint16_t>(file, 28) == 32);
+}
+
+TEST_CASE("BmpEncoder BGR24 header")
+{
+    RGBA8Bitmap bitmap(5, 3, pattern);
+    BmpEncoder encoder(BmpFormat::BGR24);
+    const std::vector<uint8_t>& file = encoder.encode(bitmap.view());
+
+    CATCH_REQUIRE(file.size() == HEADER_SIZE + 3 * 16);
+    CATCH_CHECK(file[0] == 'B');
+    CATCH_CHECK(file[1] == 'M');
+    CATCH_CHECK(field<uint32_t>(file, 2) == file.size());
+    CATCH_CHECK(field<uint32_t>(file, 10) == HEADER_SIZE);
+    CATCH_CHECK(field<int32_t>(file, 18) == 5);
+    CATCH_CHECK(field<int32_t>(file, 22) == 3);
+    CATCH_CHECK(field<uint16_t>(file, 28) == 24);
+    CATCH_CHECK(field<uint32_t>(file, 30) == 0);
+}
+
+TEST_CASE("BmpEncoder BGR24 rows are bottom-up, BGR and padded with zeros")
+{
+    RGBA8Bitmap bitmap(5, 3, pattern);
+    BmpEncoder encoder(BmpFormat::BGR24);
+    const std::vector<uint8_t>& file = encoder.encode(bitmap.view());
+
+    for (unsigned y = 0; y != 3; ++y)
+    {
+        const uint8_t* row = file.data() + HEADER_SIZE + (2 - y) * 16;
+
+        for (unsigned x = 0; x != 5; ++x)
+        {
+            RGBA8 expected = pattern(Position(x, y));
+
+            CATCH_CHECK(row[3 * x + 0] == expected.b);
+            CATCH_CHECK(row[3 * x + 1] == expected.g);
+            CATCH_CHECK(row[3 * x + 2] == expected.r);
+        }
+
+        CATCH_CHECK(row[15] == 0);
+    }
+}
+
+TEST_CASE("BmpEncoder encodes slices like copies")
+{
+    RGBA8Bitmap bitmap(20, 10, pattern);
+    auto slice = bitmap.slice(3, 2, 7, 5);
+    RGBA8Bitmap copy(7, 5, [](const Position& p) { return pattern(Position(p.x + 3, p.y + 2)); });
+
+    for (BmpFormat format : { BmpFormat::BGRA32, BmpFormat::BGR24 })
+    {
+        BmpEncoder encoder(format);
+        std::vector<uint8_t> sliced = encoder.encode(slice->view());
+        std::vector<uint8_t> copied = encoder.encode(copy.view());
+
+        CATCH_CHECK(sliced == copied);
+    }
+}
+
+TEST_CASE("BmpEncoder converts other pixel formats")
+{
+    Bitmap bitmap(6, 4, [](const Position& p) { return to_color(pattern(p)); });
+    RGBA8Bitmap expected(6, 4, [](const Position& p) { return to_rgba8(to_color(pattern(p))); });
+
+    for (BmpFormat format : { BmpFormat::BGRA32, BmpFormat::BGR24 })
+    {
+        BmpEncoder color_encoder(format), rgba8_encoder(format);
+
+        CATCH_CHECK(color_encoder.encode(bitmap.view()) == rgba8_encoder.encode(expected.view()));
+    }
+}
+
+TEST_CASE("BmpEncoder reuses its buffer for frames of the same size")
+{
+    RGBA8Bitmap bitmap(64, 16, pattern);
+    BmpEncoder encoder(BmpFormat::BGR24);
+
+    const uint8_t* first = encoder.encode(bitmap.slice(0, 0, 32, 16)->view()).data();
+    const uint8_t* second = encoder.encode(bitmap.slice(32, 0, 32, 16)->view()).data();
+
+    CATCH_CHECK(first == second);
+}
+
+TEST_CASE("BmpEncoder write emits the encoded file")
+{
+    RGBA8Bitmap bitmap(3, 3, pattern);
+    BmpEncoder encoder(BmpFormat::BGR24);
+    std::stringstream out;
+
+    encoder.write(out, bitmap);
+    const std::vector<uint8_t>& file = encoder.encode(bitmap.view());
+
+    CATCH_CHECK(out.str() == std::string(file.begin(), file.end()));
+}
+
+#endif
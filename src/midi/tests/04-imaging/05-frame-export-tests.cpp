@@ -0,0 +1,144 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/frame-export.h"
+#include "Catch.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    RGBA8 pattern(const Position& p)
+    {
+        return RGBA8(uint8_t(p.x), uint8_t(p.y * 3), uint8_t(p.x ^ p.y));
+    }
+
+    std::vector<std::vector<uint8_t>> export_all(const RGBA8Bitmap& song, unsigned frame_width, unsigned step, unsigned threads)
+    {
+        std::vector<std::vector<uint8_t>> frames(frame_count(song.width(), frame_width, step));
+
+        export_frames(song.view(), frame_width, step, BmpFormat::BGRA32, threads, [&frames](size_t frame, const std::vector<uint8_t>& file) {
+            frames[frame] = file;
+        });
+
+        return frames;
+    }
+}
+
+TEST_CASE("frame_count")
+{
+    CATCH_CHECK(frame_count(100, 100, 1) == 1);
+    CATCH_CHECK(frame_count(100, 90, 1) == 11);
+    CATCH_CHECK(frame_count(100, 90, 3) == 4);
+    CATCH_CHECK(frame_count(100, 90, 10) == 2);
+    CATCH_CHECK(frame_count(100, 101, 1) == 0);
+    CATCH_CHECK(frame_count(100, 10, 0) == 0);
+}
+
+TEST_CASE("frame_path")
+{
+    CATCH_CHECK(frame_path("f%d.bmp", 0) == "f00000.bmp");
+    CATCH_CHECK(frame_path("out/f%d.bmp", 1234) == "out/f01234.bmp");
+    CATCH_CHECK(frame_path("f%d.bmp", 123456) == "f123456.bmp");
+}
+
+TEST_CASE("export_frames encodes each window of the song")
+{
+    RGBA8Bitmap song(50, 6, pattern);
+    BmpEncoder encoder;
+    auto frames = export_all(song, 20, 3, 1);
+
+    CATCH_REQUIRE(frames.size() == 11);
+    for (size_t i = 0; i != frames.size(); ++i)
+    {
+        CATCH_CHECK(frames[i] == encoder.encode(song.slice(int(i * 3), 0, 20, 6)->view()));
+    }
+}
+
+TEST_CASE("export_frames gives the same frames with several threads")
+{
+    RGBA8Bitmap song(300, 4, pattern);
+    auto sequential = export_all(song, 16, 1, 1);
+
+    for (unsigned threads : { 2u, 3u, 8u, 0u })
+    {
+        CATCH_CHECK(export_all(song, 16, 1, threads) == sequential);
+    }
+}
+
+TEST_CASE("export_frames reports increasing progress up to the total")
+{
+    RGBA8Bitmap song(1000, 2, pattern);
+    size_t total = frame_count(1000, 10, 1);
+    std::vector<size_t> reports;
+
+    export_frames(song.view(), 10, 1, BmpFormat::BGR24, 4, [](size_t, const std::vector<uint8_t>&) { }, [&](size_t done, size_t all) {
+        CATCH_CHECK(all == total);
+        reports.push_back(done);
+    });
+
+    CATCH_REQUIRE(!reports.empty());
+    CATCH_CHECK(reports.size() <= 2 * 100);
+    CATCH_CHECK(reports.back() == total);
+    CATCH_CHECK(std::is_sorted(reports.begin(), reports.end()));
+}
+
+TEST_CASE("export_scrolling_frames gives the same frames as slicing the song")
+{
+    RGBA8Bitmap song(200, 5, pattern);
+    auto render = [&song](const FramebufferView<RGBA8>& target, int64_t x) {
+        target.copy_from(song.view().sub_view(unsigned(x), 0, target.width(), target.height()));
+    };
+
+    for (unsigned step : { 1u, 3u, 17u })
+    {
+        for (unsigned threads : { 1u, 3u })
+        {
+            std::vector<std::vector<uint8_t>> frames(frame_count(200, 40, step));
+
+            export_scrolling_frames(200, 40, 5, step, render, BmpFormat::BGRA32, threads, [&frames](size_t frame, const std::vector<uint8_t>& file) {
+                frames[frame] = file;
+            });
+
+            CATCH_CHECK(frames == export_all(song, 40, step, 1));
+        }
+    }
+}
+
+TEST_CASE("export_scrolling_frames only starts a worker per range of frames")
+{
+    RGBA8Bitmap song(103, 2, pattern);
+    auto render = [&song](const FramebufferView<RGBA8>& target, int64_t x) {
+        target.copy_from(song.view().sub_view(unsigned(x), 0, target.width(), target.height()));
+    };
+    unsigned encoders = 0;
+    FrameEncoding encoding([&encoders]() -> FrameEncoder {
+        ++encoders;
+        auto file = std::make_shared<std::vector<uint8_t>>();
+        return [file](const FramebufferView<const RGBA8>&, unsigned) -> const std::vector<uint8_t>& { return *file; };
+    });
+
+    // 64 frames are two ranges of scrolling frames
+    export_scrolling_frames(103, 40, 2, 1, render, encoding, 8, [](size_t, const std::vector<uint8_t>&) { });
+
+    CATCH_CHECK(encoders == 2);
+}
+
+TEST_CASE("export_frames with no frames does nothing")
+{
+    RGBA8Bitmap song(10, 2, pattern);
+    bool called = false;
+
+    export_frames(song.view(), 20, 1, BmpFormat::BGRA32, 4, [&called](size_t, const std::vector<uint8_t>&) { called = true; });
+
+    CATCH_CHECK(!called);
+}
+
+#endif
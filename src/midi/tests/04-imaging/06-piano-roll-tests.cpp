@@ -0,0 +1,197 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/drawing.h"
+#include "imaging/framebuffer.h"
+#include "imaging/piano-roll.h"
+#include "Catch.h"
+#include <random>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    midi::NOTE note(uint8_t number, uint64_t start, uint64_t duration, uint8_t instrument)
+    {
+        return midi::NOTE(midi::NoteNumber(number), midi::Time(start), midi::Duration(duration), 127, midi::Instrument(instrument));
+    }
+
+    std::vector<midi::NOTE> random_song(unsigned count)
+    {
+        std::mt19937 random(7);
+        std::vector<midi::NOTE> notes;
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            uint8_t number = uint8_t(50 + random() % 20);
+            notes.push_back(note(number, random() % 2000, random() % 300, uint8_t(random() % 128)));
+        }
+
+        return notes;
+    }
+
+    // The whole roll drawn pitch by pitch, as the app does before slicing frames
+    RGBA8Bitmap draw_whole_roll(const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, unsigned width)
+    {
+        RGBA8Bitmap bitmap(width, 128 * note_height);
+
+        for (int i = 0; i <= 127; i++)
+        {
+            for (const midi::NOTE& n : notes)
+            {
+                if (n.note_number == midi::NoteNumber(i))
+                {
+                    Position p(unsigned(value(n.start) * (scale / 100.0)), (127 - i) * note_height);
+                    uint32_t w = uint32_t(value(n.duration) * (scale / 100.0));
+
+                    fill_rect(bitmap.view(), p.x, p.y, w, note_height, instrument_color(n.instrument));
+                }
+            }
+        }
+
+        return bitmap;
+    }
+
+    void check_windows(const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height, unsigned frame_width, unsigned step)
+    {
+        PianoRoll roll(notes, scale, note_height);
+        RGBA8Bitmap whole = draw_whole_roll(notes, scale, note_height, roll.width());
+        Framebuffer<RGBA8> frame(frame_width, 20 * note_height);
+
+        for (unsigned x = 0; x + frame_width <= roll.width(); x += step)
+        {
+            roll.render(frame.view(), x, 50 * note_height);
+
+            for (unsigned y = 0; y != frame.height(); ++y)
+            {
+                for (unsigned i = 0; i != frame_width; ++i)
+                {
+                    if (!(frame.view()[Position(i, y)] == whole[Position(x + i, y + 50 * note_height)]))
+                    {
+                        CATCH_FAIL("Pixel (" << i << ", " << y << ") of window at " << x << " differs");
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("instrument_color")
+{
+    CATCH_CHECK(instrument_color(midi::Instrument(0)) == RGBA8(0, 0, 0));
+    CATCH_CHECK(instrument_color(midi::Instrument(1)) == from_color<RGBA8>(Color(1 / 7.0, 1 / 17.0, 1 / 37.0)));
+}
+
+TEST_CASE("PianoRoll layout")
+{
+    PianoRoll roll({ note(127, 10, 20, 1), note(0, 40, 10, 2) }, 50, 4);
+
+    CATCH_CHECK(roll.width() == 25);
+    CATCH_CHECK(roll.height() == 512);
+    CATCH_REQUIRE(roll.rectangles().size() == 2);
+    CATCH_CHECK(roll.rectangles()[0].x == 5);
+    CATCH_CHECK(roll.rectangles()[0].y == 0);
+    CATCH_CHECK(roll.rectangles()[0].width == 10);
+    CATCH_CHECK(roll.rectangles()[0].height == 4);
+    CATCH_CHECK(roll.rectangles()[1].x == 20);
+    CATCH_CHECK(roll.rectangles()[1].y == 508);
+}
+
+TEST_CASE("PianoRoll render draws only the window")
+{
+    PianoRoll roll({ note(100, 0, 10, 1), note(100, 20, 10, 2) }, 100, 2);
+    Framebuffer<RGBA8> frame(10, 4, RGBA8(1, 2, 3));
+
+    roll.render(frame.view(), 15, 2 * 27 - 1);
+
+    for (unsigned x = 0; x != 10; ++x)
+    {
+        RGBA8 expected = x >= 5 ? instrument_color(midi::Instrument(2)) : RGBA8();
+
+        CATCH_CHECK(frame.view()[Position(x, 0)] == RGBA8());
+        CATCH_CHECK(frame.view()[Position(x, 1)] == expected);
+        CATCH_CHECK(frame.view()[Position(x, 2)] == expected);
+        CATCH_CHECK(frame.view()[Position(x, 3)] == RGBA8());
+    }
+}
+
+TEST_CASE("PianoRoll later notes on the same pitch are drawn on top")
+{
+    PianoRoll roll({ note(60, 0, 10, 1), note(60, 5, 10, 2), note(60, 3, 4, 3) }, 100, 1);
+    Framebuffer<RGBA8> frame(16, 1);
+
+    roll.render(frame.view(), 0, 67);
+
+    CATCH_CHECK(frame.view()[Position(2, 0)] == instrument_color(midi::Instrument(1)));
+    CATCH_CHECK(frame.view()[Position(4, 0)] == instrument_color(midi::Instrument(3)));
+    CATCH_CHECK(frame.view()[Position(7, 0)] == instrument_color(midi::Instrument(2)));
+    CATCH_CHECK(frame.view()[Position(15, 0)] == RGBA8());
+}
+
+TEST_CASE("PianoRoll windows are identical to slices of the whole roll")
+{
+    auto notes = random_song(300);
+
+    check_windows(notes, 100, 2, 64, 37);
+    check_windows(notes, 33, 3, 50, 11);
+    check_windows(notes, 250, 1, 200, 101);
+}
+
+TEST_CASE("draw_note_rows draws the same as the pitch by pitch loop")
+{
+    auto notes = random_song(300);
+
+    for (unsigned scale : { 100u, 33u, 250u })
+    {
+        for (unsigned note_height : { 1u, 3u })
+        {
+            unsigned width = PianoRoll(notes, scale, note_height).width();
+            RGBA8Bitmap whole = draw_whole_roll(notes, scale, note_height, width);
+            RGBA8Bitmap bitmap(width, 128 * note_height);
+
+            draw_note_rows(bitmap.view(), notes, scale, note_height, 0);
+
+            bool same = true;
+            bitmap.view().for_each_row([&](unsigned y, const RGBA8* row) {
+                same = same && std::equal(row, row + width, whole.view().row(y));
+            });
+            CATCH_CHECK(same);
+        }
+    }
+}
+
+TEST_CASE("draw_note_rows draws only the rows of the target, on top of its contents")
+{
+    auto notes = random_song(200);
+    PianoRoll roll(notes, 100, 2);
+    Framebuffer<RGBA8> expected(roll.width(), 15, RGBA8(1, 2, 3));
+    Framebuffer<RGBA8> band(roll.width(), 15, RGBA8(1, 2, 3));
+
+    roll.draw_notes(expected.view(), 0, 2 * (127 - 69) + 1);
+    draw_note_rows(band.view(), notes, 100, 2, 2 * (127 - 69) + 1);
+
+    bool same = true;
+    band.view().for_each_row([&](unsigned y, const RGBA8* row) {
+        same = same && std::equal(row, row + band.width(), expected.view().row(y));
+    });
+    CATCH_CHECK(same);
+}
+
+TEST_CASE("draw_note_rows writes instrument indices")
+{
+    Framebuffer<uint8_t> roll(20, 128, 0);
+
+    draw_note_rows(roll.view(), { note(60, 0, 10, 1), note(60, 5, 10, 2), note(61, 12, 100, 3) }, 100, 1, 0);
+
+    CATCH_CHECK(roll.view()[Position(4, 67)] == instrument_index(midi::Instrument(1)));
+    CATCH_CHECK(roll.view()[Position(5, 67)] == instrument_index(midi::Instrument(2)));
+    CATCH_CHECK(roll.view()[Position(15, 67)] == 0);
+    CATCH_CHECK(roll.view()[Position(11, 66)] == 0);
+    CATCH_CHECK(roll.view()[Position(19, 66)] == instrument_index(midi::Instrument(3)));
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bmp-format.h"
+#include "imaging/framebuffer.h"
+#include "imaging/piano-roll.h"
+#include "imaging/scrolling-framebuffer.h"
+#include "Catch.h"
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    RGBA8 pattern(int64_t x, unsigned y)
+    {
+        return RGBA8(uint8_t(x), uint8_t(y), uint8_t(x >> 8));
+    }
+
+    // Strip renderer drawing pattern, counting how many columns it was asked for
+    ScrollingFramebuffer<RGBA8>::StripRenderer counting_renderer(uint64_t* columns)
+    {
+        return [columns](const FramebufferView<RGBA8>& target, int64_t x) {
+            *columns += target.width();
+
+            target.for_each_row([&target, x](unsigned y, RGBA8* row) {
+                for (unsigned i = 0; i != target.width(); ++i)
+                {
+                    row[i] = pattern(x + i, y);
+                }
+            });
+        };
+    }
+
+    void check_viewport(const ScrollingFramebuffer<RGBA8>& viewport)
+    {
+        Framebuffer<RGBA8> copy(viewport.width(), viewport.height());
+        viewport.copy_to(copy.view());
+
+        for (unsigned y = 0; y != viewport.height(); ++y)
+        {
+            for (unsigned i = 0; i != viewport.width(); ++i)
+            {
+                if (!(copy.view()[Position(i, y)] == pattern(viewport.x() + i, y)))
+                {
+                    CATCH_FAIL("Column " << i << " of viewport at " << viewport.x() << " is wrong");
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("ScrollingFramebuffer draws the whole viewport first")
+{
+    uint64_t columns = 0;
+    ScrollingFramebuffer<RGBA8> viewport(10, 3, counting_renderer(&columns));
+
+    viewport.scroll_to(5);
+
+    CATCH_CHECK(columns == 10);
+    CATCH_CHECK(viewport.rotation() == 0);
+    check_viewport(viewport);
+}
+
+TEST_CASE("ScrollingFramebuffer only draws revealed columns when scrolling right")
+{
+    uint64_t columns = 0;
+    ScrollingFramebuffer<RGBA8> viewport(10, 3, counting_renderer(&columns));
+    viewport.scroll_to(0);
+
+    for (int64_t x : { 3, 4, 4, 11, 20, 29 })
+    {
+        columns = 0;
+        int64_t shift = x - viewport.x();
+
+        viewport.scroll_to(x);
+
+        CATCH_CHECK(columns == uint64_t(shift));
+        check_viewport(viewport);
+    }
+
+    CATCH_CHECK(viewport.rotation() == 9);
+}
+
+TEST_CASE("ScrollingFramebuffer redraws everything on jumps and when scrolling left")
+{
+    uint64_t columns = 0;
+    ScrollingFramebuffer<RGBA8> viewport(10, 2, counting_renderer(&columns));
+    viewport.scroll_to(0);
+    viewport.scroll_to(7);
+
+    columns = 0;
+    viewport.scroll_to(2);
+    CATCH_CHECK(columns == 10);
+    check_viewport(viewport);
+
+    columns = 0;
+    viewport.scroll_to(12);
+    CATCH_CHECK(columns == 10);
+    CATCH_CHECK(viewport.rotation() == 0);
+    check_viewport(viewport);
+}
+
+TEST_CASE("ScrollingFramebuffer scrolling one column at a time")
+{
+    uint64_t columns = 0;
+    ScrollingFramebuffer<RGBA8> viewport(7, 2, counting_renderer(&columns));
+
+    for (int64_t x = 0; x != 30; ++x)
+    {
+        viewport.scroll_to(x);
+        check_viewport(viewport);
+    }
+
+    CATCH_CHECK(columns == 7 + 29);
+}
+
+TEST_CASE("BmpEncoder rotation gives the same file as the unrotated viewport")
+{
+    uint64_t columns = 0;
+    ScrollingFramebuffer<RGBA8> viewport(9, 4, counting_renderer(&columns));
+    Framebuffer<RGBA8> copy(9, 4);
+
+    viewport.scroll_to(0);
+    viewport.scroll_to(5);
+    viewport.copy_to(copy.view());
+    CATCH_REQUIRE(viewport.rotation() == 5);
+
+    for (BmpFormat format : { BmpFormat::BGRA32, BmpFormat::BGR24 })
+    {
+        BmpEncoder rotated(format), plain(format);
+
+        CATCH_CHECK(rotated.encode(viewport.ring(), viewport.rotation()) == plain.encode(copy.view()));
+    }
+}
+
+TEST_CASE("RepeatingBackground repeats its tile horizontally")
+{
+    RepeatingBackground<RGBA8> background(5, 2, [](const FramebufferView<RGBA8>& tile) {
+        tile.for_each_row([](unsigned y, RGBA8* row) {
+            for (unsigned x = 0; x != 5; ++x)
+            {
+                row[x] = RGBA8(uint8_t(x), uint8_t(y), 0);
+            }
+        });
+    });
+
+    for (int64_t x : { 0, 3, 5, 12, -1, -7 })
+    {
+        Framebuffer<RGBA8> target(13, 3, RGBA8(9, 9, 9));
+        background.draw(target.view(), x);
+
+        for (unsigned i = 0; i != 13; ++i)
+        {
+            unsigned column = unsigned(((x + i) % 5 + 5) % 5);
+
+            CATCH_CHECK(target.view()[Position(i, 0)] == RGBA8(uint8_t(column), 0, 0));
+            CATCH_CHECK(target.view()[Position(i, 1)] == RGBA8(uint8_t(column), 1, 0));
+            CATCH_CHECK(target.view()[Position(i, 2)] == RGBA8(9, 9, 9));
+        }
+    }
+}
+
+TEST_CASE("PianoRoll draw_lanes marks the rows of black keys")
+{
+    PianoRoll roll({}, 100, 2);
+    Framebuffer<RGBA8> target(3, 8);
+
+    // Rows of pitches 63 (D#), 62 (D), 61 (C#) and 60 (C)
+    roll.draw_lanes(target.view(), (127 - 63) * 2);
+
+    RGBA8 grey(32, 32, 32);
+    RGBA8 expected[] = { grey, grey, RGBA8(), RGBA8(), grey, grey, RGBA8(), RGBA8() };
+
+    for (unsigned y = 0; y != 8; ++y)
+    {
+        CATCH_CHECK(target.view()[Position(1, y)] == expected[y]);
+    }
+}
+
+#endif
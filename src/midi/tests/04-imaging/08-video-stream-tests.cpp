@@ -0,0 +1,200 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/frame-export.h"
+#include "imaging/framebuffer.h"
+#include "imaging/video-stream.h"
+#include "Catch.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    RGBA8 pattern(const Position& p)
+    {
+        return RGBA8(uint8_t(p.x * 11), uint8_t(p.y * 23), uint8_t(p.x * p.y));
+    }
+
+    std::string read_all(std::FILE* file)
+    {
+        std::string result;
+        char buffer[4096];
+        size_t count;
+
+        std::fflush(file);
+        std::rewind(file);
+        while ((count = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+        {
+            result.append(buffer, count);
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("Y4M header")
+{
+    CATCH_CHECK(VideoEncoder(VideoFormat::Y4M, 640, 360, 25).header() == "YUV4MPEG2 W640 H360 F25:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n");
+    CATCH_CHECK(VideoEncoder(VideoFormat::RGB24, 640, 360, 25).header().empty());
+}
+
+TEST_CASE("Y4M frame layout")
+{
+    Framebuffer<RGBA8> frame(5, 3);
+    VideoEncoder encoder(VideoFormat::Y4M, 5, 3, 30);
+    const std::vector<uint8_t>& data = encoder.encode(frame.view());
+
+    // FRAME marker, 5x3 luma, 3x2 chroma twice
+    CATCH_REQUIRE(data.size() == 6 + 15 + 2 * 6);
+    CATCH_CHECK(std::string(data.begin(), data.begin() + 6) == "FRAME\n");
+    CATCH_CHECK(data[6] == 16);
+    CATCH_CHECK(data[6 + 15] == 128);
+    CATCH_CHECK(data.back() == 128);
+}
+
+TEST_CASE("Y4M converts with BT.601 limited range")
+{
+    struct
+    {
+        RGBA8 rgb;
+        uint8_t y, u, v;
+    } cases[] = {
+        { RGBA8(0, 0, 0), 16, 128, 128 },
+        { RGBA8(255, 255, 255), 235, 128, 128 },
+        { RGBA8(255, 0, 0), 82, 90, 240 },
+        { RGBA8(0, 255, 0), 144, 54, 34 },
+        { RGBA8(0, 0, 255), 41, 240, 110 },
+    };
+
+    for (auto& c : cases)
+    {
+        Framebuffer<RGBA8> frame(2, 2, c.rgb);
+        VideoEncoder encoder(VideoFormat::Y4M, 2, 2, 30);
+        const std::vector<uint8_t>& data = encoder.encode(frame.view());
+
+        CATCH_CHECK(int(data[6]) == c.y);
+        CATCH_CHECK(int(data[9]) == c.y);
+        CATCH_CHECK(int(data[10]) == c.u);
+        CATCH_CHECK(int(data[11]) == c.v);
+    }
+}
+
+TEST_CASE("Y4M chroma averages 2x2 blocks")
+{
+    Framebuffer<RGBA8> frame(2, 2);
+    frame.view()[Position(0, 0)] = RGBA8(0, 0, 255);
+    frame.view()[Position(1, 0)] = RGBA8(0, 0, 255);
+    VideoEncoder encoder(VideoFormat::Y4M, 2, 2, 30);
+
+    // Average is (0, 0, 128)
+    const std::vector<uint8_t>& data = encoder.encode(frame.view());
+
+    CATCH_CHECK(int(data[10]) == 184);
+    CATCH_CHECK(int(data[11]) == 119);
+}
+
+TEST_CASE("RGB24 frames are packed RGB rows, top to bottom")
+{
+    RGBA8Bitmap bitmap(3, 2, pattern);
+    VideoEncoder encoder(VideoFormat::RGB24, 3, 2, 30);
+    const std::vector<uint8_t>& data = encoder.encode(bitmap.view());
+
+    CATCH_REQUIRE(data.size() == 18);
+    for (unsigned y = 0; y != 2; ++y)
+    {
+        for (unsigned x = 0; x != 3; ++x)
+        {
+            const uint8_t* rgb = data.data() + 3 * (y * 3 + x);
+
+            CATCH_CHECK(rgb[0] == pattern(Position(x, y)).r);
+            CATCH_CHECK(rgb[1] == pattern(Position(x, y)).g);
+            CATCH_CHECK(rgb[2] == pattern(Position(x, y)).b);
+        }
+    }
+}
+
+TEST_CASE("VideoEncoder un-rotates rows")
+{
+    RGBA8Bitmap bitmap(7, 5, pattern);
+    RGBA8Bitmap rotated(7, 5, [](const Position& p) { return pattern(Position((p.x + 4) % 7, p.y)); });
+
+    for (VideoFormat format : { VideoFormat::Y4M, VideoFormat::RGB24 })
+    {
+        VideoEncoder plain(format, 7, 5, 30), unrotating(format, 7, 5, 30);
+
+        CATCH_CHECK(unrotating.encode(rotated.view(), 3) == plain.encode(bitmap.view()));
+    }
+}
+
+TEST_CASE("OrderedFrameWriter writes frames in order")
+{
+    std::FILE* file = std::tmpfile();
+    CATCH_REQUIRE(file != nullptr);
+
+    {
+        OrderedFrameWriter writer(file, "H", 4);
+        writer.write(2, { 'c' });
+        writer.write(1, { 'b' });
+        writer.write(0, { 'a' });
+        writer.write(3, { 'd', 'd' });
+    }
+
+    CATCH_CHECK(read_all(file) == "Habcdd");
+    std::fclose(file);
+}
+
+TEST_CASE("OrderedFrameWriter makes workers that run ahead wait")
+{
+    std::FILE* file = std::tmpfile();
+    CATCH_REQUIRE(file != nullptr);
+
+    {
+        OrderedFrameWriter writer(file, "", 2);
+
+        // Frame 3 is beyond the window until frame 1 has been written
+        std::thread ahead([&writer]() { writer.write(3, { '3' }); });
+        writer.write(1, { '1' });
+        writer.write(0, { '0' });
+        writer.write(2, { '2' });
+        ahead.join();
+    }
+
+    CATCH_CHECK(read_all(file) == "0123");
+    std::fclose(file);
+}
+
+TEST_CASE("Streaming an export with several threads keeps frame order")
+{
+    RGBA8Bitmap song(120, 6, pattern);
+    std::string expected;
+    VideoEncoder reference(VideoFormat::RGB24, 16, 6, 30);
+
+    for (size_t i = 0; i != frame_count(120, 16, 1); ++i)
+    {
+        const std::vector<uint8_t>& data = reference.encode(song.slice(int(i), 0, 16, 6)->view());
+        expected.append(data.begin(), data.end());
+    }
+
+    for (unsigned threads : { 1u, 4u })
+    {
+        std::FILE* file = std::tmpfile();
+        CATCH_REQUIRE(file != nullptr);
+
+        {
+            OrderedFrameWriter writer(file, "", 3);
+            export_frames(song.view(), 16, 1, VideoEncoder::encoding(VideoFormat::RGB24, 16, 6, 30), threads, writer.sink());
+        }
+
+        CATCH_CHECK(read_all(file) == expected);
+        std::fclose(file);
+    }
+}
+
+#endif
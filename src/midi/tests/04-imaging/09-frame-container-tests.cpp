@@ -0,0 +1,207 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/frame-container.h"
+#include "imaging/frame-export.h"
+#include "util/check-size.h"
+#include "Catch.h"
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    std::vector<uint8_t> frame_data(size_t frame, size_t size)
+    {
+        std::vector<uint8_t> result(size);
+
+        for (size_t i = 0; i != size; ++i)
+        {
+            result[i] = uint8_t(frame * 31 + i / 16);
+        }
+
+        return result;
+    }
+
+    std::vector<uint8_t> to_bytes(const std::stringstream& out)
+    {
+        std::string bytes = out.str();
+
+        return std::vector<uint8_t>(bytes.begin(), bytes.end());
+    }
+
+    RGBA8 pattern(const Position& p)
+    {
+        return RGBA8(uint8_t(p.x / 8 * 40), uint8_t(p.y * 30), 0);
+    }
+}
+
+TEST_CASE("Checking that the frame container records have a fixed layout")
+{
+    check_size<FRAME_CONTAINER_HEADER, 16>();
+    check_size<FRAME_INDEX_ENTRY, 32>();
+    check_size<FRAME_CONTAINER_TRAILER, 24>();
+}
+
+TEST_CASE("Frame container holds frames written out of order")
+{
+    for (FrameCompression compression : { FrameCompression::NONE, FrameCompression::LZ })
+    {
+        std::stringstream out;
+
+        {
+            FrameContainerWriter writer(out, compression);
+            writer.write(2, frame_data(2, 300));
+            writer.write(0, frame_data(0, 100));
+            writer.write(1, frame_data(1, 200));
+        }
+
+        std::vector<uint8_t> bytes = to_bytes(out);
+        CATCH_REQUIRE(is_frame_container(bytes.data(), bytes.size()));
+
+        FrameContainer container(bytes.data(), bytes.size());
+        std::vector<uint8_t> frame;
+
+        CATCH_REQUIRE(container.frame_count() == 3);
+        for (size_t i = 0; i != 3; ++i)
+        {
+            container.read(i, &frame);
+
+            CATCH_CHECK(frame == frame_data(i, 100 * (i + 1)));
+            CATCH_CHECK(container.entry(i).size == 100 * (i + 1));
+            CATCH_CHECK((container.entry(i).compression == uint32_t(compression)));
+        }
+    }
+}
+
+TEST_CASE("Uncompressed frames are read in place")
+{
+    std::stringstream out;
+
+    {
+        FrameContainerWriter writer(out);
+        writer.write(0, frame_data(5, 64));
+    }
+
+    std::vector<uint8_t> bytes = to_bytes(out);
+    FrameContainer container(bytes.data(), bytes.size());
+    std::vector<uint8_t> expected = frame_data(5, 64);
+
+    CATCH_CHECK(container.entry(0).offset == sizeof(FRAME_CONTAINER_HEADER));
+    CATCH_CHECK(std::vector<uint8_t>(container.stored_data(0), container.stored_data(0) + 64) == expected);
+}
+
+TEST_CASE("Frames that do not compress are stored as they are")
+{
+    std::stringstream out;
+    std::vector<uint8_t> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    {
+        FrameContainerWriter writer(out, FrameCompression::LZ);
+        writer.write(0, data);
+        writer.close();
+
+        CATCH_CHECK(writer.frame_bytes() == 8);
+        CATCH_CHECK(writer.stored_bytes() == 8);
+    }
+
+    std::vector<uint8_t> bytes = to_bytes(out);
+    FrameContainer container(bytes.data(), bytes.size());
+
+    CATCH_CHECK((container.entry(0).compression == uint32_t(FrameCompression::NONE)));
+}
+
+TEST_CASE("Frames that are never written are empty")
+{
+    std::stringstream out;
+
+    {
+        FrameContainerWriter writer(out);
+        writer.write(1, frame_data(1, 10));
+    }
+
+    std::vector<uint8_t> bytes = to_bytes(out);
+    FrameContainer container(bytes.data(), bytes.size());
+    std::vector<uint8_t> frame(3);
+
+    CATCH_REQUIRE(container.frame_count() == 2);
+    container.read(0, &frame);
+    CATCH_CHECK(frame.empty());
+}
+
+TEST_CASE("Frame container validation rejects damaged containers")
+{
+    std::stringstream out;
+
+    {
+        FrameContainerWriter writer(out);
+        writer.write(0, frame_data(0, 50));
+        writer.write(1, frame_data(1, 50));
+    }
+
+    std::vector<uint8_t> bytes = to_bytes(out);
+    CATCH_CHECK(is_frame_container(bytes.data(), bytes.size()));
+
+    // Truncated
+    CATCH_CHECK(!is_frame_container(bytes.data(), bytes.size() - 1));
+    CATCH_CHECK(!is_frame_container(bytes.data(), 10));
+
+    // Wrong id
+    std::vector<uint8_t> wrong_id = bytes;
+    wrong_id[0] = 'X';
+    CATCH_CHECK(!is_frame_container(wrong_id.data(), wrong_id.size()));
+
+    // Version as written by a host with the other byte order
+    std::vector<uint8_t> swapped_version = bytes;
+    std::reverse(swapped_version.begin() + 8, swapped_version.begin() + 12);
+    CATCH_CHECK(!is_frame_container(swapped_version.data(), swapped_version.size()));
+
+    // Frame reaching into the index
+    std::vector<uint8_t> wrong_size = bytes;
+    FRAME_INDEX_ENTRY* index = reinterpret_cast<FRAME_INDEX_ENTRY*>(wrong_size.data() + bytes.size() - sizeof(FRAME_CONTAINER_TRAILER) - 2 * sizeof(FRAME_INDEX_ENTRY));
+    index[1].stored_size = index[1].size = 51;
+    CATCH_CHECK(!is_frame_container(wrong_size.data(), wrong_size.size()));
+}
+
+TEST_CASE("Exporting into a container with several threads")
+{
+    RGBA8Bitmap song(200, 8, pattern);
+    std::vector<std::vector<uint8_t>> expected(frame_count(200, 32, 4));
+
+    export_frames(song.view(), 32, 4, BmpFormat::BGRA32, 1, [&expected](size_t frame, const std::vector<uint8_t>& file) {
+        expected[frame] = file;
+    });
+
+    std::stringstream out;
+    uint64_t frame_bytes, stored_bytes;
+
+    {
+        FrameContainerWriter writer(out, FrameCompression::LZ);
+        export_frames(song.view(), 32, 4, BmpFormat::BGRA32, 4, writer.sink());
+        writer.close();
+        frame_bytes = writer.frame_bytes();
+        stored_bytes = writer.stored_bytes();
+    }
+
+    std::vector<uint8_t> bytes = to_bytes(out);
+    FrameContainer container(bytes.data(), bytes.size());
+    std::vector<uint8_t> frame;
+
+    CATCH_REQUIRE(container.frame_count() == expected.size());
+    for (size_t i = 0; i != expected.size(); ++i)
+    {
+        container.read(i, &frame);
+        CATCH_CHECK(frame == expected[i]);
+    }
+    CATCH_CHECK(frame_bytes == expected.size() * expected[0].size());
+    CATCH_CHECK(stored_bytes < frame_bytes / 2);
+}
+
+#endif
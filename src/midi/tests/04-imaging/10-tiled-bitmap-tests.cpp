@@ -0,0 +1,185 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/drawing.h"
+#include "imaging/tiled-bitmap.h"
+#include "Catch.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace imaging;
+
+
+namespace
+{
+    const char* const TILES_PATH = "tiled-bitmap-tests.tiles";
+
+    // Removes the backing file after the bitmap is gone
+    struct TEMPORARY_TILES
+    {
+        ~TEMPORARY_TILES()
+        {
+            std::remove(TILES_PATH);
+        }
+    };
+
+    bool same_pixels(const FramebufferView<const RGBA8>& a, const FramebufferView<const RGBA8>& b)
+    {
+        if (a.width() != b.width() || a.height() != b.height())
+        {
+            return false;
+        }
+
+        for (unsigned y = 0; y != a.height(); ++y)
+        {
+            for (unsigned x = 0; x != a.width(); ++x)
+            {
+                if (a.row(y)[x] != b.row(y)[x])
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Draws the same random rectangles, some sticking out of the bitmap, on both
+    void draw_random_rectangles(TiledBitmap& tiled, RGBA8Bitmap& reference, unsigned count)
+    {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> coordinate(-20, 120);
+        std::uniform_int_distribution<int> size(0, 50);
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            int x = coordinate(generator), y = coordinate(generator), width = size(generator), height = size(generator);
+            RGBA8 color { uint8_t(generator()), uint8_t(generator()), uint8_t(generator()) };
+
+            tiled.fill_rect(x, y, width, height, color);
+            fill_rect(reference.view(), x, y, width, height, color);
+        }
+    }
+}
+
+TEST_CASE("Tiled bitmap starts opaque black without storing tiles")
+{
+    TEMPORARY_TILES cleanup;
+    TiledBitmap tiled(100, 50, TILES_PATH, 1 << 20, 16);
+    RGBA8Bitmap expected(30, 20);
+
+    CATCH_CHECK(same_pixels(tiled.slice(60, 25, 30, 20)->view(), expected.view()));
+    CATCH_CHECK(tiled.stored_tiles() == 0);
+}
+
+TEST_CASE("Tiled bitmap matches an in-memory bitmap across tile boundaries")
+{
+    TEMPORARY_TILES cleanup;
+    TiledBitmap tiled(111, 97, TILES_PATH, 1 << 20, 16);
+    RGBA8Bitmap reference(111, 97);
+
+    draw_random_rectangles(tiled, reference, 40);
+
+    CATCH_CHECK(same_pixels(tiled.slice(0, 0, 111, 97)->view(), reference.view()));
+    CATCH_CHECK(same_pixels(tiled.slice(13, 29, 50, 40)->view(), reference.slice(13, 29, 50, 40)->view()));
+}
+
+TEST_CASE("Tiled bitmap stays within its memory budget")
+{
+    TEMPORARY_TILES cleanup;
+
+    // Room for a single tile, so drawing and reading keep unmapping tiles
+    TiledBitmap tiled(111, 97, TILES_PATH, 1, 16);
+    RGBA8Bitmap reference(111, 97);
+
+    draw_random_rectangles(tiled, reference, 40);
+
+    CATCH_CHECK(tiled.mapped_tiles() <= 1);
+    CATCH_CHECK(same_pixels(tiled.slice(0, 0, 111, 97)->view(), reference.view()));
+    CATCH_CHECK(tiled.mapped_tiles() <= 1);
+}
+
+TEST_CASE("Reading outside the tiled bitmap gives black")
+{
+    TEMPORARY_TILES cleanup;
+    TiledBitmap tiled(20, 20, TILES_PATH, 1 << 20, 16);
+    tiled.fill_rect(0, 0, 20, 20, RGBA8(255, 0, 0));
+
+    auto slice = tiled.slice(-5, 15, 10, 10);
+
+    CATCH_CHECK(slice->view()[Position(0, 0)] == RGBA8());
+    CATCH_CHECK(slice->view()[Position(5, 0)] == RGBA8(255, 0, 0));
+    CATCH_CHECK(slice->view()[Position(5, 5)] == RGBA8());
+}
+
+TEST_CASE("Writing a framebuffer into the tiled bitmap")
+{
+    TEMPORARY_TILES cleanup;
+    TiledBitmap tiled(64, 64, TILES_PATH, 1 << 20, 16);
+    RGBA8Bitmap source(30, 30, [](const Position& p) { return RGBA8(uint8_t(p.x), uint8_t(p.y), 9); });
+
+    tiled.write(10, 20, source.view());
+
+    CATCH_CHECK(same_pixels(tiled.slice(10, 20, 30, 30)->view(), source.view()));
+    CATCH_CHECK(tiled.stored_tiles() == 9);
+}
+
+TEST_CASE("Tiled bitmap uses 64-bit coordinates")
+{
+    TEMPORARY_TILES cleanup;
+    const uint64_t width = (uint64_t(1) << 33) + 100;
+    TiledBitmap tiled(width, 40, TILES_PATH, 1 << 20, 32);
+
+    tiled.fill_rect(int64_t(width) - 50, 10, 100, 5, RGBA8(1, 2, 3));
+
+    auto slice = tiled.slice(int64_t(width) - 60, 10, 20, 1);
+
+    CATCH_CHECK(slice->view()[Position(9, 0)] == RGBA8());
+    CATCH_CHECK(slice->view()[Position(10, 0)] == RGBA8(1, 2, 3));
+    CATCH_CHECK(tiled.stored_tiles() == 3);
+}
+
+TEST_CASE("Tiled bitmap writes the same BMP file as an in-memory bitmap")
+{
+    TEMPORARY_TILES cleanup;
+    TiledBitmap tiled(111, 97, TILES_PATH, 1, 16);
+    RGBA8Bitmap reference(111, 97);
+
+    draw_random_rectangles(tiled, reference, 40);
+
+    for (BmpFormat format : { BmpFormat::BGRA32, BmpFormat::BGR24 })
+    {
+        std::stringstream expected, actual;
+
+        BmpEncoder(format).write(expected, reference);
+        tiled.write_bmp(actual, format);
+
+        CATCH_CHECK(actual.str() == expected.str());
+    }
+}
+
+TEST_CASE("BMP files can be encoded in bands")
+{
+    RGBA8Bitmap bitmap(13, 10, [](const Position& p) { return RGBA8(uint8_t(p.x * 7), uint8_t(p.y * 9), 0); });
+    BmpEncoder encoder(BmpFormat::BGR24);
+    std::vector<uint8_t> file = BmpEncoder(BmpFormat::BGR24).encode(bitmap.view());
+    std::vector<uint8_t> bands = encoder.encode_header(13, 10);
+
+    for (unsigned bottom : { 10u, 6u, 1u })
+    {
+        unsigned top = bottom == 10 ? 6 : bottom == 6 ? 1 : 0;
+        const std::vector<uint8_t>& rows = encoder.encode_rows(bitmap.view().sub_view(0, top, 13, bottom - top));
+
+        bands.insert(bands.end(), rows.begin(), rows.end());
+    }
+
+    CATCH_CHECK(bands == file);
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/frame-container.h"
+#include "imaging/frame-deduplication.h"
+#include "imaging/frame-export.h"
+#include "Catch.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    // Black with a white column every 40 pixels, so frames 40 pixels apart are equal
+    RGBA8 stripes(const Position& p)
+    {
+        return p.x % 40 == 0 ? RGBA8(255, 255, 255) : RGBA8();
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST_CASE("Frame hash sees rotated frames in screen order")
+{
+    RGBA8Bitmap frame(13, 5, [](const Position& p) { return RGBA8(uint8_t(p.x * 19), uint8_t(p.y), 7); });
+    RGBA8Bitmap rotated(13, 5, [](const Position& p) { return RGBA8(uint8_t(((p.x + 8) % 13) * 19), uint8_t(p.y), 7); });
+
+    CATCH_CHECK(frame_hash(rotated.view(), 5) == frame_hash(frame.view()));
+    CATCH_CHECK(frame_hash(rotated.view()) != frame_hash(frame.view()));
+
+    // A view that is part of a wider bitmap
+    RGBA8Bitmap wide(20, 5, [](const Position& p) { return RGBA8(uint8_t(p.x * 19), uint8_t(p.y), 7); });
+    CATCH_CHECK(frame_hash(wide.view().sub_view(0, 0, 13, 5)) == frame_hash(frame.view()));
+}
+
+TEST_CASE("FrameDeduplicator reports frames seen before")
+{
+    RGBA8Bitmap black(8, 8), white(8, 8, [](const Position&) { return RGBA8(255, 255, 255); });
+    FrameDeduplicator deduplicator;
+
+    CATCH_CHECK(!deduplicator.add(0, black.view()));
+    CATCH_CHECK(!deduplicator.add(1, white.view()));
+    CATCH_CHECK(deduplicator.add(3, black.view()));
+    CATCH_CHECK(deduplicator.add(2, white.view()));
+
+    std::vector<DUPLICATE_FRAME> duplicates = deduplicator.duplicates();
+
+    CATCH_REQUIRE(duplicates.size() == 2);
+    CATCH_CHECK(duplicates[0].frame == 2);
+    CATCH_CHECK(duplicates[0].original == 1);
+    CATCH_CHECK(duplicates[1].frame == 3);
+    CATCH_CHECK(duplicates[1].original == 0);
+    CATCH_CHECK(deduplicator.frames_seen() == 4);
+}
+
+TEST_CASE("Exporting with a deduplicator skips repeated frames")
+{
+    RGBA8Bitmap song(200, 6, stripes);
+
+    for (unsigned threads : { 1u, 3u })
+    {
+        FrameDeduplicator deduplicator;
+        std::map<size_t, std::vector<uint8_t>> written;
+        std::mutex mutex;
+
+        export_frames(song.view(), 40, 10, BmpFormat::BGRA32, threads, [&](size_t frame, const std::vector<uint8_t>& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            written[frame] = file;
+        }, ProgressReporter(), &deduplicator);
+
+        // 17 frames, but only four different ones
+        CATCH_CHECK(written.size() == 4);
+        CATCH_CHECK(deduplicator.duplicates().size() == 13);
+
+        for (const DUPLICATE_FRAME& duplicate : deduplicator.duplicates())
+        {
+            CATCH_CHECK(duplicate.frame % 4 == duplicate.original % 4);
+            CATCH_CHECK(written.count(duplicate.original) == 1);
+        }
+    }
+}
+
+TEST_CASE("Scrolling exports are deduplicated too")
+{
+    RGBA8Bitmap song(200, 6, stripes);
+    FrameDeduplicator deduplicator;
+    size_t written = 0;
+
+    export_scrolling_frames(200, 40, 6, 10, [&song](const FramebufferView<RGBA8>& target, int64_t x) {
+        target.copy_from(song.view().sub_view(unsigned(x), 0, target.width(), target.height()));
+    }, BmpFormat::BGRA32, 1, [&written](size_t, const std::vector<uint8_t>&) { ++written; }, ProgressReporter(), &deduplicator);
+
+    CATCH_CHECK(written == 4);
+}
+
+TEST_CASE("Duplicates in a container share their data")
+{
+    RGBA8Bitmap song(200, 6, stripes);
+    FrameDeduplicator deduplicator;
+    std::stringstream out;
+
+    {
+        FrameContainerWriter writer(out);
+        export_frames(song.view(), 40, 10, BmpFormat::BGRA32, 2, writer.sink(), ProgressReporter(), &deduplicator);
+
+        for (const DUPLICATE_FRAME& duplicate : deduplicator.duplicates())
+        {
+            writer.add_reference(duplicate.frame, duplicate.original);
+        }
+    }
+
+    std::string bytes = out.str();
+    FrameContainer container(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    std::vector<uint8_t> frame;
+
+    CATCH_REQUIRE(container.frame_count() == 17);
+    for (size_t i = 0; i != 17; ++i)
+    {
+        container.read(i, &frame);
+
+        CATCH_CHECK(frame == BmpEncoder().encode(song.view().sub_view(unsigned(i * 10), 0, 40, 6)));
+        CATCH_CHECK(container.entry(i).offset == container.entry(i % 4).offset);
+    }
+}
+
+TEST_CASE("Duplicate files are links to their originals")
+{
+    const std::string pattern = "frame-deduplication-tests-%d.bmp";
+    std::vector<uint8_t> original = { 'B', 'M', 1, 2, 3 };
+
+    {
+        std::ofstream out(frame_path(pattern, 0), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(original.data()), original.size());
+    }
+    {
+        // Left over from an earlier export
+        std::ofstream out(frame_path(pattern, 2), std::ios::binary);
+        out << "old";
+    }
+
+    link_duplicate_files(pattern, { DUPLICATE_FRAME{ 1, 0 }, DUPLICATE_FRAME{ 2, 0 } });
+
+    CATCH_CHECK(read_file(frame_path(pattern, 1)) == "BM\x01\x02\x03");
+    CATCH_CHECK(read_file(frame_path(pattern, 2)) == "BM\x01\x02\x03");
+
+    for (size_t frame = 0; frame != 3; ++frame)
+    {
+        std::remove(frame_path(pattern, frame).c_str());
+    }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bmp-format.h"
+#include "imaging/drawing.h"
+#include "imaging/frame-export.h"
+#include "imaging/framebuffer.h"
+#include "imaging/piano-roll.h"
+#include "Catch.h"
+#include <cstring>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    const size_t HEADER_SIZE = 14 + 124;
+
+    Palette test_palette()
+    {
+        Palette palette;
+
+        for (unsigned i = 0; i != palette.size(); ++i)
+        {
+            palette[i] = RGBA8(uint8_t(i), uint8_t(255 - i), uint8_t(i * 3));
+        }
+
+        return palette;
+    }
+
+    void draw_pattern(const FramebufferView<uint8_t>& indices)
+    {
+        for (unsigned y = 0; y != indices.height(); ++y)
+        {
+            for (unsigned x = 0; x != indices.width(); ++x)
+            {
+                indices[Position(x, y)] = uint8_t(x * 7 + y * 31);
+            }
+        }
+    }
+
+    template<typename T>
+    T field(const std::vector<uint8_t>& file, size_t offset)
+    {
+        T result;
+        std::memcpy(&result, file.data() + offset, sizeof(T));
+        return result;
+    }
+}
+
+TEST_CASE("BmpEncoder INDEXED8 file size includes the palette")
+{
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::INDEXED8, 4, 2) == HEADER_SIZE + 1024 + 8);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::INDEXED8, 5, 2) == HEADER_SIZE + 1024 + 16);
+    CATCH_CHECK(BmpEncoder::file_size(BmpFormat::INDEXED8, 1, 1) == HEADER_SIZE + 1024 + 4);
+}
+
+TEST_CASE("BmpEncoder INDEXED8 header, palette and rows")
+{
+    Framebuffer<uint8_t> indices(5, 3);
+    draw_pattern(indices.view());
+    Palette palette = test_palette();
+    BmpEncoder encoder(BmpFormat::INDEXED8);
+    const std::vector<uint8_t>& file = encoder.encode(FramebufferView<const uint8_t>(indices.view()), palette);
+
+    CATCH_REQUIRE(file.size() == HEADER_SIZE + 1024 + 3 * 8);
+    CATCH_CHECK(field<uint32_t>(file, 2) == file.size());
+    CATCH_CHECK(field<uint32_t>(file, 10) == HEADER_SIZE + 1024);
+    CATCH_CHECK(field<uint16_t>(file, 28) == 8);
+    CATCH_CHECK(field<uint32_t>(file, 46) == 256);
+
+    for (unsigned i = 0; i != 256; ++i)
+    {
+        const uint8_t* entry = file.data() + HEADER_SIZE + i * 4;
+
+        CATCH_CHECK(entry[0] == palette[i].b);
+        CATCH_CHECK(entry[1] == palette[i].g);
+        CATCH_CHECK(entry[2] == palette[i].r);
+        CATCH_CHECK(entry[3] == 0);
+    }
+
+    for (unsigned y = 0; y != 3; ++y)
+    {
+        const uint8_t* row = file.data() + HEADER_SIZE + 1024 + (2 - y) * 8;
+
+        for (unsigned x = 0; x != 5; ++x)
+        {
+            CATCH_CHECK(row[x] == indices.view()[Position(x, y)]);
+        }
+        CATCH_CHECK(row[5] == 0);
+        CATCH_CHECK(row[6] == 0);
+        CATCH_CHECK(row[7] == 0);
+    }
+}
+
+TEST_CASE("BmpEncoder INDEXED8 rotates rows")
+{
+    Framebuffer<uint8_t> indices(6, 2);
+    draw_pattern(indices.view());
+    Framebuffer<uint8_t> rotated(6, 2);
+    blit(rotated.view(), 0, 0, FramebufferView<const uint8_t>(indices.view().sub_view(2, 0, 4, 2)));
+    blit(rotated.view(), 4, 0, FramebufferView<const uint8_t>(indices.view().sub_view(0, 0, 2, 2)));
+    Palette palette = test_palette();
+    BmpEncoder encoder(BmpFormat::INDEXED8);
+
+    std::vector<uint8_t> expected = encoder.encode(FramebufferView<const uint8_t>(rotated.view()), palette);
+
+    CATCH_CHECK(encoder.encode(FramebufferView<const uint8_t>(indices.view()), palette, 2) == expected);
+}
+
+TEST_CASE("BmpEncoder looks up indexed pixels in the palette for colour formats")
+{
+    Framebuffer<uint8_t> indices(7, 4);
+    draw_pattern(indices.view());
+    Palette palette = test_palette();
+    Framebuffer<RGBA8> colors(7, 4);
+    apply_palette(colors.view(), indices.view(), palette);
+
+    for (BmpFormat format : { BmpFormat::BGRA32, BmpFormat::BGR24 })
+    {
+        BmpEncoder encoder(format);
+        std::vector<uint8_t> expected = encoder.encode(colors.view());
+
+        CATCH_CHECK(encoder.encode(FramebufferView<const uint8_t>(indices.view()), palette) == expected);
+
+        std::vector<uint8_t> rotated = encoder.encode(colors.view(), 3);
+
+        CATCH_CHECK(encoder.encode(FramebufferView<const uint8_t>(indices.view()), palette, 3) == rotated);
+    }
+}
+
+TEST_CASE("apply_palette")
+{
+    Framebuffer<uint8_t> indices(3, 2);
+    draw_pattern(indices.view());
+    Palette palette = test_palette();
+    Framebuffer<RGBA8> colors(3, 2);
+
+    apply_palette(colors.view(), indices.view(), palette);
+
+    for (unsigned y = 0; y != 2; ++y)
+    {
+        for (unsigned x = 0; x != 3; ++x)
+        {
+            CATCH_CHECK(colors.view()[Position(x, y)] == palette[indices.view()[Position(x, y)]]);
+        }
+    }
+}
+
+TEST_CASE("instrument_palette")
+{
+    Palette palette = instrument_palette();
+
+    CATCH_CHECK(palette[0] == RGBA8());
+    CATCH_CHECK(instrument_index(midi::Instrument(0)) == 1);
+    CATCH_CHECK(instrument_index(midi::Instrument(254)) == 255);
+    CATCH_CHECK(instrument_index(midi::Instrument(255)) == 255);
+
+    for (unsigned i = 0; i != 128; ++i)
+    {
+        midi::Instrument instrument{ uint8_t(i) };
+
+        CATCH_CHECK(palette[instrument_index(instrument)] == instrument_color(instrument));
+    }
+}
+
+TEST_CASE("Exporting an indexed song gives the same files as exporting its colours")
+{
+    Framebuffer<uint8_t> song(40, 6);
+    draw_pattern(song.view());
+    Palette palette = test_palette();
+    Framebuffer<RGBA8> colors(40, 6);
+    apply_palette(colors.view(), song.view(), palette);
+
+    std::vector<std::vector<uint8_t>> expected(frame_count(40, 10, 5));
+    std::vector<std::vector<uint8_t>> actual(expected.size());
+
+    export_frames(FramebufferView<const RGBA8>(colors.view()), 10, 5, FrameEncoding(BmpFormat::BGR24), 3, [&expected](size_t frame, const std::vector<uint8_t>& file) {
+        expected[frame] = file;
+    });
+    export_frames(FramebufferView<const uint8_t>(song.view()), palette, 10, 5, BmpFormat::BGR24, 3, [&actual](size_t frame, const std::vector<uint8_t>& file) {
+        actual[frame] = file;
+    });
+
+    CATCH_CHECK(actual.size() == 7);
+    CATCH_CHECK(actual == expected);
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/drawing.h"
+#include "imaging/framebuffer.h"
+#include "imaging/piano-roll.h"
+#include "imaging/roll-image.h"
+#include "Catch.h"
+#include <random>
+#include <vector>
+
+using namespace imaging;
+
+
+namespace
+{
+    midi::NOTE note(uint8_t number, uint64_t start, uint64_t duration, uint8_t instrument)
+    {
+        return midi::NOTE(midi::NoteNumber(number), midi::Time(start), midi::Duration(duration), 127, midi::Instrument(instrument));
+    }
+
+    std::vector<midi::NOTE> random_song(unsigned count)
+    {
+        std::mt19937 random(11);
+        std::vector<midi::NOTE> notes;
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            uint8_t number = uint8_t(50 + random() % 20);
+            notes.push_back(note(number, random() % 3000, random() % 400, uint8_t(random() % 128)));
+        }
+
+        return notes;
+    }
+
+    // Every note drawn in order with the edges RollImage uses, pitch 127 at the top
+    void draw_reference(const FramebufferView<uint8_t>& target, const std::vector<midi::NOTE>& notes, unsigned scale, unsigned note_height)
+    {
+        target.fill(0);
+
+        for (const midi::NOTE& n : notes)
+        {
+            int64_t left = int64_t(value(n.start) * scale / 100);
+            int64_t right = int64_t((value(n.start) + value(n.duration)) * scale / 100);
+
+            fill_rect(target, left, int64_t(127 - value(n.note_number)) * note_height, right - left, note_height, instrument_index(n.instrument));
+        }
+    }
+
+    bool same_pixels(const FramebufferView<const uint8_t>& x, const FramebufferView<const uint8_t>& y)
+    {
+        for (unsigned row = 0; row != x.height(); ++row)
+        {
+            if (!std::equal(x.row(row), x.row(row) + x.width(), y.row(row)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+TEST_CASE("RollImage keeps one span per note when notes do not overlap")
+{
+    RollImage roll({ note(60, 100, 50, 0), note(60, 0, 50, 1), note(61, 20, 10, 2) });
+
+    CATCH_REQUIRE(roll.row(60).size() == 2);
+    CATCH_CHECK(roll.row(60)[0].start == 0);
+    CATCH_CHECK(roll.row(60)[0].end == 50);
+    CATCH_CHECK(roll.row(60)[0].color == instrument_index(midi::Instrument(1)));
+    CATCH_CHECK(roll.row(60)[1].start == 100);
+    CATCH_CHECK(roll.row(60)[1].end == 150);
+    CATCH_CHECK(roll.row(61).size() == 1);
+    CATCH_CHECK(roll.row(62).empty());
+    CATCH_CHECK(roll.span_count() == 3);
+    CATCH_CHECK(roll.length() == 150);
+    CATCH_CHECK(roll.width(10) == 15);
+}
+
+TEST_CASE("RollImage lets later notes cover earlier ones")
+{
+    RollImage roll({ note(60, 0, 100, 0), note(60, 40, 20, 1), note(60, 90, 30, 2) });
+    const std::vector<NOTE_SPAN>& row = roll.row(60);
+
+    CATCH_REQUIRE(row.size() == 4);
+    CATCH_CHECK((row[0].start == 0 && row[0].end == 40 && row[0].color == 1));
+    CATCH_CHECK((row[1].start == 40 && row[1].end == 60 && row[1].color == 2));
+    CATCH_CHECK((row[2].start == 60 && row[2].end == 90 && row[2].color == 1));
+    CATCH_CHECK((row[3].start == 90 && row[3].end == 120 && row[3].color == 3));
+}
+
+TEST_CASE("RollImage merges touching pieces of the same colour")
+{
+    RollImage roll({ note(60, 0, 50, 4), note(60, 50, 50, 4), note(60, 20, 100, 4), note(60, 200, 0, 4) });
+
+    CATCH_REQUIRE(roll.row(60).size() == 1);
+    CATCH_CHECK(roll.row(60)[0].start == 0);
+    CATCH_CHECK(roll.row(60)[0].end == 120);
+}
+
+TEST_CASE("RollImage renders the same as drawing every note")
+{
+    std::vector<midi::NOTE> notes = random_song(300);
+    RollImage roll(notes);
+
+    for (unsigned scale : { 100u, 37u, 5u })
+    {
+        for (unsigned note_height : { 1u, 3u })
+        {
+            Framebuffer<uint8_t> expected(unsigned(roll.width(scale)), 128 * note_height);
+            Framebuffer<uint8_t> actual(unsigned(roll.width(scale)), 128 * note_height, 99);
+
+            draw_reference(expected.view(), notes, scale, note_height);
+            roll.render(actual.view(), 0, 0, scale, note_height);
+
+            CATCH_CHECK(same_pixels(actual.view(), expected.view()));
+        }
+    }
+}
+
+TEST_CASE("RollImage renders any window of the roll")
+{
+    std::vector<midi::NOTE> notes = random_song(200);
+    RollImage roll(notes);
+    unsigned scale = 20;
+    unsigned note_height = 2;
+    Framebuffer<uint8_t> whole(unsigned(roll.width(scale)), 128 * note_height);
+    roll.render(whole.view(), 0, 0, scale, note_height);
+
+    for (int64_t x : { int64_t(0), int64_t(17), int64_t(roll.width(scale)) - 40 })
+    {
+        for (int64_t y : { int64_t(0), int64_t(101), int64_t(200) })
+        {
+            Framebuffer<uint8_t> window(40, 50);
+            roll.render(window.view(), x, y, scale, note_height);
+
+            CATCH_CHECK(same_pixels(window.view(), whole.view().sub_view(unsigned(x), unsigned(y), 40, 50)));
+        }
+    }
+}
+
+TEST_CASE("RollImage leaves pixels outside the roll empty")
+{
+    RollImage roll({ note(127, 0, 100, 0), note(0, 0, 100, 0) });
+    Framebuffer<uint8_t> window(20, 10, 99);
+
+    roll.render(window.view(), -10, -5, 10, 2);
+
+    CATCH_CHECK(window.view()[Position(0, 0)] == 0);
+    CATCH_CHECK(window.view()[Position(9, 5)] == 0);
+    CATCH_CHECK(window.view()[Position(10, 5)] == 1);
+    CATCH_CHECK(window.view()[Position(19, 6)] == 1);
+    CATCH_CHECK(window.view()[Position(10, 7)] == 0);
+
+    roll.render(window.view(), 0, 250, 10, 2);
+
+    CATCH_CHECK(window.view()[Position(0, 4)] == 1);
+    CATCH_CHECK(window.view()[Position(9, 5)] == 1);
+    CATCH_CHECK(window.view()[Position(0, 6)] == 0);
+    CATCH_CHECK(window.view()[Position(10, 5)] == 0);
+}
+
+TEST_CASE("RollImage renders colours through a palette")
+{
+    std::vector<midi::NOTE> notes = random_song(100);
+    RollImage roll(notes);
+    Palette palette = instrument_palette();
+    Framebuffer<uint8_t> indices(120, 60);
+    Framebuffer<RGBA8> expected(120, 60);
+    Framebuffer<RGBA8> actual(120, 60);
+
+    roll.render(indices.view(), 30, 100, 15, 3);
+    apply_palette(expected.view(), indices.view(), palette);
+    roll.render(actual.view(), 30, 100, 15, 3, palette);
+
+    bool same = true;
+    actual.view().for_each_row([&](unsigned y, const RGBA8* row) {
+        same = same && std::equal(row, row + 120, expected.view().row(y));
+    });
+    CATCH_CHECK(same);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "util/interval-index.h"
+#include "Catch.h"
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    std::vector<size_t> find(const IntervalIndex& index, int64_t begin, int64_t end)
+    {
+        std::vector<size_t> result;
+        index.find_overlapping(begin, end, &result);
+        return result;
+    }
+
+    std::vector<size_t> brute_force(const std::vector<INTERVAL>& intervals, int64_t begin, int64_t end)
+    {
+        std::vector<size_t> result;
+
+        for (size_t i = 0; i != intervals.size(); ++i)
+        {
+            // Empty intervals and empty queries overlap nothing
+            if (begin < end && intervals[i].begin < intervals[i].end && intervals[i].begin < end && begin < intervals[i].end)
+            {
+                result.push_back(i);
+            }
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("Empty interval index")
+{
+    IntervalIndex index;
+
+    CATCH_CHECK(index.size() == 0);
+    CATCH_CHECK(find(index, 0, 100).empty());
+}
+
+TEST_CASE("Interval index treats intervals as half-open")
+{
+    IntervalIndex index(std::vector<INTERVAL>{ { 10, 20 }, { 20, 30 }, { 5, 5 } });
+
+    CATCH_CHECK(index.size() == 2);
+    CATCH_CHECK(find(index, 0, 10).empty());
+    CATCH_CHECK(find(index, 0, 11) == std::vector<size_t>{ 0 });
+    CATCH_CHECK(find(index, 19, 21) == (std::vector<size_t>{ 0, 1 }));
+    CATCH_CHECK(find(index, 20, 25) == std::vector<size_t>{ 1 });
+    CATCH_CHECK(find(index, 30, 40).empty());
+    CATCH_CHECK(find(index, 15, 15).empty());
+    CATCH_CHECK(find(index, 0, 100) == (std::vector<size_t>{ 0, 1 }));
+}
+
+TEST_CASE("Interval index finds a long interval starting far before the query")
+{
+    IntervalIndex index(std::vector<INTERVAL>{ { 0, 1000 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 }, { 500, 501 } });
+
+    CATCH_CHECK(find(index, 600, 700) == std::vector<size_t>{ 0 });
+    CATCH_CHECK(find(index, 499, 501) == (std::vector<size_t>{ 0, 5 }));
+}
+
+TEST_CASE("Interval index appends to the given vector")
+{
+    IntervalIndex index(std::vector<INTERVAL>{ { 0, 10 } });
+    std::vector<size_t> result{ 42 };
+
+    index.find_overlapping(5, 6, &result);
+
+    CATCH_CHECK(result == (std::vector<size_t>{ 42, 0 }));
+}
+
+TEST_CASE("Interval index agrees with brute force")
+{
+    std::mt19937 random(123);
+    std::uniform_int_distribution<int64_t> position(-100, 2000);
+    std::uniform_int_distribution<int64_t> length(0, 150);
+
+    for (size_t count : { 1, 2, 3, 10, 100, 1000 })
+    {
+        std::vector<INTERVAL> intervals;
+        for (size_t i = 0; i != count; ++i)
+        {
+            int64_t begin = position(random);
+            intervals.push_back(INTERVAL{ begin, begin + length(random) });
+        }
+
+        IntervalIndex index(intervals);
+
+        for (unsigned query = 0; query != 100; ++query)
+        {
+            int64_t begin = position(random);
+            int64_t end = begin + length(random);
+
+            CATCH_CHECK(find(index, begin, end) == brute_force(intervals, begin, end));
+        }
+    }
+}
+
+#endif
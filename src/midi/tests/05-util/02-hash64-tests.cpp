@@ -0,0 +1,62 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "util/hash64.h"
+#include "Catch.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    std::vector<uint8_t> counting_bytes(size_t size)
+    {
+        std::vector<uint8_t> result(size);
+
+        for (size_t i = 0; i != size; ++i)
+        {
+            result[i] = uint8_t(i);
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("Hash64 matches XXH64")
+{
+    std::vector<uint8_t> hundred = counting_bytes(100);
+    std::vector<uint8_t> long_input = counting_bytes(768);
+
+    CATCH_CHECK(Hash64::of("", 0) == 0xEF46DB3751D8E999ULL);
+    CATCH_CHECK(Hash64::of("a", 1) == 0xD24EC4F1A98C6E5BULL);
+    CATCH_CHECK(Hash64::of("abc", 3) == 0x44BC2CF5AD770999ULL);
+    CATCH_CHECK(Hash64::of(hundred.data(), hundred.size()) == 0x6AC1E58032166597ULL);
+    CATCH_CHECK(Hash64::of(long_input.data(), long_input.size()) == 0x8E03C838C596036FULL);
+}
+
+TEST_CASE("Hash64 does not depend on how the input is split")
+{
+    std::vector<uint8_t> data = counting_bytes(300);
+    uint64_t expected = Hash64::of(data.data(), data.size());
+
+    for (size_t piece : { 1u, 3u, 7u, 31u, 32u, 33u, 100u })
+    {
+        Hash64 hash;
+
+        for (size_t offset = 0; offset < data.size(); offset += piece)
+        {
+            hash.update(data.data() + offset, std::min(piece, data.size() - offset));
+        }
+
+        CATCH_CHECK(hash.digest() == expected);
+    }
+}
+
+TEST_CASE("Hash64 depends on the seed")
+{
+    CATCH_CHECK(Hash64::of("abc", 3, 1) != Hash64::of("abc", 3, 0));
+}
+
+#endif
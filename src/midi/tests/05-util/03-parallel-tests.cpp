@@ -0,0 +1,89 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "util/parallel.h"
+#include "Catch.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("ThreadPool calls the job once for every worker")
+{
+    ThreadPool pool;
+
+    for (unsigned workers : { 1u, 4u, 2u, 6u })
+    {
+        std::vector<std::atomic<unsigned>> calls(workers);
+        for (std::atomic<unsigned>& count : calls)
+        {
+            count = 0;
+        }
+
+        CATCH_CHECK(pool.try_run(workers, [&calls](unsigned worker) { ++calls[worker]; }));
+
+        for (const std::atomic<unsigned>& count : calls)
+        {
+            CATCH_CHECK(count == 1);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool reuses its threads")
+{
+    ThreadPool pool;
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+    auto record = [&](unsigned) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.insert(std::this_thread::get_id());
+    };
+
+    for (unsigned run = 0; run != 10; ++run)
+    {
+        pool.try_run(4, record);
+    }
+
+    CATCH_CHECK(ids.size() == 4);
+}
+
+TEST_CASE("ThreadPool does not take a job while it is running one")
+{
+    ThreadPool pool;
+    bool nested = true;
+
+    pool.try_run(2, [&](unsigned worker) {
+        if (worker == 0)
+        {
+            nested = pool.try_run(2, [](unsigned) { });
+        }
+    });
+
+    CATCH_CHECK(!nested);
+}
+
+TEST_CASE("parallel_for_worker processes every index once, also when nested")
+{
+    const size_t count = 50;
+    std::vector<std::atomic<unsigned>> calls(count * count);
+    for (std::atomic<unsigned>& c : calls)
+    {
+        c = 0;
+    }
+
+    parallel_for_worker(count, 4, [&](unsigned, size_t i) {
+        parallel_for_worker(count, 3, [&](unsigned, size_t j) { ++calls[i * count + j]; });
+    });
+
+    bool all_once = true;
+    for (const std::atomic<unsigned>& c : calls)
+    {
+        all_once = all_once && c == 1;
+    }
+    CATCH_CHECK(all_once);
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef BENCHMARKS_UTIL_H
+#define BENCHMARKS_UTIL_H
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace benchmarks
+{
+    /// <summary>
+    /// Runs <paramref name="function" /> <paramref name="repetitions" /> times and prints how many
+    /// units (events, pixels, ...) per second it processed. Returns that rate.
+    /// Benchmarks are tagged [.benchmark] so they only run on request:
+    /// run the test executable with "[benchmark]" as argument.
+    /// </summary>
+    inline double measure(const std::string& name, const std::string& unit, uint64_t units_per_repetition, unsigned repetitions, std::function<void()> function)
+    {
+        function(); // Warm-up
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i != repetitions; ++i)
+        {
+            function();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double rate = double(units_per_repetition) * repetitions / seconds;
+
+        std::cout << name << ": " << uint64_t(rate) << " " << unit << "/s" << std::endl;
+
+        return rate;
+    }
+
+    /// <summary>
+    /// Keeps the optimizer from discarding a computed value: the compiler has to assume that the
+    /// barrier reads it from memory.
+    /// </summary>
+    template<typename T>
+    void keep(const T& value)
+    {
+#ifdef _MSC_VER
+        static const volatile void* volatile address;
+        address = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r"(&value) : "memory");
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef HASH64_H
+#define HASH64_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+/// <summary>
+/// Streaming 64-bit XXH64 hash. Not cryptographic, but fast on large inputs: data is consumed in
+/// 32-byte stripes by four independent accumulators, which the compiler keeps in registers and
+/// can process in parallel. Feeding the same bytes in differently sized pieces gives the same digest.
+/// </summary>
+class Hash64 final
+{
+public:
+    explicit Hash64(uint64_t seed = 0)
+        : m_total(0), m_buffered(0)
+    {
+        m_lanes[0] = seed + PRIME1 + PRIME2;
+        m_lanes[1] = seed + PRIME2;
+        m_lanes[2] = seed;
+        m_lanes[3] = seed - PRIME1;
+        m_seed = seed;
+    }
+
+    void update(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        m_total += size;
+
+        // Complete a stripe left over from the previous call first
+        if (m_buffered != 0)
+        {
+            size_t count = size < STRIPE - m_buffered ? size : STRIPE - m_buffered;
+
+            std::memcpy(m_buffer + m_buffered, bytes, count);
+            m_buffered += count;
+            bytes += count;
+            size -= count;
+
+            if (m_buffered != STRIPE)
+            {
+                return;
+            }
+
+            consume(m_buffer);
+            m_buffered = 0;
+        }
+
+        for (; size >= STRIPE; bytes += STRIPE, size -= STRIPE)
+        {
+            consume(bytes);
+        }
+
+        std::memcpy(m_buffer, bytes, size);
+        m_buffered = size;
+    }
+
+    uint64_t digest() const
+    {
+        uint64_t hash;
+
+        if (m_total >= STRIPE)
+        {
+            hash = rotate(m_lanes[0], 1) + rotate(m_lanes[1], 7) + rotate(m_lanes[2], 12) + rotate(m_lanes[3], 18);
+
+            for (uint64_t lane : m_lanes)
+            {
+                hash = (hash ^ round(0, lane)) * PRIME1 + PRIME4;
+            }
+        }
+        else
+        {
+            hash = m_seed + PRIME5;
+        }
+
+        hash += m_total;
+
+        const uint8_t* p = m_buffer;
+        const uint8_t* end = m_buffer + m_buffered;
+
+        for (; end - p >= 8; p += 8)
+        {
+            hash = rotate(hash ^ round(0, load<uint64_t>(p)), 27) * PRIME1 + PRIME4;
+        }
+        if (end - p >= 4)
+        {
+            hash = rotate(hash ^ (load<uint32_t>(p) * PRIME1), 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        for (; p != end; ++p)
+        {
+            hash = rotate(hash ^ (*p * PRIME5), 11) * PRIME1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    static uint64_t of(const void* data, size_t size, uint64_t seed = 0)
+    {
+        Hash64 hash(seed);
+        hash.update(data, size);
+        return hash.digest();
+    }
+
+private:
+    static const size_t STRIPE = 32;
+    static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    template<typename T>
+    static T load(const uint8_t* p)
+    {
+        T result;
+        std::memcpy(&result, p, sizeof(T));
+        return result;
+    }
+
+    static uint64_t rotate(uint64_t x, unsigned bits)
+    {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    static uint64_t round(uint64_t lane, uint64_t input)
+    {
+        return rotate(lane + input * PRIME2, 31) * PRIME1;
+    }
+
+    void consume(const uint8_t* stripe)
+    {
+        for (unsigned i = 0; i != 4; ++i)
+        {
+            m_lanes[i] = round(m_lanes[i], load<uint64_t>(stripe + 8 * i));
+        }
+    }
+
+    uint64_t m_lanes[4];
+    uint64_t m_seed;
+    uint64_t m_total;
+    uint8_t m_buffer[STRIPE];
+    size_t m_buffered;
+};
+
+#endif
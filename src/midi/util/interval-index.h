@@ -0,0 +1,125 @@
+#ifndef INTERVAL_INDEX_H
+#define INTERVAL_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// <summary>
+/// Half-open interval [begin, end).
+/// </summary>
+struct INTERVAL final
+{
+    int64_t begin;
+    int64_t end;
+};
+
+/// <summary>
+/// Static index answering "which intervals overlap [begin, end)?" in O(log n + k).
+/// Intervals are sorted by begin and laid out as an implicit balanced tree (the middle element
+/// of a range is its root), where each root also stores the largest end in its range,
+/// so whole subtrees ending before the query are skipped.
+/// Intervals are identified by their position in the vector given to the constructor.
+/// </summary>
+class IntervalIndex final
+{
+public:
+    IntervalIndex() = default;
+
+    explicit IntervalIndex(const std::vector<INTERVAL>& intervals)
+    {
+        for (size_t i = 0; i != intervals.size(); ++i)
+        {
+            // Empty intervals overlap nothing
+            if (intervals[i].begin < intervals[i].end)
+            {
+                m_entries.push_back(ENTRY{ intervals[i], i, 0 });
+            }
+        }
+
+        std::sort(m_entries.begin(), m_entries.end(), [](const ENTRY& x, const ENTRY& y) { return x.interval.begin < y.interval.begin; });
+
+        compute_max_end(0, m_entries.size());
+    }
+
+    /// <summary>
+    /// Number of non-empty intervals in the index.
+    /// </summary>
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+    /// <summary>
+    /// Appends the ids of all intervals overlapping [<paramref name="begin" />, <paramref name="end" />)
+    /// to <paramref name="ids" />, in increasing order.
+    /// </summary>
+    void find_overlapping(int64_t begin, int64_t end, std::vector<size_t>* ids) const
+    {
+        size_t first = ids->size();
+
+        if (begin < end)
+        {
+            find_overlapping(0, m_entries.size(), begin, end, ids);
+        }
+
+        std::sort(ids->begin() + first, ids->end());
+    }
+
+private:
+    struct ENTRY
+    {
+        INTERVAL interval;
+        size_t id;
+        int64_t max_end;
+    };
+
+    int64_t compute_max_end(size_t first, size_t last)
+    {
+        if (first == last)
+        {
+            return INT64_MIN;
+        }
+
+        size_t middle = first + (last - first) / 2;
+        int64_t left = compute_max_end(first, middle);
+        int64_t right = compute_max_end(middle + 1, last);
+
+        return m_entries[middle].max_end = std::max(m_entries[middle].interval.end, std::max(left, right));
+    }
+
+    void find_overlapping(size_t first, size_t last, int64_t begin, int64_t end, std::vector<size_t>* ids) const
+    {
+        if (first == last)
+        {
+            return;
+        }
+
+        size_t middle = first + (last - first) / 2;
+        const ENTRY& entry = m_entries[middle];
+
+        if (entry.max_end <= begin)
+        {
+            return;
+        }
+
+        find_overlapping(first, middle, begin, end, ids);
+
+        // Everything to the right starts at or after entry, so it can only overlap if entry starts before end
+        if (entry.interval.begin < end)
+        {
+            if (begin < entry.interval.end)
+            {
+                ids->push_back(entry.id);
+            }
+
+            find_overlapping(middle + 1, last, begin, end, ids);
+        }
+    }
+
+    std::vector<ENTRY> m_entries;
+};
+
+#endif
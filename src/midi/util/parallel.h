@@ -0,0 +1,226 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// <summary>
+/// Number of worker threads to use when the caller asks for 0 ("as many as the machine has").
+/// </summary>
+inline unsigned default_thread_count()
+{
+    unsigned count = std::thread::hardware_concurrency();
+
+    return count == 0 ? 1 : count;
+}
+
+/// <summary>
+/// Number of workers parallel_for and parallel_for_worker use for <paramref name="count" /> indices
+/// when asked for <paramref name="threads" /> threads (0 meaning default_thread_count()).
+/// Never more than there are indices, and at least 1.
+/// </summary>
+inline unsigned effective_thread_count(size_t count, unsigned threads)
+{
+    if (threads == 0)
+    {
+        threads = default_thread_count();
+    }
+
+    return std::max(1u, unsigned(std::min<size_t>(threads, count)));
+}
+
+/// <summary>
+/// Threads that stay alive between jobs, so that short parallel jobs (e.g. parsing the tracks of a
+/// small file) do not pay for creating and joining threads every time.
+/// The pool grows to the largest number of workers asked for and runs one job at a time.
+/// </summary>
+class ThreadPool final
+{
+public:
+    ThreadPool()
+        : m_job(nullptr), m_workers(0), m_pending(0), m_generation(0), m_stopping(false), m_busy(false) { }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator =(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    /// <summary>
+    /// The pool parallel_for_worker runs on.
+    /// </summary>
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool;
+
+        return pool;
+    }
+
+    /// <summary>
+    /// Calls <paramref name="job" />(worker) for every worker in [0, workers): worker 0 on the calling
+    /// thread, the others on pool threads. Returns when all calls have returned.
+    /// Returns false without calling anything if the pool is already running a job, e.g. when
+    /// called from inside a job; the caller then has to get its threads elsewhere.
+    /// </summary>
+    bool try_run(unsigned workers, const std::function<void(unsigned)>& job)
+    {
+        if (m_busy.exchange(true))
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            while (m_threads.size() + 1 < workers)
+            {
+                unsigned index = unsigned(m_threads.size()) + 1;
+                uint64_t generation = m_generation;
+
+                m_threads.emplace_back([this, index, generation]() { work(index, generation); });
+            }
+
+            m_job = &job;
+            m_workers = workers;
+            m_pending = workers - 1;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        job(0);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_done.wait(lock, [this]() { return m_pending == 0; });
+            m_job = nullptr;
+        }
+
+        m_busy = false;
+        return true;
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(unsigned)>* m_job;
+    unsigned m_workers;
+    unsigned m_pending;
+    uint64_t m_generation;
+    bool m_stopping;
+    std::atomic<bool> m_busy;
+
+    // Waits for jobs newer than seen; workers with an index beyond the job's worker count sit it out
+    void work(unsigned index, uint64_t seen)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        for (;;)
+        {
+            m_wake.wait(lock, [this, seen]() { return m_stopping || m_generation != seen; });
+
+            if (m_stopping)
+            {
+                return;
+            }
+
+            seen = m_generation;
+
+            if (index < m_workers)
+            {
+                const std::function<void(unsigned)>& job = *m_job;
+
+                lock.unlock();
+                job(index);
+                lock.lock();
+
+                if (--m_pending == 0)
+                {
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+};
+
+/// <summary>
+/// Calls <paramref name="function" />(worker, index) once for every index in [0, count), spread over
+/// effective_thread_count(count, threads) workers that pull indices from a shared counter.
+/// worker identifies the calling worker (0 is the calling thread), so each worker can keep its own
+/// scratch state, e.g. in a vector with one element per worker.
+/// The other workers run on ThreadPool::shared(), or on threads of their own if that pool is busy.
+/// Returns when all indices have been processed.
+/// </summary>
+inline void parallel_for_worker(size_t count, unsigned threads, std::function<void(unsigned, size_t)> function)
+{
+    threads = effective_thread_count(count, threads);
+
+    if (threads == 1)
+    {
+        for (size_t i = 0; i != count; ++i)
+        {
+            function(0, i);
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::function<void(unsigned)> worker = [&next, count, &function](unsigned worker_index) {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            function(worker_index, i);
+        }
+    };
+
+    if (ThreadPool::shared().try_run(threads, worker))
+    {
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(worker, i);
+    }
+
+    worker(0);
+
+    for (std::thread& thread : workers)
+    {
+        thread.join();
+    }
+}
+
+/// <summary>
+/// Calls <paramref name="function" /> once for every index in [0, count), spread over
+/// <paramref name="threads" /> workers that pull indices from a shared counter.
+/// The calling thread takes part in the work. Returns when all indices have been processed.
+/// </summary>
+inline void parallel_for(size_t count, unsigned threads, std::function<void(size_t)> function)
+{
+    parallel_for_worker(count, threads, [&function](unsigned, size_t i) { function(i); });
+}
+
+#endif